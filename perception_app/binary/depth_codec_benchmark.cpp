@@ -0,0 +1,108 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <opencv2/core.hpp>
+#include <opencv2/imgcodecs.hpp>
+#include "camera/storage/DepthCodec.hpp"
+#include "camera/utils/SimdSupport.hpp"
+#include "camera/utils/ThreadPool.hpp"
+
+namespace {
+
+constexpr int kWidth = 1920;
+constexpr int kHeight = 1200;
+
+double MeasureMs(int iterations, const std::function<void()> &body) {
+  body();  // warm-up
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < iterations; ++i) {
+    body();
+  }
+  auto elapsed = std::chrono::steady_clock::now() - start;
+  return std::chrono::duration<double, std::milli>(elapsed).count() / iterations;
+}
+
+// Tilted planes with sensor noise at 0.01 mm resolution and ~8% invalid pixels, roughly like a real scene
+cv::Mat MakeDepth() {
+  cv::Mat depth(kHeight, kWidth, CV_32FC1);
+  std::mt19937 rng(42);
+  std::normal_distribution<float> noise(0.0f, 0.08f);
+  std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+  for (int row = 0; row < kHeight; ++row) {
+    float *line = depth.ptr<float>(row);
+    for (int col = 0; col < kWidth; ++col) {
+      const bool object = (row / 150 + col / 240) % 3 == 0;
+      float z = object ? 650.0f + 0.05f * col : 1200.0f + 0.2f * row;
+      z = std::round((z + noise(rng)) * 100.0f) / 100.0f;
+      line[col] = unit(rng) < 0.08f ? NAN : z;
+    }
+  }
+  return depth;
+}
+
+double MaxAbsDiff(const cv::Mat &a, const cv::Mat &b) {
+  double diff = 0.0;
+  for (int row = 0; row < a.rows; ++row) {
+    for (int col = 0; col < a.cols; ++col) {
+      const float x = a.at<float>(row, col);
+      const float y = b.at<float>(row, col);
+      if (std::isnan(x) != std::isnan(y)) return INFINITY;
+      if (!std::isnan(x)) diff = std::max(diff, static_cast<double>(std::fabs(x - y)));
+    }
+  }
+  return diff;
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  int iterations = argc > 1 ? std::max(1, std::atoi(argv[1])) : 20;
+  const std::string directory = argc > 2 ? argv[2] : "/tmp";
+  const std::string tiffPath = directory + "/depth_codec_benchmark.tiff";
+  const std::string codecPath = directory + "/depth_codec_benchmark.mdc";
+
+  const cv::Mat depth = MakeDepth();
+  DepthCodec::Options options;
+  DepthCodec::Options serialOptions;
+  serialOptions.parallel = false;
+
+  std::vector<uint8_t> encoded;
+  cv::Mat decoded;
+  double tiffWriteMs = MeasureMs(iterations, [&] { cv::imwrite(tiffPath, depth); });
+  double tiffReadMs = MeasureMs(iterations, [&] { decoded = cv::imread(tiffPath, cv::IMREAD_UNCHANGED); });
+  double serialEncodeMs = MeasureMs(iterations, [&] { DepthCodec::Encode(depth, encoded, serialOptions); });
+  double encodeMs = MeasureMs(iterations, [&] { DepthCodec::Encode(depth, encoded, options); });
+  double serialDecodeMs = MeasureMs(iterations, [&] { DepthCodec::Decode(encoded, decoded, false); });
+  double decodeMs = MeasureMs(iterations, [&] { DepthCodec::Decode(encoded, decoded, true); });
+  double codecWriteMs = MeasureMs(iterations, [&] { DepthCodec::WriteFile(codecPath, depth, options); });
+
+  const double rawBytes = static_cast<double>(depth.total() * depth.elemSize());
+  std::cout << "Depth codec, " << kWidth << "x" << kHeight << ", " << iterations << " iterations, "
+            << ThreadPool::Shared().Size() << " pool threads, AVX2 " << (CpuSupportsAvx2() ? "on" : "off")
+            << std::endl;
+  std::cout << std::fixed << std::setprecision(3);
+  std::cout << "  TIFF write         : " << tiffWriteMs << " ms/frame" << std::endl;
+  std::cout << "  TIFF read          : " << tiffReadMs << " ms/frame" << std::endl;
+  std::cout << "  encode, 1 core     : " << serialEncodeMs << " ms/frame" << std::endl;
+  std::cout << "  encode, pool       : " << encodeMs << " ms/frame" << std::endl;
+  std::cout << "  decode, 1 core     : " << serialDecodeMs << " ms/frame" << std::endl;
+  std::cout << "  decode, pool       : " << decodeMs << " ms/frame" << std::endl;
+  std::cout << "  encode + write     : " << codecWriteMs << " ms/frame (x" << tiffWriteMs / codecWriteMs
+            << " vs TIFF)" << std::endl;
+  std::cout << std::setprecision(2);
+  std::cout << "  size               : " << encoded.size() / 1024.0 << " KiB (x" << rawBytes / encoded.size()
+            << " vs raw float)" << std::endl;
+  std::cout << std::setprecision(6);
+  std::cout << "  max abs diff (mm)  : " << MaxAbsDiff(depth, decoded) << std::endl;
+
+  std::remove(tiffPath.c_str());
+  std::remove(codecPath.c_str());
+  return 0;
+}
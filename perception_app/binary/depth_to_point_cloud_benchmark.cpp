@@ -0,0 +1,95 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include "camera/processing/DepthProjector.hpp"
+#include "camera/utils/ThreadPool.hpp"
+
+namespace {
+
+constexpr size_t kWidth = 1920;
+constexpr size_t kHeight = 1200;
+
+// Reference implementation: the per-pixel divide/modulo loop previously used by FrameSet
+void LegacyConvertDepthToPointCloud(const mmind::eye::DepthMap &depth, const mmind::eye::CameraIntrinsics &intrinsics,
+                                    mmind::eye::PointCloud &pointCloud) {
+  pointCloud.resize(depth.width(), depth.height());
+
+  for (size_t i = 0; i < depth.width() * depth.height(); i++) {
+    const unsigned row = i / depth.width();
+    const unsigned col = i - row * depth.width();
+    pointCloud[i].z = depth[i].z;
+    pointCloud[i].x = static_cast<float>(pointCloud[i].z * (col - intrinsics.depth.cameraMatrix.cx) /
+                                         intrinsics.depth.cameraMatrix.fx);
+    pointCloud[i].y = static_cast<float>(pointCloud[i].z * (row - intrinsics.depth.cameraMatrix.cy) /
+                                         intrinsics.depth.cameraMatrix.fy);
+  }
+}
+
+double MeasureMs(int iterations, const std::function<void()> &body) {
+  body();  // warm-up, also allocates the output cloud
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < iterations; ++i) {
+    body();
+  }
+  auto elapsed = std::chrono::steady_clock::now() - start;
+  return std::chrono::duration<double, std::milli>(elapsed).count() / iterations;
+}
+
+double MaxAbsDiff(const mmind::eye::PointCloud &a, const mmind::eye::PointCloud &b) {
+  double diff = 0.0;
+  for (size_t i = 0; i < a.width() * a.height(); ++i) {
+    if (std::isnan(a[i].z) != std::isnan(b[i].z)) return INFINITY;
+    if (std::isnan(a[i].z)) continue;
+    diff = std::max(diff, static_cast<double>(std::fabs(a[i].x - b[i].x)));
+    diff = std::max(diff, static_cast<double>(std::fabs(a[i].y - b[i].y)));
+    diff = std::max(diff, static_cast<double>(std::fabs(a[i].z - b[i].z)));
+  }
+  return diff;
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  int iterations = argc > 1 ? std::max(1, std::atoi(argv[1])) : 50;
+
+  mmind::eye::CameraIntrinsics intrinsics;
+  intrinsics.depth.cameraMatrix.fx = 2270.5;
+  intrinsics.depth.cameraMatrix.fy = 2270.1;
+  intrinsics.depth.cameraMatrix.cx = 965.3;
+  intrinsics.depth.cameraMatrix.cy = 597.8;
+
+  // Synthetic depth map in the working range with ~5% invalid (NaN) pixels
+  mmind::eye::DepthMap depth;
+  depth.resize(kWidth, kHeight);
+  std::mt19937 rng(42);
+  std::uniform_real_distribution<float> range(400.0f, 1800.0f);
+  std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+  for (size_t i = 0; i < kWidth * kHeight; ++i) {
+    depth[i].z = unit(rng) < 0.05f ? NAN : range(rng);
+  }
+
+  mmind::eye::PointCloud legacyCloud;
+  mmind::eye::PointCloud serialCloud;
+  mmind::eye::PointCloud parallelCloud;
+  auto projector = DepthProjector::Get(intrinsics.depth.cameraMatrix, kWidth, kHeight);
+
+  double legacyMs = MeasureMs(iterations, [&] { LegacyConvertDepthToPointCloud(depth, intrinsics, legacyCloud); });
+  double serialMs = MeasureMs(iterations, [&] { projector->Project(depth, serialCloud, false); });
+  double parallelMs = MeasureMs(iterations, [&] { projector->Project(depth, parallelCloud, true); });
+
+  std::cout << "Depth to point cloud, " << kWidth << "x" << kHeight << ", " << iterations << " iterations, "
+            << ThreadPool::Shared().Size() << " pool threads, AVX2 " << (CpuSupportsAvx2() ? "on" : "off")
+            << std::endl;
+  std::cout << std::fixed << std::setprecision(3);
+  std::cout << "  legacy loop        : " << legacyMs << " ms/frame" << std::endl;
+  std::cout << "  LUT + SIMD, 1 core : " << serialMs << " ms/frame (x" << legacyMs / serialMs << ")" << std::endl;
+  std::cout << "  LUT + SIMD, pool   : " << parallelMs << " ms/frame (x" << legacyMs / parallelMs << ")" << std::endl;
+  std::cout << std::setprecision(6);
+  std::cout << "  max abs diff (mm)  : " << MaxAbsDiff(legacyCloud, parallelCloud) << std::endl;
+  return 0;
+}
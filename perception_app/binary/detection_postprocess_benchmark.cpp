@@ -0,0 +1,160 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <vector>
+#include "camera/processing/DetectionPostprocessor.hpp"
+#include "camera/utils/SimdSupport.hpp"
+
+namespace {
+
+constexpr size_t kCandidates = 10000;
+constexpr int kObjects = 250;
+constexpr int kClasses = 4;
+
+double MeasureMs(int iterations, const std::function<void()> &body) {
+  body();  // warm-up
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < iterations; ++i) {
+    body();
+  }
+  auto elapsed = std::chrono::steady_clock::now() - start;
+  return std::chrono::duration<double, std::milli>(elapsed).count() / iterations;
+}
+
+// Dense detector output: ~40 jittered proposals per object on a 1920x1200 image, like anchors around each hit
+std::vector<Detection> MakeCandidates() {
+  std::mt19937 rng(42);
+  std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+  std::normal_distribution<float> jitter(0.0f, 0.08f);
+
+  std::vector<Detection> objects(kObjects);
+  for (auto &object : objects) {
+    object.class_id = static_cast<int32_t>(rng() % kClasses);
+    object.width = 40.0f + 200.0f * unit(rng);
+    object.height = 40.0f + 200.0f * unit(rng);
+    object.x = (1920.0f - object.width) * unit(rng);
+    object.y = (1200.0f - object.height) * unit(rng);
+  }
+
+  std::vector<Detection> candidates(kCandidates);
+  for (auto &candidate : candidates) {
+    const Detection &object = objects[rng() % kObjects];
+    candidate.class_id = object.class_id;
+    candidate.width = object.width * (1.0f + jitter(rng));
+    candidate.height = object.height * (1.0f + jitter(rng));
+    candidate.x = object.x + object.width * jitter(rng);
+    candidate.y = object.y + object.height * jitter(rng);
+    candidate.score = unit(rng);
+  }
+  return candidates;
+}
+
+// Textbook greedy NMS: full sort, pairwise suppression over all candidates, truncation afterwards
+void NaiveNms(const std::vector<Detection> &candidates, float threshold, size_t maxDetections,
+              std::vector<Detection> &detections) {
+  std::vector<size_t> order(candidates.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(),
+                   [&candidates](size_t a, size_t b) { return candidates[a].score > candidates[b].score; });
+
+  auto iou = [](const Detection &a, const Detection &b) {
+    const float width = std::max(std::min(a.x + a.width, b.x + b.width) - std::max(a.x, b.x), 0.0f);
+    const float height = std::max(std::min(a.y + a.height, b.y + b.height) - std::max(a.y, b.y), 0.0f);
+    const float intersection = width * height;
+    const float unionArea = a.width * a.height + b.width * b.height - intersection;
+    return unionArea > 0.0f ? intersection / unionArea : 0.0f;
+  };
+
+  std::vector<bool> suppressed(candidates.size(), false);
+  detections.clear();
+  for (size_t i = 0; i < order.size(); ++i) {
+    if (suppressed[i]) continue;
+    const Detection &kept = candidates[order[i]];
+    detections.push_back(kept);
+    for (size_t j = i + 1; j < order.size(); ++j) {
+      const Detection &other = candidates[order[j]];
+      if (!suppressed[j] && other.class_id == kept.class_id && iou(kept, other) > threshold) {
+        suppressed[j] = true;
+      }
+    }
+  }
+  if (detections.size() > maxDetections) {
+    detections.resize(maxDetections);
+  }
+}
+
+bool SameDetections(const std::vector<Detection> &a, const std::vector<Detection> &b) {
+  return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin(), [](const Detection &x, const Detection &y) {
+           return x.class_id == y.class_id && x.score == y.score && x.x == y.x && x.y == y.y;
+         });
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  const int iterations = argc > 1 ? std::max(1, std::atoi(argv[1])) : 20;
+  const std::vector<Detection> candidates = MakeCandidates();
+
+  DetectionPostprocessor::Options options;
+  options.nms_threshold = 0.5f;
+  options.max_detections = 100;
+  DetectionPostprocessor greedy(options);
+
+  DetectionPostprocessor::Options unlimitedOptions = options;
+  unlimitedOptions.max_detections = 0;
+  DetectionPostprocessor greedyUnlimited(unlimitedOptions);
+
+  DetectionPostprocessor::Options linearOptions = options;
+  linearOptions.method = DetectionPostprocessor::Method::SoftLinear;
+  linearOptions.score_threshold = 0.001f;
+  DetectionPostprocessor softLinear(linearOptions);
+
+  DetectionPostprocessor::Options gaussianOptions = linearOptions;
+  gaussianOptions.method = DetectionPostprocessor::Method::SoftGaussian;
+  DetectionPostprocessor softGaussian(gaussianOptions);
+
+  DetectionPostprocessor::BoxSet boxes;
+  for (size_t i = 0; i < candidates.size(); ++i) {
+    boxes.Push(candidates[i], static_cast<uint32_t>(i));
+  }
+  std::vector<float> iou(boxes.Size());
+
+  std::vector<Detection> naive;
+  std::vector<Detection> naiveAll;
+  std::vector<Detection> detections;
+  std::vector<Detection> all;
+  std::vector<Detection> linear;
+  std::vector<Detection> gaussian;
+  const double naiveMs = MeasureMs(iterations, [&] { NaiveNms(candidates, 0.5f, 100, naive); });
+  const double naiveAllMs =
+      MeasureMs(iterations, [&] { NaiveNms(candidates, 0.5f, candidates.size(), naiveAll); });
+  const double greedyMs = MeasureMs(iterations, [&] { greedy.Run(candidates, detections); });
+  const double greedyAllMs = MeasureMs(iterations, [&] { greedyUnlimited.Run(candidates, all); });
+  const double linearMs = MeasureMs(iterations, [&] { softLinear.Run(candidates, linear); });
+  const double gaussianMs = MeasureMs(iterations, [&] { softGaussian.Run(candidates, gaussian); });
+  const double iouMs = MeasureMs(iterations * 100, [&] {
+    DetectionPostprocessor::ComputeIoU(candidates[0], boxes, true, iou.data());
+  });
+
+  std::cout << "Detection postprocessing, " << candidates.size() << " candidates, " << kObjects << " objects, "
+            << kClasses << " classes, " << iterations << " iterations, AVX2 " << (CpuSupportsAvx2() ? "on" : "off")
+            << std::endl;
+  std::cout << std::fixed << std::setprecision(3);
+  std::cout << "  naive NMS, top 100      : " << naiveMs << " ms" << std::endl;
+  std::cout << "  greedy NMS, top 100     : " << greedyMs << " ms (x" << naiveMs / greedyMs << " vs naive), "
+            << detections.size() << " kept" << std::endl;
+  std::cout << "  naive NMS, unlimited    : " << naiveAllMs << " ms" << std::endl;
+  std::cout << "  greedy NMS, unlimited   : " << greedyAllMs << " ms (x" << naiveAllMs / greedyAllMs
+            << " vs naive), " << all.size() << " kept" << std::endl;
+  std::cout << "  soft-NMS linear, top 100: " << linearMs << " ms" << std::endl;
+  std::cout << "  soft-NMS gauss, top 100 : " << gaussianMs << " ms" << std::endl;
+  std::cout << "  batched IoU, 1 x " << boxes.Size() << ": " << iouMs * 1000.0 << " us" << std::endl;
+  std::cout << "  matches naive           : "
+            << (SameDetections(naive, detections) && SameDetections(naiveAll, all) ? "yes" : "NO") << std::endl;
+  return 0;
+}
@@ -0,0 +1,79 @@
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include "camera/storage/FrameContainer.hpp"
+#include "camera/storage/PlyConverter.hpp"
+
+namespace {
+
+void PrintUsage(const char *program) {
+  std::cout << "Usage:\n"
+            << "  " << program << " info <frame.mfc>\n"
+            << "  " << program << " to-ply <frame.mfc> <out.ply> [--ascii] [--keep-invalid]\n"
+            << "  " << program << " from-ply <in.ply> <frame.mfc>\n";
+}
+
+int PrintInfo(const std::string &path) {
+  MappedFrameContainer container;
+  if (!container.Open(path)) return 1;
+
+  const FrameContainerHeader &header = container.Header();
+  const mmind::eye::CameraIntrinsics intrinsics = container.Intrinsics();
+  std::cout << "File:      " << path << " (" << header.file_size << " bytes, version " << header.version << ")\n"
+            << "Frame:     " << container.Suffix() << "\n"
+            << "Camera:    " << (container.CameraId().empty() ? "-" : container.CameraId()) << "\n"
+            << std::fixed << std::setprecision(3) << "Depth K:   fx=" << intrinsics.depth.cameraMatrix.fx
+            << " fy=" << intrinsics.depth.cameraMatrix.fy << " cx=" << intrinsics.depth.cameraMatrix.cx
+            << " cy=" << intrinsics.depth.cameraMatrix.cy << "\n"
+            << "Origin:    " << container.PointsOrigin().x << ", " << container.PointsOrigin().y << "\n"
+            << "Sections:\n";
+  for (const auto &section : container.Sections()) {
+    std::cout << "  " << std::left << std::setw(10)
+              << FrameContainerSectionTypeToString(static_cast<FrameContainerSectionType>(section.type))
+              << std::right << section.width << "x" << section.height << " x " << section.element_size
+              << " B @ " << section.offset << "\n";
+  }
+  return 0;
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  if (argc < 3) {
+    PrintUsage(argv[0]);
+    return 1;
+  }
+
+  const std::string command = argv[1];
+  if (command == "info") {
+    return PrintInfo(argv[2]);
+  }
+
+  if (argc < 4) {
+    PrintUsage(argv[0]);
+    return 1;
+  }
+
+  if (command == "to-ply") {
+    PlyConverter::Options options;
+    for (int i = 4; i < argc; ++i) {
+      if (std::strcmp(argv[i], "--ascii") == 0) {
+        options.binary = false;
+      } else if (std::strcmp(argv[i], "--keep-invalid") == 0) {
+        options.skip_invalid = false;
+      } else {
+        PrintUsage(argv[0]);
+        return 1;
+      }
+    }
+    return PlyConverter::ContainerToPly(argv[2], argv[3], options) ? 0 : 1;
+  }
+
+  if (command == "from-ply") {
+    return PlyConverter::PlyToContainer(argv[2], argv[3]) ? 0 : 1;
+  }
+
+  PrintUsage(argv[0]);
+  return 1;
+}
@@ -3,6 +3,58 @@
 #include "configure/ConfigHelper.hpp"
 #include "InferenceInterface.hpp"
 #include "ExampleInference.hpp"
+#include "client_node/ClientNode.hpp"
+#include "message/ProtocolDefinitions.hpp"
+
+namespace {
+// Listen for EMERGENCY_STOP requests in every phase and dump the event recorder around them
+std::unique_ptr<perception::ClientNode> StartEmergencyStopListener(CameraManager &cameraManager) {
+  using namespace perception;
+  const auto &communication = ConfigHelper::getInstance().communication_config_;
+  ClientNode::Config config;
+  config.discovery_address = communication.service_discovery.local_address;
+  config.discovery_port = communication.service_discovery.discovery_port;
+  config.device_client_id = communication.client.id;
+  config.device_client_name = communication.client.name;
+  config.enable_controller_client = false;
+
+  auto node = std::make_unique<ClientNode>(config);
+  if (!node->Initialize()) {
+    LOG_ERROR_STREAM << "Failed to initialize client node, emergency stop will not trigger recording";
+    return nullptr;
+  }
+
+  // The router matches the exact phase code, so register the callback for each of them
+  const uint8_t phases[] = {SubMessageIds::IDLE,
+                            SubMessageIds::INITIALIZING,
+                            SubMessageIds::CONNECTING,
+                            SubMessageIds::READY,
+                            SubMessageIds::ERROR,
+                            SubMessageIds::DEVICE_SELF_CHECK,
+                            SubMessageIds::COVER_OPERATION,
+                            SubMessageIds::TARGET_DETECTION,
+                            SubMessageIds::PATH_PLANNING,
+                            SubMessageIds::INSERTION,
+                            SubMessageIds::REMOVAL,
+                            SubMessageIds::CONNECTION_VERIFICATION,
+                            SubMessageIds::COMPLETED};
+  for (uint8_t phase : phases) {
+    node->RegisterMessageCallback(MessageType::Request, MessageIds::EMERGENCY_STOP, phase,
+                                  [&cameraManager](std::shared_ptr<ITransport>, uint16_t, uint8_t sub_message_id,
+                                                   const std::vector<uint8_t> &) {
+                                    LOG_WARNING_STREAM << "Emergency stop received in phase 0x" << std::hex
+                                                       << static_cast<int>(sub_message_id) << std::dec;
+                                    cameraManager.TriggerRecording("emergency_stop");
+                                  });
+  }
+
+  if (!node->Start()) {
+    LOG_ERROR_STREAM << "Failed to start client node, emergency stop will not trigger recording";
+    return nullptr;
+  }
+  return node;
+}
+}  // namespace
 
 int main() {
   // Initialize logging system
@@ -29,7 +81,16 @@ int main() {
   cameraManager.Init();
   cameraManager.Connect();
 
+  std::unique_ptr<perception::ClientNode> emergencyStopListener;
+  const auto &recorder = config.camera_config_.recorder;
+  if (recorder.enable && recorder.trigger_on_emergency_stop) {
+    emergencyStopListener = StartEmergencyStopListener(cameraManager);
+  }
+
   cameraManager.Start();
+  if (emergencyStopListener) {
+    emergencyStopListener->Stop();
+  }
   cameraManager.Stop();
 
   LOG_INFO_STREAM << "Application finished with stream operator";
@@ -1,12 +1,11 @@
 #include "ExampleInference.hpp"
 #include "Logger.hpp"
+#include <chrono>
 #include <fstream>
-#include <sstream>
 #include <nlohmann/json.hpp>
 
 ExampleInference::ExampleInference()
     : is_initialized_(false),
-      last_result_("No result available"),
       processed_frame_count_(0),
       confidence_threshold_(0.5),
       min_object_size_(100),
@@ -21,6 +20,9 @@ bool ExampleInference::Initialize(const std::string &config_path) {
   }
 
   try {
+    TensorPreprocessor::Options preprocessing;
+    DetectionPostprocessor::Options postprocessing;
+
     // Read config file
     std::ifstream config_file(config_path);
     if (!config_file.is_open()) {
@@ -39,6 +41,14 @@ bool ExampleInference::Initialize(const std::string &config_path) {
       if (config.contains("model_path")) {
         model_path_ = config["model_path"];
       }
+      if (!TensorPreprocessor::ParseOptions(config, preprocessing)) {
+        LOG_ERROR_STREAM << "Invalid input_size or preprocessing in " << config_path;
+        return false;
+      }
+      if (!DetectionPostprocessor::ParseOptions(config, postprocessing)) {
+        LOG_ERROR_STREAM << "Invalid postprocessing in " << config_path;
+        return false;
+      }
 
       LOG_INFO_STREAM << "Loaded config from: " << config_path;
     }
@@ -46,13 +56,19 @@ bool ExampleInference::Initialize(const std::string &config_path) {
     // Here you can add actual model loading logic
     // For example: load deep learning model, initialize inference engine, etc.
 
+    preprocessor_ = std::make_unique<TensorPreprocessor>(preprocessing);
+    postprocessor_ = std::make_unique<DetectionPostprocessor>(postprocessing);
+
     is_initialized_ = true;
     processed_frame_count_ = 0;
-    last_result_ = "Initialized successfully";
+    results_.Reset();
 
     LOG_INFO_STREAM << "ExampleInference initialized successfully";
     LOG_INFO_STREAM << "Config: confidence_threshold=" << confidence_threshold_
-                    << ", min_object_size=" << min_object_size_ << ", model_path=" << model_path_;
+                    << ", min_object_size=" << min_object_size_ << ", model_path=" << model_path_
+                    << ", input_size=" << preprocessing.width << "x" << preprocessing.height
+                    << ", channels=" << preprocessor_->Channels() << ", nms_threshold=" << postprocessing.nms_threshold
+                    << ", max_detections=" << postprocessing.max_detections;
 
     return true;
   } catch (const std::exception &e) {
@@ -68,28 +84,57 @@ bool ExampleInference::Process(const FrameSet &frame_set) {
   }
 
   try {
-    std::stringstream result_stream;
-    result_stream << "Frame " << processed_frame_count_ << " processed: ";
+    // Filled in place: the buffer reuses objects no reader holds any more, so steady state does not allocate
+    InferenceResult &result = results_.Acquire();
+    result.frame_id = frame_set.suffix;
+    result.camera_id = frame_set.camera_id;
+    result.sequence = processed_frame_count_;
+
+    auto stage_start = std::chrono::steady_clock::now();
+    auto end_stage = [&result, &stage_start](const char *name) {
+      const auto now = std::chrono::steady_clock::now();
+      result.AddTiming(name, now - stage_start);
+      stage_start = now;
+    };
+
+    // Model input: resize, channel order, normalization and CHW layout in one pass over the color image
+    if (frame_set.IsAvailable(FrameProduct::Color)) {
+      const bool with_depth =
+          preprocessor_->GetOptions().include_depth && frame_set.IsAvailable(FrameProduct::Depth);
+      const cv::Mat &input =
+          preprocessor_->Process(frame_set.GetColor(), with_depth ? frame_set.GetDepthImage() : cv::Mat());
+      if (input.empty()) {
+        LOG_WARNING_STREAM << "Color image is not CV_8UC3, model input not generated";
+      }
+      // Here input.data would be handed to the inference engine
+      end_stage("preprocess");
+    }
 
     // Process 2D color image
-    if (frame_set.hasColor) {
-      std::string color_result = ProcessColorImage(frame_set.color);
-      result_stream << "Color: " << color_result << "; ";
+    if (frame_set.IsAvailable(FrameProduct::Color)) {
+      ProcessColorImage(frame_set.GetColor(), result);
+      end_stage("color");
     }
 
     // Process depth image
-    if (frame_set.hasDepth) {
-      std::string depth_result = ProcessDepthImage(frame_set.depthImage);
-      result_stream << "Depth: " << depth_result << "; ";
+    if (frame_set.IsAvailable(FrameProduct::Depth)) {
+      ProcessDepthImage(frame_set.GetDepthImage(), result);
+      end_stage("depth");
     }
 
-    // Process point cloud data
-    if (frame_set.hasPointCloud) {
-      std::string pointcloud_result = ProcessPointCloud(frame_set.pointCloud);
-      result_stream << "PointCloud: " << pointcloud_result << "; ";
+    // Process point cloud data (downsampled as configured; full density when downsampling is off)
+    if (frame_set.IsAvailable(FrameProduct::DownsampledPointCloud)) {
+      ProcessPointCloud(frame_set.GetDownsampledPointCloud(), result);
+      end_stage("point_cloud");
     }
 
-    last_result_ = result_stream.str();
+    // Candidates are swapped out rather than copied, so both vectors keep their capacity across frames
+    candidates_.swap(result.detections);
+    postprocessor_->Run(candidates_, result.detections);
+    end_stage("postprocess");
+
+    result.success = true;
+    results_.Publish();
     processed_frame_count_++;
 
     LOG_DEBUG_STREAM << "Processed frame " << processed_frame_count_ << " with ExampleInference";
@@ -100,7 +145,12 @@ bool ExampleInference::Process(const FrameSet &frame_set) {
   }
 }
 
-std::string ExampleInference::GetResult() const { return last_result_; }
+std::string ExampleInference::GetResult() const {
+  const auto latest = results_.Latest();
+  return latest ? latest->ToString() : "No result available";
+}
+
+std::shared_ptr<const InferenceResult> ExampleInference::GetLatestResult() const { return results_.Latest(); }
 
 void ExampleInference::Cleanup() {
   if (is_initialized_) {
@@ -108,7 +158,9 @@ void ExampleInference::Cleanup() {
     // For example: release model resources, close inference engine, etc.
 
     is_initialized_ = false;
-    last_result_ = "Cleaned up";
+    results_.Reset();
+    preprocessor_.reset();
+    postprocessor_.reset();
     LOG_INFO_STREAM << "ExampleInference cleaned up";
   }
 }
@@ -117,49 +169,57 @@ bool ExampleInference::IsInitialized() const { return is_initialized_; }
 
 std::string ExampleInference::GetAlgorithmName() const { return "ExampleInference"; }
 
-std::string ExampleInference::ProcessColorImage(const cv::Mat &color_image) {
+FrameProductMask ExampleInference::GetRequiredProducts() const {
+  return ToProductMask(FrameProduct::Color) | ToProductMask(FrameProduct::Depth) |
+         ToProductMask(FrameProduct::DownsampledPointCloud);
+}
+
+// Each result depends on the current frame only, so an unchanged scene yields the same result
+bool ExampleInference::RunOnlyOnSceneChange() const { return true; }
+
+void ExampleInference::ProcessColorImage(const cv::Mat &color_image, InferenceResult &result) {
   if (color_image.empty()) {
-    return "Empty image";
+    return;
   }
 
   // Example: simple image processing
-  cv::Mat gray_image;
-  cv::cvtColor(color_image, gray_image, cv::COLOR_BGR2GRAY);
-
-  // Calculate image statistics
-  cv::Scalar mean_val = cv::mean(gray_image);
-  cv::Scalar stddev_val, mean_val2;
-  cv::meanStdDev(gray_image, mean_val2, stddev_val);
-
-  std::stringstream result;
-  result << "Size: " << color_image.size() << ", Mean: " << mean_val[0] << ", Channels: " << color_image.channels();
-
-  return result.str();
+  cv::cvtColor(color_image, gray_image_, cv::COLOR_BGR2GRAY);
+  const cv::Scalar mean_val = cv::mean(gray_image_);
+
+  Detection detection;
+  detection.class_id = 0;
+  detection.score = static_cast<float>(mean_val[0] / 255.0);
+  detection.width = static_cast<float>(color_image.cols);
+  detection.height = static_cast<float>(color_image.rows);
+  result.detections.push_back(detection);
 }
 
-std::string ExampleInference::ProcessDepthImage(const cv::Mat &depth_image) {
+void ExampleInference::ProcessDepthImage(const cv::Mat &depth_image, InferenceResult &result) {
   if (depth_image.empty()) {
-    return "Empty depth image";
+    return;
   }
 
-  // Example: depth image processing
-  double min_val, max_val;
-  cv::minMaxLoc(depth_image, &min_val, &max_val);
-
-  // Calculate valid depth pixel count
-  cv::Mat valid_mask = (depth_image > 0);
-  int valid_pixels = cv::countNonZero(valid_mask);
-
-  std::stringstream result;
-  result << "Size: " << depth_image.size() << ", Min: " << min_val << ", Max: " << max_val
-         << ", Valid pixels: " << valid_pixels;
+  // Example: region of valid depth pixels
+  cv::compare(depth_image, 0, valid_mask_, cv::CMP_GT);
+  const int valid_pixels = cv::countNonZero(valid_mask_);
+  if (valid_pixels == 0) {
+    return;
+  }
 
-  return result.str();
+  const cv::Rect region = cv::boundingRect(valid_mask_);
+  Detection detection;
+  detection.class_id = 1;
+  detection.score = static_cast<float>(valid_pixels) / static_cast<float>(depth_image.total());
+  detection.x = static_cast<float>(region.x);
+  detection.y = static_cast<float>(region.y);
+  detection.width = static_cast<float>(region.width);
+  detection.height = static_cast<float>(region.height);
+  result.detections.push_back(detection);
 }
 
-std::string ExampleInference::ProcessPointCloud(const mmind::eye::PointCloud &point_cloud) {
+void ExampleInference::ProcessPointCloud(const mmind::eye::PointCloud &point_cloud, InferenceResult &result) {
   if (point_cloud.isEmpty()) {
-    return "Empty point cloud";
+    return;
   }
 
   // Example: point cloud processing
@@ -184,9 +244,12 @@ std::string ExampleInference::ProcessPointCloud(const mmind::eye::PointCloud &po
     max_z = std::max(max_z, point.z);
   }
 
-  std::stringstream result;
-  result << "Points: " << point_count << ", BBox: [" << min_x << "," << min_y << "," << min_z << "] to [" << max_x
-         << "," << max_y << "," << max_z << "]";
-
-  return result.str();
+  // The bounding box center, axis aligned
+  Pose pose;
+  pose.class_id = 2;
+  pose.score = 1.0f;
+  pose.position_mm[0] = 0.5f * (min_x + max_x);
+  pose.position_mm[1] = 0.5f * (min_y + max_y);
+  pose.position_mm[2] = 0.5f * (min_z + max_z);
+  result.poses.push_back(pose);
 }
@@ -1,8 +1,12 @@
 #pragma once
 
 #include "InferenceInterface.hpp"
+#include <memory>
 #include <opencv2/opencv.hpp>
 #include <string>
+#include <vector>
+#include "runtime/camera/processing/DetectionPostprocessor.hpp"
+#include "runtime/camera/processing/TensorPreprocessor.hpp"
 
 /**
  * @brief 示例推理算法类
@@ -38,10 +42,16 @@ public:
 
     /**
      * @brief 获取推理结果
-     * @return 推理结果的字符串表示
+     * @return 最新结构化结果的文本摘要
      */
     std::string GetResult() const override;
 
+    /**
+     * @brief 获取最新的结构化推理结果
+     * @return 尚未处理任何帧时为空
+     */
+    std::shared_ptr<const InferenceResult> GetLatestResult() const override;
+
     /**
      * @brief 清理资源
      */
@@ -59,32 +69,55 @@ public:
      */
     std::string GetAlgorithmName() const override;
 
+    /**
+     * @brief 获取算法需要的帧数据产品
+     * @return 彩色图、深度图和变换后的点云
+     */
+    FrameProductMask GetRequiredProducts() const override;
+
+    /**
+     * @brief 结果只取决于当前帧，场景未变化的帧无需处理
+     * @return true
+     */
+    bool RunOnlyOnSceneChange() const override;
+
 private:
     /**
      * @brief 处理2D图像
      * @param color_image 彩色图像
-     * @return 处理结果
+     * @param result 输出：整幅图像作为一个检测框，置信度为灰度均值（归一化到 0-1）
      */
-    std::string ProcessColorImage(const cv::Mat& color_image);
+    void ProcessColorImage(const cv::Mat& color_image, InferenceResult& result);
 
     /**
      * @brief 处理深度图像
      * @param depth_image 深度图像
-     * @return 处理结果
+     * @param result 输出：有效深度区域的包围框，置信度为有效像素占比
      */
-    std::string ProcessDepthImage(const cv::Mat& depth_image);
+    void ProcessDepthImage(const cv::Mat& depth_image, InferenceResult& result);
 
     /**
      * @brief 处理点云数据
      * @param point_cloud 点云数据
-     * @return 处理结果
+     * @param result 输出：以点云包围盒中心为位置的位姿
      */
-    std::string ProcessPointCloud(const mmind::eye::PointCloud& point_cloud);
+    void ProcessPointCloud(const mmind::eye::PointCloud& point_cloud, InferenceResult& result);
 
 private:
     bool is_initialized_;
-    std::string last_result_;
-    int processed_frame_count_;
+    InferenceResultBuffer results_;
+    uint64_t processed_frame_count_;
+
+    // 跨帧复用的中间图像
+    cv::Mat gray_image_;
+    cv::Mat valid_mask_;
+
+    // 按配置的 input_size / preprocessing 生成模型输入张量
+    std::unique_ptr<TensorPreprocessor> preprocessor_;
+
+    // 按配置的 postprocessing 对候选检测做 NMS 和 top-k 截断
+    std::unique_ptr<DetectionPostprocessor> postprocessor_;
+    std::vector<Detection> candidates_;
     
     // 示例配置参数
     double confidence_threshold_;
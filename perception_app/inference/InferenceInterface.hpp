@@ -1,10 +1,79 @@
 #pragma once
 
+#include <any>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <future>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <vector>
+#include "InferenceResult.hpp"
 #include "runtime/camera/FrameSet.hpp"
+#include "runtime/camera/utils/LatencyHistogram.hpp"
 #include "Logger.hpp"
 
+/**
+ * @brief Per-frame view of the inference graph handed to one node
+ *
+ * Gives a node the frame being processed, the outputs its declared inputs published for this
+ * frame, and a slot for its own output. Outputs are passed as shared pointers to arbitrary types,
+ * so intermediate results (detections, masks, poses) travel between nodes without serialization
+ * or copies. Each node writes only its own slot and only reads nodes it declared as inputs, which
+ * have finished before it starts, so no locking is needed.
+ */
+class InferenceContext {
+public:
+    /**
+     * @brief Frame being processed, never null
+     */
+    const FrameSnapshot& Frame() const { return frame_; }
+
+    /**
+     * @brief Name of the node being run
+     */
+    const std::string& NodeName() const { return name_; }
+
+    /**
+     * @brief Get the output an input node published for this frame
+     * @param node Name of a node declared as input of the running node
+     * @return The output, or null if the node is not an input, published nothing, or published another type
+     */
+    template <typename T>
+    std::shared_ptr<const T> Input(const std::string& node) const {
+        const std::any* output = FindInput(node);
+        const auto* value = output ? std::any_cast<std::shared_ptr<const T>>(output) : nullptr;
+        return value ? *value : nullptr;
+    }
+
+    /**
+     * @brief Publish the output of the running node for its downstream nodes, replacing any earlier one
+     */
+    template <typename T>
+    void SetOutput(std::shared_ptr<T> output) {
+        output_ = std::shared_ptr<const T>(std::move(output));
+    }
+
+private:
+    friend class InferenceManager;
+
+    InferenceContext(const std::string& name, const FrameSnapshot& frame, const std::vector<std::string>& input_names,
+                     const std::vector<size_t>& inputs, const std::vector<std::any>& outputs, std::any& output)
+        : name_(name), frame_(frame), input_names_(input_names), inputs_(inputs), outputs_(outputs), output_(output) {}
+
+    const std::any* FindInput(const std::string& node) const;
+
+    const std::string& name_;
+    const FrameSnapshot& frame_;
+    const std::vector<std::string>& input_names_;
+    const std::vector<size_t>& inputs_;
+    const std::vector<std::any>& outputs_;  // Outputs of every node for this frame, indexed like the graph
+    std::any& output_;                      // Slot of the running node
+};
+
 /**
  * @brief Inference interface class for decoupling inference algorithms and runtime framework
  * 
@@ -37,12 +106,49 @@ public:
      */
     virtual bool Process(const FrameSet& frame_set) = 0;
 
+    /**
+     * @brief Process a published frame snapshot
+     *
+     * The snapshot is immutable and reference counted, so an algorithm that finishes its work
+     * asynchronously (worker thread, batching, network upload) can keep the pointer instead of
+     * deep-copying images or point clouds. The frame goes back to the pool only when the last
+     * snapshot is released; retained snapshots should be dropped as soon as they are done with.
+     * The default implementation calls Process(const FrameSet&).
+     *
+     * @param frame Frame snapshot, never null
+     * @return true Processing successful (or accepted for asynchronous processing), false Processing failed
+     */
+    virtual bool ProcessSnapshot(const FrameSnapshot& frame) { return Process(*frame); }
+
+    /**
+     * @brief Process a frame as a node of the inference graph
+     *
+     * Override to consume outputs of upstream nodes (context.Input<T>(name)) or to publish an
+     * output for downstream nodes (context.SetOutput(ptr)). The default implementation calls
+     * ProcessSnapshot(context.Frame()), so any algorithm can be used as an independent node.
+     *
+     * @param context Frame, input outputs and output slot of this node
+     * @return true Processing successful, false Processing failed; downstream nodes are then skipped
+     */
+    virtual bool ProcessNode(InferenceContext& context) { return ProcessSnapshot(context.Frame()); }
+
     /**
      * @brief Get inference results
      * @return String representation of inference results
      */
     virtual std::string GetResult() const = 0;
 
+    /**
+     * @brief Get the structured result of the latest processed frame
+     *
+     * Algorithms fill an InferenceResultBuffer instead of formatting strings per frame and
+     * return its latest published result here. The result is shared read-only, so callers can
+     * keep or serialize it without copying; GetResult() is then only needed for text output.
+     *
+     * @return Latest result, null if none is available or the algorithm only provides strings
+     */
+    virtual std::shared_ptr<const InferenceResult> GetLatestResult() const { return nullptr; }
+
     /**
      * @brief Clean up resources
      */
@@ -60,6 +166,39 @@ public:
      */
     virtual std::string GetAlgorithmName() const = 0;
 
+    /**
+     * @brief Get frame products consumed by this algorithm
+     *
+     * FrameSet computes derived products lazily. Products declared here are prefetched by the
+     * decode stage so their cost overlaps with processing of the previous frame; anything not
+     * declared is still computed on first access.
+     *
+     * @return Mask of FrameProduct values, see ToProductMask()
+     */
+    virtual FrameProductMask GetRequiredProducts() const { return kNoFrameProducts; }
+
+    /**
+     * @brief Whether this algorithm only needs frames in which the scene changed
+     *
+     * With scene change detection enabled, frames that match the last processed frame of the
+     * same camera (FrameSet::scene_changed is false) are neither decoded nor passed to Process()
+     * for algorithms returning true. Algorithms whose results depend on every frame (tracking,
+     * temporal statistics) should keep the default.
+     *
+     * @return true to skip unchanged frames
+     */
+    virtual bool RunOnlyOnSceneChange() const { return false; }
+
+    /**
+     * @brief Whether Process / ProcessSnapshot may run concurrently on several frames
+     *
+     * In asynchronous mode the inference manager only starts more than one worker for
+     * algorithms returning true.
+     *
+     * @return true if the algorithm is safe to call from several threads at once
+     */
+    virtual bool IsReentrant() const { return false; }
+
 protected:
     /**
      * @brief Default constructor
@@ -77,6 +216,24 @@ protected:
     InferenceInterface& operator=(const InferenceInterface&) = delete;
 };
 
+/**
+ * @brief Outcome of one asynchronous inference request
+ */
+struct InferenceOutcome {
+    enum class Status {
+        Completed,  // Processed successfully
+        Failed,     // Processed, but the algorithm reported a failure
+        Dropped     // Replaced by a newer frame (or discarded on shutdown) before a worker picked it up
+    };
+
+    std::string frame_id;  // FrameSet::suffix of the submitted frame
+    std::string camera_id;
+    Status status = Status::Dropped;
+    std::shared_ptr<const InferenceResult> result;      // Result produced for this frame, null if dropped or failed
+    std::chrono::steady_clock::duration queue_wait{0};  // From submission until a worker picked the frame up
+    std::chrono::steady_clock::duration model_latency{0};  // Time spent running the whole algorithm graph
+};
+
 /**
  * @brief Inference manager class responsible for managing inference interface instances
  * 
@@ -84,9 +241,34 @@ protected:
  * 1. Creating and managing inference interface instances
  * 2. Calling inference processing in CameraManager
  * 3. Providing unified inference result access interface
+ *
+ * Several algorithms can be composed into a directed acyclic graph with AddNode: each node names
+ * the nodes whose outputs it consumes, and a node may only depend on nodes added before it, which
+ * keeps the graph acyclic by construction. For every frame a node starts as soon as all its inputs
+ * have finished; independent nodes run concurrently on the shared thread pool. A node whose input
+ * failed is skipped. RegisterInference keeps the single-algorithm behavior: it replaces the graph
+ * with one node.
+ *
+ * In asynchronous mode SubmitAsync returns immediately and a pool of inference workers runs
+ * the algorithm. Input is a single latest-frame-wins slot rather than a queue: a frame that is
+ * still waiting when the next one arrives is dropped, so a slow model lowers the inference rate
+ * instead of building up latency or stalling capture.
  */
 class InferenceManager {
 public:
+    using Callback = std::function<void(const InferenceOutcome&)>;
+
+    /**
+     * @brief Asynchronous mode counters
+     */
+    struct AsyncStats {
+        size_t workers = 0;      // Running inference workers
+        uint64_t submitted = 0;  // Frames passed to SubmitAsync
+        uint64_t completed = 0;  // Frames processed successfully
+        uint64_t failed = 0;     // Frames the algorithm failed on
+        uint64_t dropped = 0;    // Frames replaced in the input slot before processing
+    };
+
     /**
      * @brief Get singleton instance
      * @return Reference to InferenceManager instance
@@ -101,8 +283,22 @@ public:
     bool RegisterInference(std::shared_ptr<InferenceInterface> inference_interface);
 
     /**
-     * @brief Initialize inference interface
-     * @param config_path Configuration file path
+     * @brief Add an algorithm as a node of the inference graph
+     *
+     * The graph must be initialized (again) with InitializeInference after nodes are added.
+     *
+     * @param name Unique node name, used by downstream nodes to look up its output
+     * @param inference_interface Algorithm run by the node
+     * @param inputs Names of nodes whose outputs this node consumes, all added before
+     * @param config_path Configuration file of this node, empty to use the one passed to InitializeInference
+     * @return true Node added, false Invalid algorithm, duplicate name or unknown input
+     */
+    bool AddNode(const std::string& name, std::shared_ptr<InferenceInterface> inference_interface,
+                 const std::vector<std::string>& inputs = {}, const std::string& config_path = "");
+
+    /**
+     * @brief Initialize every node of the inference graph
+     * @param config_path Configuration file path of nodes added without their own
      * @return true Initialization successful, false Initialization failed
      */
     bool InitializeInference(const std::string& config_path);
@@ -114,12 +310,31 @@ public:
      */
     bool Process(const FrameSet& frame_set);
 
+    /**
+     * @brief Process a frame snapshot that the algorithm may retain without copying
+     * @param frame Frame snapshot
+     * @return true Processing successful, false Processing failed
+     */
+    bool Process(const FrameSnapshot& frame);
+
     /**
      * @brief Get inference results
-     * @return String representation of inference results
+     * @return Result of the algorithm, or a JSON object of node name to result when the graph has several nodes
      */
     std::string GetResult() const;
 
+    /**
+     * @brief Get the structured result of the latest processed frame
+     * @return Result of the last node (in insertion order) that provides one, null if none does
+     */
+    std::shared_ptr<const InferenceResult> GetLatestResult() const;
+
+    /**
+     * @brief Get the structured result of one node of the graph
+     * @return Null if the node does not exist or provides no structured result
+     */
+    std::shared_ptr<const InferenceResult> GetLatestResult(const std::string& node) const;
+
     /**
      * @brief Clean up inference resources
      */
@@ -133,10 +348,68 @@ public:
 
     /**
      * @brief Get current inference algorithm name
-     * @return Algorithm name
+     * @return Algorithm name, or the comma separated node names when the graph has several nodes
      */
     std::string GetCurrentAlgorithmName() const;
 
+    /**
+     * @brief Get frame products consumed by any node of the graph
+     * @return Mask of FrameProduct values, empty if inference is not initialized
+     */
+    FrameProductMask GetRequiredProducts() const;
+
+    /**
+     * @brief Check if every node only needs frames in which the scene changed
+     * @return false if inference is not initialized
+     */
+    bool RunOnlyOnSceneChange() const;
+
+    /**
+     * @brief Start asynchronous mode
+     *
+     * Requires an initialized graph. More than one worker is only started if every node
+     * declares IsReentrant().
+     *
+     * @param workers Number of inference worker threads
+     * @return true Asynchronous mode running, false Inference not initialized
+     */
+    bool StartAsync(size_t workers = 1);
+
+    /**
+     * @brief Stop asynchronous mode, waiting for frames being processed; a frame still waiting is dropped
+     */
+    void StopAsync();
+
+    /**
+     * @brief Check if asynchronous mode is running
+     */
+    bool IsAsync() const;
+
+    /**
+     * @brief Hand a frame to the inference workers without waiting for it to be processed
+     *
+     * The callback runs on the worker thread (or on the submitting thread for a frame dropped
+     * by this call or rejected because asynchronous mode is not running) before the future is
+     * made ready. It must not call back into SubmitAsync.
+     *
+     * @param frame Frame snapshot, retained until processed or dropped
+     * @param callback Optional completion callback
+     * @return Future of the request outcome
+     */
+    std::future<InferenceOutcome> SubmitAsync(const FrameSnapshot& frame, Callback callback = nullptr);
+
+    /**
+     * @brief Get asynchronous mode counters
+     */
+    AsyncStats GetAsyncStats() const;
+
+    /**
+     * @brief Record queue wait and model latency of asynchronous requests, must be set before StartAsync
+     * @param queue_wait Histogram for the time frames wait in the input slot, may be null
+     * @param model Histogram for the time spent in the algorithm, may be null
+     */
+    void SetLatencyHistograms(LatencyHistogram* queue_wait, LatencyHistogram* model);
+
 private:
     /**
      * @brief Private constructor to implement singleton pattern
@@ -146,7 +419,7 @@ private:
     /**
      * @brief Private destructor
      */
-    ~InferenceManager() = default;
+    ~InferenceManager();
 
     /**
      * @brief Copy constructor (disabled)
@@ -158,7 +431,65 @@ private:
      */
     InferenceManager& operator=(const InferenceManager&) = delete;
 
+    /**
+     * @brief Log the outcome of processing one frame
+     */
+    bool LogProcessResult(bool success) const;
+
+    /**
+     * @brief A node of the inference graph
+     */
+    struct Node {
+        std::string name;
+        std::shared_ptr<InferenceInterface> algorithm;
+        std::string config_path;
+        std::vector<std::string> input_names;
+        std::vector<size_t> inputs;   // Indices of input nodes
+        std::vector<size_t> outputs;  // Indices of nodes consuming this one
+        size_t depth = 0;             // Longest path from a node without inputs
+    };
+
+    struct GraphRun;
+
+    /**
+     * @brief Run every node of the graph on one frame
+     * @param result Optional output: structured result of the last node that produced one for this frame,
+     *               either published as its graph output or reported by GetLatestResult() for the same frame
+     * @return true if every node succeeded
+     */
+    bool RunGraph(const FrameSnapshot& frame, std::shared_ptr<const InferenceResult>* result = nullptr);
+
+    bool RunNode(size_t index, GraphRun& run) const;
+
+    /**
+     * @brief A frame waiting in the input slot
+     */
+    struct Request {
+        FrameSnapshot frame;
+        Callback callback;
+        std::promise<InferenceOutcome> promise;
+        std::chrono::steady_clock::time_point submitted;
+    };
+
+    void WorkerLoop();
+
+    /**
+     * @brief Complete a request: update counters and histograms, run its callback and fulfil its future
+     */
+    void Finish(Request& request, InferenceOutcome& outcome);
+
 private:
-    std::shared_ptr<InferenceInterface> inference_interface_;
+    std::vector<Node> nodes_;  // In insertion order, which is a topological order
+    size_t graph_width_ = 0;   // Most nodes at one depth, bounds the threads a frame is run on
     bool is_initialized_ = false;
+
+    // Asynchronous mode
+    mutable std::mutex async_mutex_;
+    std::condition_variable async_cv_;
+    std::unique_ptr<Request> pending_;  // Latest-frame-wins input slot
+    std::vector<std::thread> workers_;
+    bool stopping_ = false;
+    AsyncStats async_stats_;
+    LatencyHistogram* queue_wait_timer_ = nullptr;
+    LatencyHistogram* model_timer_ = nullptr;
 };
@@ -0,0 +1,142 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * @brief 2D 检测结果
+ */
+struct Detection {
+    int32_t class_id = -1;
+    float score = 0.0f;
+    float x = 0.0f;  // 图像坐标系下的包围框（像素）
+    float y = 0.0f;
+    float width = 0.0f;
+    float height = 0.0f;
+};
+
+/**
+ * @brief 6D 位姿结果（点云坐标系）
+ */
+struct Pose {
+    int32_t class_id = -1;
+    float score = 0.0f;
+    float position_mm[3] = {0.0f, 0.0f, 0.0f};
+    float rotation[4] = {1.0f, 0.0f, 0.0f, 0.0f};  // 单位四元数 (w, x, y, z)
+};
+
+/**
+ * @brief 算法内部一个阶段的耗时
+ */
+struct StageTiming {
+    static constexpr size_t kMaxNameLength = 23;
+
+    char name[kMaxNameLength + 1] = {};  // 以 0 结尾，超长部分截断
+    float duration_ms = 0.0f;
+};
+
+/**
+ * @brief 结构化推理结果
+ *
+ * 算法把结果写入复用的对象（见 InferenceResultBuffer），Clear 只清空内容不释放容量，稳定运行后
+ * 每帧填充结果不再分配内存，热路径中也不再格式化字符串；ToString 只在需要文本时（日志、兼容旧的
+ * GetResult 接口）调用。
+ *
+ * Serialize 生成用于感知协议（MessageIds::INFERENCE_RESULT）的紧凑二进制格式，所有字段小端序：
+ *
+ *   magic "MIRS" (4) | version (2) | flags (2) | sequence (8) | frame_id 长度 (2) + 字节 |
+ *   camera_id 长度 (2) + 字节 | detection 数 (4) | pose 数 (4) | timing 数 (4) |
+ *   detections（每个 24 字节）| poses（每个 36 字节）| timings（名称长度 (1) + 名称 + 耗时 (4)）
+ *
+ * 结果较大时可经 PayloadChunker 分片发送。
+ */
+struct InferenceResult {
+    static constexpr char kMagic[4] = {'M', 'I', 'R', 'S'};
+    static constexpr uint16_t kVersion = 1;
+
+    std::string frame_id;   // FrameSet::suffix
+    std::string camera_id;  // FrameSet::camera_id
+    uint64_t sequence = 0;  // 算法处理的帧序号
+    bool success = false;
+    std::vector<Detection> detections;
+    std::vector<Pose> poses;
+    std::vector<StageTiming> timings;
+
+    /**
+     * @brief 清空内容，保留各容器已分配的容量
+     */
+    void Clear();
+
+    /**
+     * @brief 追加一个阶段耗时
+     * @param name 阶段名称，超过 StageTiming::kMaxNameLength 的部分截断
+     */
+    void AddTiming(const char* name, std::chrono::steady_clock::duration duration);
+
+    /**
+     * @brief 序列化后的字节数
+     */
+    size_t SerializedSize() const;
+
+    /**
+     * @brief 序列化为二进制，out 按需调整大小，复用其容量
+     * @return frame_id 或 camera_id 超过 65535 字节时返回 false
+     */
+    bool Serialize(std::vector<uint8_t>& out) const;
+
+    /**
+     * @brief 解析二进制结果，result 中已有的容量会被复用
+     * @return 数据不完整或格式不符时返回 false
+     */
+    static bool Deserialize(const uint8_t* data, size_t size, InferenceResult& result);
+
+    static bool Deserialize(const std::vector<uint8_t>& data, InferenceResult& result);
+
+    /**
+     * @brief 可读的文本摘要，用于日志和 GetResult
+     */
+    std::string ToString() const;
+};
+
+/**
+ * @brief 推理结果的发布缓冲
+ *
+ * 算法每帧 Acquire 一个可写的结果对象填充后 Publish；读者通过 Latest 获得最新结果的只读共享
+ * 指针，无需拷贝，持有期间该对象不会被改写。只有不再被读者持有的对象才会被 Acquire 复用
+ * （与 FramePool 回收帧的方式相同），因此稳定运行时只在少数几个对象之间轮换，不再分配内存。
+ *
+ * Acquire 与 Publish 应由同一个写者线程调用；Latest 可在任意线程调用。
+ */
+class InferenceResultBuffer {
+public:
+    /**
+     * @brief 获取一个已清空的可写结果对象，Publish 之前重复调用返回同一对象（再次清空）
+     */
+    InferenceResult& Acquire();
+
+    /**
+     * @brief 将 Acquire 得到的对象发布为最新结果
+     */
+    void Publish();
+
+    /**
+     * @brief 最新发布的结果，尚未发布时为空
+     */
+    std::shared_ptr<const InferenceResult> Latest() const;
+
+    /**
+     * @brief 丢弃已发布的结果，读者仍持有的对象不受影响
+     */
+    void Reset();
+
+private:
+    mutable std::mutex mutex_;
+    std::vector<std::shared_ptr<InferenceResult>> results_;  // 创建过的所有对象
+    std::shared_ptr<InferenceResult> writing_;
+    std::shared_ptr<const InferenceResult> latest_;
+};
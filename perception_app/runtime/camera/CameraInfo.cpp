@@ -6,3 +6,29 @@ void CameraInfo::InitCameraInfo(mmind::eye::Camera &camera) {
   transformation_ = getTransformationParams(camera);
   camera.getCameraIntrinsics(cameraIntrinsics_);
 }
+
+void CameraInfo::RegisterCamera(const std::string &serialNumber, mmind::eye::Camera &camera) {
+  CameraParams params;
+  params.transformation = getTransformationParams(camera);
+  camera.getCameraIntrinsics(params.intrinsics);
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (cameras_.empty()) {
+    camera_ = camera;
+    transformation_ = params.transformation;
+    cameraIntrinsics_ = params.intrinsics;
+  }
+  cameras_[serialNumber] = params;
+}
+
+bool CameraInfo::GetCameraParams(const std::string &serialNumber, mmind::eye::CameraIntrinsics &intrinsics,
+                                 mmind::eye::FrameTransformation &transformation) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = cameras_.find(serialNumber);
+  if (it == cameras_.end()) {
+    return false;
+  }
+  intrinsics = it->second.intrinsics;
+  transformation = it->second.transformation;
+  return true;
+}
@@ -1,5 +1,8 @@
 #pragma once
 
+#include <map>
+#include <mutex>
+#include <string>
 #include "area_scan_3d_camera/Camera.h"
 
 class CameraInfo
@@ -13,14 +16,37 @@ public:
 
     void InitCameraInfo(mmind::eye::Camera& camera);
 
+    /**
+     * @brief 读取相机内参和坐标变换，按序列号登记
+     *
+     * 第一个登记的相机同时作为默认相机，填充 camera_ / transformation_ / cameraIntrinsics_。
+     */
+    void RegisterCamera(const std::string& serialNumber, mmind::eye::Camera& camera);
+
+    /**
+     * @brief 按序列号查询已登记相机的内参和坐标变换
+     * @return 未登记时返回 false
+     */
+    bool GetCameraParams(const std::string& serialNumber, mmind::eye::CameraIntrinsics& intrinsics,
+                         mmind::eye::FrameTransformation& transformation) const;
+
 public:
     mmind::eye::Camera camera_;
     mmind::eye::FrameTransformation transformation_;
     mmind::eye::CameraIntrinsics cameraIntrinsics_;
 
 private:
+    struct CameraParams
+    {
+        mmind::eye::FrameTransformation transformation;
+        mmind::eye::CameraIntrinsics intrinsics;
+    };
+
     CameraInfo() = default;
     ~CameraInfo() = default;
     CameraInfo(const CameraInfo &) = delete;
     CameraInfo &operator=(const CameraInfo &) = delete;
+
+    mutable std::mutex mutex_;
+    std::map<std::string, CameraParams> cameras_;
 };
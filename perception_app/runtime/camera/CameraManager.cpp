@@ -1,29 +1,177 @@
 
 #include "CameraManager.hpp"
+#include <algorithm>
 #include <chrono>
+#include <future>
 #include <thread>
 #include <opencv2/imgcodecs.hpp>
 #include "utils/UtilHelper.h"
 #include "configure/ConfigHelper.hpp"
-#include "CameraInfo.hpp"
 #include "Logger.hpp"
 #include "InferenceInterface.hpp"
-#include <sys/stat.h>
-#include <sys/types.h>
+#include "source/FrameSource.hpp"
+#include "storage/DepthCodec.hpp"
+#include "storage/FrameContainer.hpp"
+
+namespace {
+std::string NormalizeDirectory(std::string path) {
+  while (path.size() > 1 && path.back() == '/') {
+    path.pop_back();
+  }
+  return path;
+}
+
+bool IsSameDirectory(const std::string &a, const std::string &b) {
+  return NormalizeDirectory(a) == NormalizeDirectory(b);
+}
+}  // namespace
 
 CameraManager::CameraManager() {
   // Create display window
-  if (ConfigHelper::getInstance().camera_config_.render.enable) {
-    display_window_ = std::make_unique<CVWindow>(ConfigHelper::getInstance().camera_config_.render.window_title,
-                                                 ConfigHelper::getInstance().camera_config_.render.window_width,
-                                                 ConfigHelper::getInstance().camera_config_.render.window_height);
+  const auto &render = ConfigHelper::getInstance().camera_config_.render;
+  if (render.enable) {
+    display_window_ = std::make_unique<CVWindow>(render.window_title, render.window_width, render.window_height,
+                                                 render.max_fps);
     LOG_INFO_STREAM << "Real-time display window initialized";
   }
+
+  // Background writers for saved frames; zero writers keeps writes on the saving thread
+  const auto &save = ConfigHelper::getInstance().camera_config_.save;
+  size_t writers = save.async_write ? static_cast<size_t>(std::max(save.writer_threads, 1)) : 0;
+  persistence_ = std::make_unique<PersistenceEngine>(writers, static_cast<size_t>(std::max(save.write_queue_size, 1)),
+                                                     ParseOverflowPolicy(save.overflow_policy));
+  persistence_->Start();
+
+  // Quotas for the save directory, enforced off the capture and writer threads
+  RetentionManager::Config retention;
+  retention.directory = save.save_path;
+  retention.max_frames = static_cast<size_t>(std::max(save.max_save_count, 0));
+  retention.max_bytes = static_cast<uint64_t>(std::max(save.max_save_size_mb, 0)) * 1024 * 1024;
+  retention.min_free_bytes = static_cast<uint64_t>(std::max(save.min_free_space_mb, 0)) * 1024 * 1024;
+  retention_ = std::make_unique<RetentionManager>(retention);
+
+  // Keep the last frames in memory and only write them out around a trigger
+  const auto &recorder = ConfigHelper::getInstance().camera_config_.recorder;
+  if (recorder.enable) {
+    FrameRecorder::Config config;
+    config.max_frames = static_cast<size_t>(std::max(recorder.max_frames, 1));
+    config.max_bytes = static_cast<size_t>(std::max(recorder.max_memory_mb, 0)) * 1024 * 1024;
+    config.post_trigger_frames = static_cast<size_t>(std::max(recorder.post_trigger_frames, 0));
+    config.path = recorder.path;
+    recorder_ = std::make_unique<FrameRecorder>(
+        config, [this](const std::vector<FrameRecorder::FramePtr> &frames, const std::string &directory) {
+          WriteRecordedFrames(frames, directory);
+        });
+    LOG_INFO_STREAM << "Event recorder enabled, keeping up to " << config.max_frames << " frames in memory";
+  }
+
+  // Reduced point cloud for consumers that do not need full density
+  const auto &downsample = ConfigHelper::getInstance().camera_config_.downsample;
+  if (!PointCloudDownsampler::ParseMode(downsample.mode, downsample_.mode)) {
+    LOG_WARNING_STREAM << "Unknown downsample mode '" << downsample.mode << "', point clouds are not downsampled";
+  }
+  downsample_.voxel_size_mm = downsample.voxel_size_mm;
+  downsample_.stride = static_cast<size_t>(std::max(downsample.stride, 1));
+  if (downsample_.mode != PointCloudDownsampler::Mode::None) {
+    LOG_INFO_STREAM << "Point cloud downsampling: " << PointCloudDownsampler::ModeToString(downsample_.mode);
+  }
+
+  // Point cloud products only cover the configured region of the depth map
+  const auto &crop = ConfigHelper::getInstance().camera_config_.crop;
+  crop_.enable = crop.enable;
+  if (crop.roi.size() == 4) {
+    crop_.roi = cv::Rect(crop.roi[0], crop.roi[1], crop.roi[2], crop.roi[3]);
+  } else if (!crop.roi.empty()) {
+    LOG_WARNING_STREAM << "Crop roi must be [x, y, width, height], using the full frame";
+  }
+  crop_.min_depth_mm = crop.min_depth_mm;
+  crop_.max_depth_mm = crop.max_depth_mm;
+  crop_.box.enable = crop.box.enable;
+  if (crop.box.enable && (crop.box.center_mm.size() != 3 || crop.box.size_mm.size() != 3 ||
+                          (!crop.box.rotation_deg.empty() && crop.box.rotation_deg.size() != 3))) {
+    LOG_WARNING_STREAM << "Crop box needs center_mm, size_mm and rotation_deg as [x, y, z], box disabled";
+    crop_.box.enable = false;
+  }
+  if (crop_.box.enable) {
+    std::copy(crop.box.center_mm.begin(), crop.box.center_mm.end(), crop_.box.center_mm.begin());
+    std::copy(crop.box.size_mm.begin(), crop.box.size_mm.end(), crop_.box.size_mm.begin());
+    std::copy(crop.box.rotation_deg.begin(), crop.box.rotation_deg.end(), crop_.box.rotation_deg.begin());
+  }
+  if (crop_.enable) {
+    LOG_INFO_STREAM << "Depth crop: roi " << crop_.roi << ", depth " << crop_.min_depth_mm << "-"
+                    << crop_.max_depth_mm << " mm" << (crop_.box.enable ? ", box" : "");
+  }
+
+  // Smooths depth noise across consecutive frames of each camera, before any product is derived
+  const auto &temporal_filter = ConfigHelper::getInstance().camera_config_.temporal_filter;
+  temporal_filter_.enable = temporal_filter.enable;
+  temporal_filter_.alpha = temporal_filter.alpha;
+  temporal_filter_.reset_threshold_mm = temporal_filter.reset_threshold_mm;
+  temporal_filter_.reset_ratio = temporal_filter.reset_ratio;
+  if (temporal_filter_.enable) {
+    LOG_INFO_STREAM << "Temporal depth filter: alpha " << temporal_filter_.alpha << ", reset above "
+                    << temporal_filter_.reset_threshold_mm << " mm + " << temporal_filter_.reset_ratio << " x depth";
+  }
+
+  // Frames matching the last processed one can skip the stages that declared they only need changes
+  const auto &scene_change = ConfigHelper::getInstance().camera_config_.scene_change;
+  scene_change_.enable = scene_change.enable;
+  scene_change_.cell_size = scene_change.cell_size;
+  scene_change_.block_cells = scene_change.block_cells;
+  scene_change_.depth_threshold_mm = scene_change.depth_threshold_mm;
+  scene_change_.color_threshold = scene_change.color_threshold;
+  scene_change_.min_changed_ratio = scene_change.min_changed_ratio;
+  scene_change_.max_skipped_frames = scene_change.max_skipped_frames;
+  save_only_on_change_ = scene_change.enable && scene_change.save_only_on_change;
+  if (scene_change_.enable) {
+    LOG_INFO_STREAM << "Scene change detection: depth " << scene_change_.depth_threshold_mm << " mm, color "
+                    << scene_change_.color_threshold << (save_only_on_change_ ? ", saving changed frames only" : "");
+  }
+
+  // Recycled frames keep their product buffers; size it to cover every frame in flight
+  frame_pool_ = std::make_unique<FramePool>(FramePoolCapacity(1));
+
+  // Per-stage latency histograms; timers stay null (and cost nothing) when metrics are disabled
+  const auto &metrics = ConfigHelper::getInstance().camera_config_.metrics;
+  if (metrics.enable) {
+    latency_ = std::make_unique<LatencyMonitor>(std::chrono::milliseconds(std::max(metrics.report_interval_ms, 0)));
+    timers_.capture = latency_->Register("capture");
+    timers_.decode = latency_->Register("decode");
+    for (uint32_t i = 0; i < static_cast<uint32_t>(FrameProduct::Count); ++i) {
+      timers_.products[i] = latency_->Register(std::string("decode/") + FrameProductToString(FrameProduct(i)));
+    }
+    timers_.inference = latency_->Register("inference");
+    timers_.inference_queue = latency_->Register("inference/queue");
+    timers_.inference_model = latency_->Register("inference/model");
+    timers_.save = latency_->Register("save");
+    timers_.display = latency_->Register("display");
+    if (display_window_) {
+      display_window_->setLatencyHistogram(timers_.display);
+    }
+    latency_->Start();
+  }
 }
 
 CameraManager::~CameraManager() {
+  // Workers call back into the recorder and record into the latency histograms, so they stop first
+  if (InferenceManager::getInstance().IsAsync()) {
+    InferenceManager::getInstance().StopAsync();
+  }
   if (display_window_) {
     display_window_->close();
+    const CVWindow::Stats stats = display_window_->getStats();
+    LOG_INFO_STREAM << "Display: rendered " << stats.rendered << " of " << stats.submitted << " frames ("
+                    << stats.dropped << " replaced before rendering)";
+  }
+  // Write out a post-trigger window that capture ended early, then flush frames still queued for writing
+  if (recorder_) {
+    recorder_->Flush();
+  }
+  persistence_->Stop();
+  // After the writers, so the last completed frames are registered before quotas are applied
+  retention_->Stop();
+  if (latency_) {
+    latency_->Stop();
   }
 }
 
@@ -43,13 +191,58 @@ bool CameraManager::Init() {
 }
 
 bool CameraManager::Connect() {
-  if (!FindAndConnect(camera_)) return false;
+  const auto &config = ConfigHelper::getInstance().camera_config_;
+  std::vector<std::unique_ptr<FrameSource>> sources = CreateFrameSources(config.source);
+  if (sources.empty()) {
+    return false;
+  }
+  for (auto &source : sources) {
+    if (!source->Open()) {
+      // Every viewpoint is required; release the ones already connected
+      for (auto &opened : sources) {
+        opened->Close();
+      }
+      return false;
+    }
+  }
 
-  mmind::eye::CameraInfo cameraInfo;
-  showError(camera_.getCameraInfo(cameraInfo));
-  printCameraInfo(cameraInfo);
+  channels_.clear();
+  for (auto &source : sources) {
+    LOG_INFO_STREAM << "Frame source: " << source->Name();
+    auto channel = std::make_unique<CaptureChannel>();
+    channel->source = std::move(source);
+    if (latency_ && sources.size() > 1) {
+      channel->capture_timer = latency_->Register("capture/" + channel->source->CameraId());
+    }
+    if (temporal_filter_.enable) {
+      // Filter state is per camera: frames of different cameras must never be averaged together
+      channel->depth_filter = std::make_unique<TemporalDepthFilter>(temporal_filter_);
+    }
+    if (scene_change_.enable) {
+      channel->scene_detector = std::make_unique<SceneChangeDetector>(scene_change_);
+    }
+    channels_.push_back(std::move(channel));
+  }
+
+  if (channels_.size() > 1) {
+    display_camera_id_ = channels_.front()->source->CameraId();
+    // Every camera has its own frames in flight
+    frame_pool_ = std::make_unique<FramePool>(FramePoolCapacity(channels_.size()));
+    LOG_INFO_STREAM << "Capturing from " << channels_.size() << " cameras concurrently, displaying "
+                    << display_camera_id_;
+  }
+
+  // Replaying the save directory while saving into it would evict the recordings being replayed
+  if (config.source.type == "replay" && IsSameDirectory(config.source.replay.path, config.save.save_path)) {
+    LOG_WARNING_STREAM << "Replay path is the save path, disabling saving of replayed frames";
+    save_enabled_ = false;
+  }
+
+  // Picks up frames left by earlier runs, so the quotas hold across restarts and crashes
+  if (save_enabled_ && !recorder_) {
+    retention_->Start();
+  }
 
-  CameraInfo::getInstance().InitCameraInfo(camera_);
   is_running_ = true;
   return true;
 }
@@ -62,11 +255,24 @@ bool CameraManager::Start() {
     LOG_INFO_STREAM << "Real-time display enabled. Press ESC to stop.";
   }
 
+  if (ConfigHelper::getInstance().camera_config_.pipeline.enable) {
+    RunPipelineLoop();
+  } else {
+    RunSerialLoop();
+  }
+
+  return true;
+}
+
+void CameraManager::RunSerialLoop() {
+  const auto start = std::chrono::steady_clock::now();
+  const uint64_t captured_before = captured_frames_;
+
   while (is_running_) {
     std::string suffix = std::to_string(std::chrono::system_clock::now().time_since_epoch().count());
 
     // Capture data
-    Capture(camera_, suffix);
+    Capture(suffix);
 
     // Process window events
     if (display_window_ && !display_window_->processEvents()) {
@@ -75,106 +281,397 @@ bool CameraManager::Start() {
     }
   }
 
+  LogCaptureRate(captured_frames_ - captured_before, start);
+  if (latency_) {
+    latency_->LogTotals();
+  }
+}
+
+void CameraManager::RunPipelineLoop() {
+  if (!pipeline_) {
+    BuildPipeline();
+  }
+  if (!pipeline_->Start()) {
+    LOG_ERROR_STREAM << "Failed to start frame pipeline, falling back to serial capture";
+    RunSerialLoop();
+    return;
+  }
+
+  // Capture threads only grab frames; decoding, inference, saving and display run on the
+  // pipeline workers so that capturing frame N+1 overlaps with processing frame N. Each
+  // camera has its own capture thread and all of them feed the same pipeline.
+  const auto start = std::chrono::steady_clock::now();
+  const uint64_t captured_before = captured_frames_;
+  std::vector<std::thread> capture_threads;
+  for (size_t i = 1; i < channels_.size(); ++i) {
+    capture_threads.emplace_back(&CameraManager::RunCaptureLoop, this, std::ref(*channels_[i]));
+  }
+  if (!channels_.empty()) {
+    RunCaptureLoop(*channels_.front());
+  }
+  for (auto &thread : capture_threads) {
+    thread.join();
+  }
+
+  pipeline_->Stop();
+  LogCaptureRate(captured_frames_ - captured_before, start);
+  if (latency_) {
+    latency_->LogTotals();
+  }
+
+  FramePool::Stats pool = frame_pool_->GetStats();
+  LOG_INFO_STREAM << "Frame pool: high water=" << pool.high_water << "/" << pool.capacity
+                  << ", reused=" << pool.reused << "/" << pool.acquired << ", overflow=" << pool.overflow;
+}
+
+void CameraManager::RunCaptureLoop(CaptureChannel &channel) {
+  while (is_running_ && !channel.finished) {
+    std::string suffix = std::to_string(std::chrono::system_clock::now().time_since_epoch().count());
+    auto frame = CaptureFrame(channel, suffix);
+    if (frame) {
+      pipeline_->Submit(frame);
+    }
+  }
+}
+
+void CameraManager::BuildPipeline() {
+  const auto &config = ConfigHelper::getInstance().camera_config_.pipeline;
+  OverflowPolicy policy = config.drop_when_full ? OverflowPolicy::DropOldest : OverflowPolicy::Block;
+
+  pipeline_ = std::make_unique<FramePipeline>();
+
+  int decode = pipeline_->AddStage("decode", static_cast<size_t>(std::max(config.decode_queue_size, 1)), policy,
+                                   [this](const FramePipeline::FramePtr &frame) {
+                                     DecodeFrame(*frame);
+                                     return true;
+                                   });
+
+  int inference = pipeline_->AddStage(
+      "inference", static_cast<size_t>(std::max(config.inference_queue_size, 1)), policy,
+      [this](const FramePipeline::FramePtr &frame) {
+        ProcessInference(frame);
+        return true;
+      },
+      decode);
+
+  pipeline_->AddStage(
+      "save", static_cast<size_t>(std::max(config.save_queue_size, 1)), policy,
+      [this](const FramePipeline::FramePtr &frame) {
+        SaveImages(frame, frame->suffix);
+        return false;
+      },
+      inference);
+
+  if (display_window_) {
+    // Only hands frames to the window's render thread, which keeps just the latest one, so display can
+    // never back-pressure capture
+    pipeline_->AddStage(
+        "display", static_cast<size_t>(std::max(config.display_queue_size, 1)), OverflowPolicy::DropOldest,
+        [this](const FramePipeline::FramePtr &frame) {
+          ShowImages(frame);
+          if (!display_window_->processEvents()) {
+            LOG_INFO_STREAM << "Window closed by user, stopping capture...";
+            is_running_ = false;
+          }
+          return false;
+        },
+        inference);
+  }
+}
+
+std::vector<FramePipeline::StageStats> CameraManager::GetPipelineStats() const {
+  if (!pipeline_) {
+    return {};
+  }
+  return pipeline_->GetStats();
+}
+
+PersistenceEngine::Stats CameraManager::GetPersistenceStats() const { return persistence_->GetStats(); }
+
+FramePool::Stats CameraManager::GetFramePoolStats() const { return frame_pool_->GetStats(); }
+
+RetentionManager::Stats CameraManager::GetRetentionStats() const { return retention_->GetStats(); }
+
+FrameRecorder::Stats CameraManager::GetRecorderStats() const {
+  if (!recorder_) {
+    return {};
+  }
+  return recorder_->GetStats();
+}
+
+bool CameraManager::TriggerRecording(const std::string &reason) {
+  if (!recorder_) {
+    LOG_WARNING_STREAM << "Recording triggered (" << reason << ") but the event recorder is disabled";
+    return false;
+  }
+  recorder_->Trigger(reason);
   return true;
 }
 
+size_t CameraManager::FramePoolCapacity(size_t cameras) const {
+  const auto &config = ConfigHelper::getInstance().camera_config_;
+  size_t capacity = static_cast<size_t>(std::max(config.pipeline.frame_pool_size, 1)) * std::max<size_t>(cameras, 1);
+  if (config.recorder.enable) {
+    // Buffered frames pin their slots; without the headroom every capture would overflow the pool
+    capacity += static_cast<size_t>(std::max(config.recorder.max_frames, 1)) +
+                static_cast<size_t>(std::max(config.recorder.post_trigger_frames, 0));
+  }
+  if (display_window_) {
+    capacity += CVWindow::kHeldFrames;
+  }
+  const auto &async = ConfigHelper::getInstance().inference_config_.async;
+  if (async.enable) {
+    // One frame per worker plus the one waiting in the latest-frame slot
+    capacity += static_cast<size_t>(std::max(async.workers, 1)) + 1;
+  }
+  return capacity;
+}
+
+std::vector<LatencyMonitor::StageReport> CameraManager::GetLatencyReport() const {
+  if (!latency_) {
+    return {};
+  }
+  return latency_->GetReport();
+}
+
 bool CameraManager::Stop() {
   is_running_ = false;
-  camera_.disconnect();
+  for (auto &channel : channels_) {
+    std::lock_guard<std::mutex> lock(channel->mutex);
+    channel->source->Close();
+  }
   return true;
 }
 
-void CameraManager::Capture(mmind::eye::Camera &camera, const std::string &suffix) {
+void CameraManager::Capture(const std::string &suffix) {
   if (!is_running_) return;
 
-  mmind::eye::Frame2DAnd3D frame2DAnd3D;
-  showError(camera.capture2DAnd3D(frame2DAnd3D));
+  for (auto &frameSet : CaptureFrames(suffix)) {
+    DecodeFrame(*frameSet);
 
-  FrameSet frameSet(frame2DAnd3D, suffix);
-  frameSet.DecodeFrame();
+    // Process inference
+    ProcessInference(frameSet);
 
-  // Process inference
-  ProcessInference(frameSet);
+    // Save files
+    SaveImages(frameSet, frameSet->suffix);
+    // Display images
+    ShowImages(frameSet);
+  }
+}
+
+std::vector<FrameSnapshot> CameraManager::CaptureFrames(const std::string &suffix) {
+  std::vector<FrameSnapshot> frames;
+  if (channels_.empty()) return frames;
+
+  // Trigger all cameras together, as in the SDK's MultipleCamerasCaptureSimultaneously sample
+  std::vector<std::future<FrameSnapshot>> pending;
+  for (size_t i = 1; i < channels_.size(); ++i) {
+    pending.push_back(
+        std::async(std::launch::async, [this, i, &suffix] { return CaptureFrame(*channels_[i], suffix); }));
+  }
+  frames.push_back(CaptureFrame(*channels_.front(), suffix));
+  for (auto &future : pending) {
+    frames.push_back(future.get());
+  }
 
-  // Save files
-  SaveImages(frameSet, suffix);
-  // Display images
-  ShowImages(frameSet);
+  frames.erase(std::remove(frames.begin(), frames.end(), nullptr), frames.end());
+  return frames;
 }
 
-void CameraManager::SaveImages(FrameSet &frame, const std::string &suffix) {
-  // Ensure save directory exists
-  std::string save_dir = ConfigHelper::getInstance().camera_config_.save.save_path;
-  struct stat st = {0};
-  if (stat(save_dir.c_str(), &st) == -1) {
-    if (mkdir(save_dir.c_str(), 0755) == 0) {
-      LOG_INFO_STREAM << "Created directory: " << save_dir;
-    } else {
-      LOG_ERROR_STREAM << "Failed to create directory: " << save_dir;
-      return;
+FrameSnapshot CameraManager::CaptureFrame(CaptureChannel &channel, const std::string &suffix) {
+  std::lock_guard<std::mutex> lock(channel.mutex);
+  if (channel.finished) return nullptr;
+
+  const std::string camera_id = channel.source->CameraId();
+  const std::string frame_suffix = channels_.size() > 1 && !camera_id.empty() ? suffix + "_" + camera_id : suffix;
+
+  auto frame = frame_pool_->Acquire();
+  ScopedLatency timer(timers_.capture);
+  ScopedLatency channel_timer(channel.capture_timer);
+  if (!channel.source->Grab(*frame, frame_suffix)) {
+    if (channel.source->IsFinished()) {
+      LOG_INFO_STREAM << "Frame source " << channel.source->Name() << " finished";
+      channel.finished = true;
+      if (std::all_of(channels_.begin(), channels_.end(), [](const auto &c) { return c->finished.load(); })) {
+        LOG_INFO_STREAM << "All frame sources finished, stopping capture...";
+        is_running_ = false;
+      }
     }
-  } else {
-    LOG_DEBUG_STREAM << "Directory already exists: " << save_dir;
+    return nullptr;
   }
 
-  std::vector<std::string> file_names;
+  if (channel.depth_filter) {
+    // Frames of one camera are grabbed in order under the channel lock, as the filter state requires
+    frame->ApplyTemporalFilter(*channel.depth_filter);
+  }
+  if (channel.scene_detector) {
+    // Compared after filtering, so depth noise alone does not count as a change
+    frame->scene_changed = channel.scene_detector->Update(frame->GetColor(), frame->GetDepthImage()).changed;
+  }
+  frame->downsample = downsample_;
+  frame->crop = crop_;
+  channel.captured++;
+  captured_frames_++;
+  return frame;
+}
 
-  // 2D image
-  if (ConfigHelper::getInstance().camera_config_.save.save_2d_image && frame.hasColor) {
-    std::string image_file = ConfigHelper::getInstance().camera_config_.save.save_2d_image_file(suffix);
-    if (cv::imwrite(image_file, frame.color)) {
-      LOG_INFO_STREAM << "Capture and save the 2D image: " << image_file;
-      file_names.push_back(image_file);
-    } else {
-      LOG_ERROR_STREAM << "Failed to save 2D image: " << image_file;
+void CameraManager::LogCaptureRate(uint64_t frames, std::chrono::steady_clock::time_point start) const {
+  const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  LOG_INFO_STREAM << "Captured " << frames << " frames in " << seconds << " s ("
+                  << (seconds > 0 ? frames / seconds : 0.0) << " FPS)";
+  if (channels_.size() > 1) {
+    for (const auto &channel : channels_) {
+      LOG_INFO_STREAM << "  " << channel->source->Name() << ": " << channel->captured << " frames";
     }
   }
-
-  // Depth map
-  if (ConfigHelper::getInstance().camera_config_.save.save_depth_map && frame.hasDepth) {
-    std::string depth_file = ConfigHelper::getInstance().camera_config_.save.save_depth_map_file(suffix);
-    if (cv::imwrite(depth_file, frame.depthImage)) {
-      LOG_INFO_STREAM << "Capture and save the depth map: " << depth_file;
-      file_names.push_back(depth_file);
-    } else {
-      LOG_ERROR_STREAM << "Failed to save depth map: " << depth_file;
+  if (scene_change_.enable) {
+    uint64_t changed = 0;
+    uint64_t detected = 0;
+    for (const auto &channel : channels_) {
+      if (channel->scene_detector) {
+        changed += channel->scene_detector->GetStats().changed;
+        detected += channel->scene_detector->GetStats().frames;
+      }
     }
+    LOG_INFO_STREAM << "Scene changed in " << changed << " of " << detected << " frames, skipped inference on "
+                    << skipped_inference_ << " and saving of " << skipped_saves_ << " frames";
   }
+}
 
-  // Point cloud
-  if (ConfigHelper::getInstance().camera_config_.save.save_point_cloud) {
-    std::string pointCloudFile = ConfigHelper::getInstance().camera_config_.save.save_point_cloud_file(suffix);
-    showError(frame.frame2DAnd3D.frame3D().saveUntexturedPointCloud(mmind::eye::FileFormat::PLY, pointCloudFile),
-              "Capture and save the untextured point cloud: " + pointCloudFile);
-    file_names.push_back(pointCloudFile);
+void CameraManager::SaveImages(const FrameSnapshot &frame, const std::string &suffix) {
+  ScopedLatency timer(timers_.save);
+
+  // With the recorder on, frames stay in memory until something triggers a dump. Events go to
+  // their own directory, so this also applies when replaying from the save path.
+  if (recorder_) {
+    recorder_->Record(frame);
+    return;
   }
-  if (ConfigHelper::getInstance().camera_config_.save.save_textured_point_cloud) {
-    std::string texturedPointCloudFile =
-        ConfigHelper::getInstance().camera_config_.save.save_textured_point_cloud_file(suffix);
-    showError(frame.frame2DAnd3D.saveTexturedPointCloud(mmind::eye::FileFormat::PLY, texturedPointCloudFile),
-              "Capture and save the textured point cloud: " + texturedPointCloudFile);
-    file_names.push_back(texturedPointCloudFile);
+  if (!save_enabled_) return;
+
+  if (save_only_on_change_ && !frame->scene_changed) {
+    skipped_saves_++;
+    return;
   }
 
-  file_queue_.push_back(file_names);
-  CheckFilesLimit();
+  // Retention could not free enough space; skip rather than fill the disk
+  if (!retention_->HasHeadroom()) {
+    return;
+  }
+
+  const auto &save = ConfigHelper::getInstance().camera_config_.save;
+
+  // The directory is checked once instead of on every frame
+  if (!save_dir_ready_) {
+    save_dir_ready_ = PersistenceEngine::EnsureDirectory(save.save_path);
+    if (!save_dir_ready_) {
+      LOG_ERROR_STREAM << "Failed to create directory: " << save.save_path;
+      return;
+    }
+  }
+
+  PersistenceEngine::Job job;
+  job.tag = suffix;
+  AppendSaveFiles(job, frame, suffix, save);
+  if (job.files.empty()) {
+    return;
+  }
+
+  job.on_complete = [this](const std::vector<std::string> &file_names) { retention_->Add(file_names); };
+  persistence_->Submit(std::move(job));
 }
 
-void CameraManager::ShowImages(FrameSet &frame) {
-  // Display images
-  if (display_window_ && ConfigHelper::getInstance().camera_config_.render.enable && frame.hasColor && frame.hasDepth) {
-    display_window_->showFrame2DAnd3D(frame.frame2DAnd3D);
+void CameraManager::WriteRecordedFrames(const std::vector<FrameRecorder::FramePtr> &frames,
+                                        const std::string &directory) {
+  if (!PersistenceEngine::EnsureDirectory(directory)) {
+    LOG_ERROR_STREAM << "Failed to create event directory: " << directory;
+    return;
+  }
+
+  // Same file layout as regular saving, only rooted in the event directory
+  auto save = ConfigHelper::getInstance().camera_config_.save;
+  save.save_path = directory + "/";
+
+  // One job per window keeps a burst of frames from flooding the write queue
+  PersistenceEngine::Job job;
+  job.tag = directory;
+  for (const auto &frame : frames) {
+    AppendSaveFiles(job, frame, frame->suffix, save);
+  }
+  if (job.files.empty()) {
+    return;
+  }
+
+  const size_t count = frames.size();
+  job.on_complete = [directory, count](const std::vector<std::string> &file_names) {
+    LOG_INFO_STREAM << "Wrote " << count << " recorded frames (" << file_names.size() << " files) to " << directory;
+  };
+  if (!persistence_->Submit(std::move(job))) {
+    LOG_ERROR_STREAM << "Write queue rejected " << count << " recorded frames for " << directory;
   }
 }
 
-void CameraManager::CheckFilesLimit() {
-  if (file_queue_.size() > ConfigHelper::getInstance().camera_config_.save.max_save_count) {
-    std::vector<std::string> files_name = file_queue_.front();
-    for (const auto &file_name : files_name) {
-      std::remove(file_name.c_str());
+void CameraManager::AppendSaveFiles(PersistenceEngine::Job &job, const FrameSnapshot &frame,
+                                    const std::string &suffix, const ConfigHelper::CameraConfig::SaveConfig &save) {
+  // Writers capture the frame by shared_ptr, so its buffers stay alive until written
+  // Whole frame in a single memory-mappable container instead of separate images and PLY exports
+  if (save.point_cloud_format == "container") {
+    FrameContainer::WriteOptions options;
+    options.color = save.save_2d_image;
+    options.depth = save.save_depth_map;
+    options.points = save.save_point_cloud;
+    options.point_colors = save.save_textured_point_cloud;
+    job.files.push_back({save.save_container_file(suffix), [frame, options](const std::string &path) {
+                           return FrameContainer::WriteFrame(path, *frame, options);
+                         }});
+  } else {
+    // 2D image
+    if (save.save_2d_image && frame->IsAvailable(FrameProduct::Color)) {
+      job.files.push_back({save.save_2d_image_file(suffix),
+                           [frame](const std::string &path) { return cv::imwrite(path, frame->GetColor()); }});
+    }
+
+    // Depth map
+    if (save.save_depth_map && frame->IsAvailable(FrameProduct::Depth) && save.depth_format == "mdc") {
+      DepthCodec::Options options;
+      options.precision_mm = save.depth_precision_mm;
+      job.files.push_back({save.save_compressed_depth_file(suffix), [frame, options](const std::string &path) {
+                             return DepthCodec::WriteFile(path, frame->GetDepthImage(), options);
+                           }});
+    } else if (save.save_depth_map && frame->IsAvailable(FrameProduct::Depth)) {
+      job.files.push_back({save.save_depth_map_file(suffix),
+                           [frame](const std::string &path) { return cv::imwrite(path, frame->GetDepthImage()); }});
+    }
+
+    // Point cloud (exported by the SDK, so only for frames captured from a camera)
+    if (save.save_point_cloud && frame->HasCameraFrame()) {
+      job.files.push_back({save.save_point_cloud_file(suffix), [frame](const std::string &path) {
+                             mmind::eye::ErrorStatus status = frame->frame2DAnd3D.frame3D().saveUntexturedPointCloud(
+                                 mmind::eye::FileFormat::PLY, path);
+                             showError(status, "Capture and save the untextured point cloud: " + path);
+                             return status.isOK();
+                           }});
+    }
+    if (save.save_textured_point_cloud && frame->HasCameraFrame()) {
+      job.files.push_back({save.save_textured_point_cloud_file(suffix), [frame](const std::string &path) {
+                             mmind::eye::ErrorStatus status =
+                                 frame->frame2DAnd3D.saveTexturedPointCloud(mmind::eye::FileFormat::PLY, path);
+                             showError(status, "Capture and save the textured point cloud: " + path);
+                             return status.isOK();
+                           }});
     }
-    file_queue_.pop_front();
-    LOG_DEBUG_STREAM << "Removed old files, current queue size: " << file_queue_.size();
+  }
+}
+
+void CameraManager::ShowImages(const FrameSnapshot &frame) {
+  // With several cameras the window follows a single viewpoint instead of flickering between them
+  if (!display_camera_id_.empty() && frame->camera_id != display_camera_id_) {
+    return;
+  }
+
+  // Rendering (including colorizing the depth) happens on the window's own thread and is timed there
+  if (display_window_ && frame->IsAvailable(FrameProduct::Color) && frame->IsAvailable(FrameProduct::Depth)) {
+    display_window_->submitFrame(frame);
   }
 }
 
@@ -197,6 +694,13 @@ bool CameraManager::EnableInference(const std::string &config_path) {
   LOG_INFO_STREAM << "Enabling inference, config file: " << actual_config_path;
 
   if (InferenceManager::getInstance().InitializeInference(actual_config_path)) {
+    const auto &async = ConfigHelper::getInstance().inference_config_.async;
+    if (async.enable) {
+      InferenceManager::getInstance().SetLatencyHistograms(timers_.inference_queue, timers_.inference_model);
+      if (!InferenceManager::getInstance().StartAsync(static_cast<size_t>(std::max(async.workers, 1)))) {
+        LOG_WARNING_STREAM << "Asynchronous inference unavailable, processing frames inline";
+      }
+    }
     inference_enabled_ = true;
     LOG_INFO_STREAM << "Inference enabled successfully, algorithm: "
                     << InferenceManager::getInstance().GetCurrentAlgorithmName();
@@ -224,12 +728,78 @@ std::string CameraManager::GetInferenceResult() const {
   return InferenceManager::getInstance().GetResult();
 }
 
-void CameraManager::ProcessInference(FrameSet &frame_set) {
+std::shared_ptr<const InferenceResult> CameraManager::GetLatestInferenceResult() const {
+  if (!inference_enabled_) {
+    return nullptr;
+  }
+  return InferenceManager::getInstance().GetLatestResult();
+}
+
+void CameraManager::DecodeFrame(const FrameSet &frame) {
+  // Prefetched products only serve inference, so nothing is decoded for a frame inference skips
+  if (SkipsInference(frame)) return;
+
+  ScopedLatency timer(timers_.decode);
+  const FrameProductMask products = RequiredProducts();
+  if (!latency_) {
+    frame.DecodeFrame(products);
+    return;
+  }
+
+  // Decoding one product at a time attributes each sub-step to its own histogram. Transformed clouds are
+  // produced in one shared pass, which is attributed to the first of them.
+  for (uint32_t i = 0; i < static_cast<uint32_t>(FrameProduct::Count); ++i) {
+    const FrameProductMask bit = ToProductMask(FrameProduct(i));
+    if (products & bit) {
+      ScopedLatency product_timer(timers_.products[i]);
+      frame.DecodeFrame((bit & kTransformedCloudProducts) ? (products & kTransformedCloudProducts) : bit);
+    }
+  }
+}
+
+FrameProductMask CameraManager::RequiredProducts() const {
+  // Only products with a known consumer are prefetched; everything else stays lazy
+  FrameProductMask products = kNoFrameProducts;
+  if (inference_enabled_) {
+    products |= InferenceManager::getInstance().GetRequiredProducts();
+  }
+  return products;
+}
+
+void CameraManager::ProcessInference(const FrameSnapshot &frame) {
   if (!inference_enabled_) {
     return;
   }
 
-  if (!InferenceManager::getInstance().Process(frame_set)) {
-    LOG_WARNING_STREAM << "Failed to process frame with inference";
+  if (SkipsInference(*frame)) {
+    skipped_inference_++;
+    return;
   }
+
+  if (InferenceManager::getInstance().IsAsync()) {
+    // Capture moves on at once; a frame still waiting when the next one arrives is dropped in its favour
+    InferenceManager::getInstance().SubmitAsync(frame, [this](const InferenceOutcome &outcome) {
+      if (outcome.status == InferenceOutcome::Status::Failed) {
+        OnInferenceFailure();
+      }
+    });
+    return;
+  }
+
+  ScopedLatency timer(timers_.inference);
+  if (!InferenceManager::getInstance().Process(frame)) {
+    // The failing frame reaches the recorder after this, as the first post-trigger frame
+    OnInferenceFailure();
+  }
+}
+
+void CameraManager::OnInferenceFailure() {
+  LOG_WARNING_STREAM << "Failed to process frame with inference";
+  if (recorder_ && ConfigHelper::getInstance().camera_config_.recorder.trigger_on_inference_failure) {
+    recorder_->Trigger("inference_failure");
+  }
+}
+
+bool CameraManager::SkipsInference(const FrameSet &frame_set) const {
+  return !frame_set.scene_changed && inference_enabled_ && InferenceManager::getInstance().RunOnlyOnSceneChange();
 }
@@ -1,11 +1,23 @@
 #include <string>
+#include <array>
 #include <atomic>
-#include <deque>
+#include <chrono>
 #include <memory>
+#include <mutex>
 #include "area_scan_3d_camera/Camera.h"
 #include "FrameSet.hpp"
+#include "FramePipeline.hpp"
+#include "FramePool.hpp"
+#include "FrameRecorder.hpp"
+#include "LatencyMonitor.hpp"
+#include "PersistenceEngine.hpp"
+#include "RetentionManager.hpp"
+#include "processing/SceneChangeDetector.hpp"
+#include "processing/TemporalDepthFilter.hpp"
+#include "source/FrameSource.hpp"
 #include "utils/CVWindow.hpp"
 #include "InferenceInterface.hpp"
+#include "configure/ConfigHelper.hpp"
 
 class CameraManager
 {
@@ -19,7 +31,10 @@ public:
 
     bool Connect();
 
-    void Capture(mmind::eye::Camera& camera, const std::string& suffix);
+    /**
+     * @brief 串行处理一个采集周期：所有相机同时采集，然后逐帧解码、推理、保存、显示
+     */
+    void Capture(const std::string& suffix);
 
     /**
      * @brief 启用推理处理
@@ -39,23 +54,194 @@ public:
      */
     std::string GetInferenceResult() const;
 
+    /**
+     * @brief 获取最新的结构化推理结果，只读共享，无需拷贝
+     * @return 未启用推理或算法不提供结构化结果时为空
+     */
+    std::shared_ptr<const InferenceResult> GetLatestInferenceResult() const;
+
+    /**
+     * @brief 获取流水线各阶段的队列深度和丢帧统计
+     * @return 阶段统计列表，未启用流水线时为空
+     */
+    std::vector<FramePipeline::StageStats> GetPipelineStats() const;
+
+    /**
+     * @brief 获取落盘引擎的队列、延迟和吞吐统计
+     */
+    PersistenceEngine::Stats GetPersistenceStats() const;
+
+    /**
+     * @brief 获取帧缓冲池的使用情况和高水位
+     */
+    FramePool::Stats GetFramePoolStats() const;
+
+    /**
+     * @brief 获取各阶段（采集、解码及各数据产品、推理、保存、显示）的延迟分布和帧率
+     * @return 阶段延迟报告，未启用延迟统计时为空
+     */
+    std::vector<LatencyMonitor::StageReport> GetLatencyReport() const;
+
+    /**
+     * @brief 触发事件记录，将内存中的触发前帧和随后的触发后帧写入事件目录
+     * @param reason 触发原因，用于事件目录名
+     * @return 未启用记录器时返回 false
+     */
+    bool TriggerRecording(const std::string& reason);
+
+    /**
+     * @brief 获取事件记录器的缓冲和触发统计，未启用记录器时为默认值
+     */
+    FrameRecorder::Stats GetRecorderStats() const;
+
+    /**
+     * @brief 获取保存目录的配额、删除和磁盘剩余空间统计
+     */
+    RetentionManager::Stats GetRetentionStats() const;
+
 private:
-    void CheckFilesLimit();
+    /**
+     * @brief 一个帧数据源（一台相机）及其采集状态
+     */
+    struct CaptureChannel
+    {
+        std::unique_ptr<FrameSource> source;
+        std::mutex mutex;  // 采集与关闭数据源互斥
+        LatencyHistogram* capture_timer = nullptr;  // 本相机的采集延迟，仅多相机时统计
+        std::unique_ptr<TemporalDepthFilter> depth_filter;  // 本相机深度流的时域滤波状态，未启用时为空
+        std::unique_ptr<SceneChangeDetector> scene_detector;  // 本相机的场景变化检测，未启用时为空
+        std::atomic<uint64_t> captured {0};
+        std::atomic<bool> finished {false};
+    };
 
-    void SaveImages(FrameSet& frame, const std::string& suffix);
+    /**
+     * @brief 各阶段延迟直方图，未启用延迟统计时均为空指针
+     */
+    struct StageTimers
+    {
+        LatencyHistogram* capture = nullptr;
+        LatencyHistogram* decode = nullptr;
+        std::array<LatencyHistogram*, static_cast<size_t>(FrameProduct::Count)> products {};
+        LatencyHistogram* inference = nullptr;
+        LatencyHistogram* inference_queue = nullptr;  // 异步推理：提交到开始处理的等待时间
+        LatencyHistogram* inference_model = nullptr;  // 异步推理：算法处理耗时
+        LatencyHistogram* save = nullptr;
+        LatencyHistogram* display = nullptr;
+    };
 
-    void ShowImages(FrameSet& frame);
+    /**
+     * @brief 从一个数据源获取一帧，装载到帧缓冲池提供的FrameSet中
+     *
+     * 多相机时帧标识为 <suffix>_<序列号>，保证各相机保存的文件不重名。
+     * 滤波、场景检测和各产品参数都在发布前设置完成，返回后帧不再被修改。
+     * @return 帧数据，采集失败或数据源结束返回nullptr（所有数据源都结束时停止采集循环）
+     */
+    FrameSnapshot CaptureFrame(CaptureChannel& channel, const std::string& suffix);
+
+    /**
+     * @brief 所有相机同时采集一帧，耗时取决于最慢的相机而不是各相机之和
+     * @return 采集成功的帧，按数据源顺序排列
+     */
+    std::vector<FrameSnapshot> CaptureFrames(const std::string& suffix);
+
+    /**
+     * @brief 流水线模式下单个数据源的采集循环
+     */
+    void RunCaptureLoop(CaptureChannel& channel);
+
+    /**
+     * @brief 输出采集循环的帧数和平均帧率
+     */
+    void LogCaptureRate(uint64_t frames, std::chrono::steady_clock::time_point start) const;
+
+    /**
+     * @brief 构建 解码 -> 推理 -> {保存, 显示} 流水线
+     */
+    void BuildPipeline();
+
+    /**
+     * @brief 流水线模式下的采集循环，采集线程只负责采集并提交帧
+     */
+    void RunPipelineLoop();
+
+    /**
+     * @brief 串行模式下的采集循环
+     */
+    void RunSerialLoop();
+
+    /**
+     * @brief 预取下游消费者需要的数据产品，逐个产品计时
+     */
+    void DecodeFrame(const FrameSet& frame);
+
+    /**
+     * @brief 汇总下游消费者需要预取的帧数据产品
+     */
+    FrameProductMask RequiredProducts() const;
+
+    /**
+     * @brief 将一帧的待保存文件打包提交给落盘引擎，不在调用线程中写盘
+     */
+    void SaveImages(const FrameSnapshot& frame, const std::string& suffix);
+
+    /**
+     * @brief 按保存配置把一帧的待保存文件追加到落盘任务中，文件写入 save.save_path
+     */
+    static void AppendSaveFiles(PersistenceEngine::Job& job, const FrameSnapshot& frame,
+                                const std::string& suffix, const ConfigHelper::CameraConfig::SaveConfig& save);
+
+    /**
+     * @brief 将记录器的一个窗口作为单个落盘任务写入事件目录，不参与 max_save_count 淘汰
+     */
+    void WriteRecordedFrames(const std::vector<FrameRecorder::FramePtr>& frames, const std::string& directory);
+
+    /**
+     * @brief 帧缓冲池容量：每台相机的在途帧，加上记录器缓冲中的帧
+     */
+    size_t FramePoolCapacity(size_t cameras) const;
+
+    /**
+     * @brief 将帧交给显示窗口的 UI 线程，立即返回
+     */
+    void ShowImages(const FrameSnapshot& frame);
 
     /**
      * @brief 处理推理
-     * @param frame_set 帧数据
+     * @param frame 帧快照，算法可以保留它异步处理
+     */
+    void ProcessInference(const FrameSnapshot& frame);
+
+    /**
+     * @brief 推理失败时记录日志并按配置触发事件录制，异步推理时在工作线程调用
+     */
+    void OnInferenceFailure();
+
+    /**
+     * @brief 推理算法声明只处理场景变化的帧，且该帧场景未变化
      */
-    void ProcessInference(FrameSet& frame_set);
+    bool SkipsInference(const FrameSet& frame_set) const;
 
 private:
-    mmind::eye::Camera camera_;
+    std::vector<std::unique_ptr<CaptureChannel>> channels_;
+    std::string display_camera_id_;  // 多相机时只显示第一台相机的帧
+    std::atomic<uint64_t> captured_frames_ {0};
+    bool save_enabled_ = true;
     std::atomic<bool> is_running_ {false};
-    std::deque<std::vector<std::string>> file_queue_;
+    bool save_dir_ready_ = false;
+    std::unique_ptr<PersistenceEngine> persistence_;
+    std::unique_ptr<RetentionManager> retention_;  // 保存目录的配额，Connect 时扫描已有文件后启动
+    std::unique_ptr<FramePool> frame_pool_;
+    PointCloudDownsampler::Options downsample_;  // 每帧 DownsampledPointCloud 的参数
+    DepthCropper::Options crop_;  // 每帧点云类产品的深度裁剪参数
+    TemporalDepthFilter::Options temporal_filter_;  // 各相机深度时域滤波的参数
+    SceneChangeDetector::Options scene_change_;  // 各相机场景变化检测的参数
+    bool save_only_on_change_ = false;  // 场景未变化的帧不保存
+    std::atomic<uint64_t> skipped_inference_ {0};  // 场景未变化而跳过推理的帧数
+    std::atomic<uint64_t> skipped_saves_ {0};  // 场景未变化而跳过保存的帧数
+    std::unique_ptr<FrameRecorder> recorder_;  // 启用时替代逐帧保存
     std::unique_ptr<CVWindow> display_window_;
-    bool inference_enabled_ = false;
+    std::atomic<bool> inference_enabled_ {false};
+    std::unique_ptr<FramePipeline> pipeline_;
+    std::unique_ptr<LatencyMonitor> latency_;
+    StageTimers timers_;
 };
\ No newline at end of file
@@ -0,0 +1,125 @@
+#include "FramePipeline.hpp"
+#include "Logger.hpp"
+
+FramePipeline::~FramePipeline() { Stop(); }
+
+int FramePipeline::AddStage(const std::string &name, size_t capacity, OverflowPolicy policy, StageHandler handler,
+                            int upstream) {
+  if (running_) {
+    LOG_ERROR_STREAM << "Cannot add stage '" << name << "' while pipeline is running";
+    return -1;
+  }
+  if (upstream >= static_cast<int>(stages_.size())) {
+    LOG_ERROR_STREAM << "Cannot add stage '" << name << "': invalid upstream index " << upstream;
+    return -1;
+  }
+
+  auto stage = std::make_unique<Stage>();
+  stage->name = name;
+  stage->queue = std::make_unique<BoundedQueue<FramePtr>>(capacity, policy);
+  stage->handler = std::move(handler);
+
+  size_t index = stages_.size();
+  if (upstream < 0) {
+    roots_.push_back(index);
+  } else {
+    stages_[upstream]->downstream.push_back(index);
+  }
+  stages_.push_back(std::move(stage));
+  return static_cast<int>(index);
+}
+
+bool FramePipeline::Start() {
+  if (running_) {
+    return true;
+  }
+  if (stages_.empty()) {
+    LOG_WARNING_STREAM << "Frame pipeline has no stages";
+    return false;
+  }
+
+  // Stop() closed every queue; reopen them so a restarted pipeline accepts frames again
+  running_ = true;
+  for (auto &stage : stages_) {
+    stage->queue->Reopen();
+    stage->worker = std::thread(&FramePipeline::WorkerLoop, this, std::ref(*stage));
+  }
+  LOG_INFO_STREAM << "Frame pipeline started with " << stages_.size() << " stages";
+  return true;
+}
+
+void FramePipeline::Stop() {
+  if (!running_) {
+    return;
+  }
+  running_ = false;
+
+  // Stages are stored in topological order, so closing and joining in index order lets
+  // every stage drain into its downstream queues before those are closed.
+  for (auto &stage : stages_) {
+    stage->queue->Close();
+    if (stage->worker.joinable()) {
+      stage->worker.join();
+    }
+  }
+
+  for (const auto &stats : GetStats()) {
+    LOG_INFO_STREAM << "Pipeline stage '" << stats.name << "': processed=" << stats.processed
+                    << ", dropped=" << stats.dropped << ", queue high water=" << stats.queue_high_water << "/"
+                    << stats.queue_capacity;
+  }
+}
+
+bool FramePipeline::Submit(const FramePtr &frame) {
+  if (!running_ || !frame) {
+    return false;
+  }
+
+  submitted_++;
+  bool accepted = false;
+  for (size_t index : roots_) {
+    accepted |= stages_[index]->queue->Push(frame);
+  }
+  return accepted;
+}
+
+std::vector<FramePipeline::StageStats> FramePipeline::GetStats() const {
+  std::vector<StageStats> stats;
+  stats.reserve(stages_.size());
+  for (const auto &stage : stages_) {
+    StageStats s;
+    s.name = stage->name;
+    s.queue_depth = stage->queue->Size();
+    s.queue_capacity = stage->queue->Capacity();
+    s.queue_high_water = stage->queue->HighWaterMark();
+    s.processed = stage->processed;
+    s.dropped = stage->queue->Dropped();
+    stats.push_back(s);
+  }
+  return stats;
+}
+
+void FramePipeline::WorkerLoop(Stage &stage) {
+  FramePtr frame;
+  while (stage.queue->Pop(frame)) {
+    bool forward = false;
+    try {
+      forward = stage.handler(frame);
+    } catch (const std::exception &e) {
+      LOG_ERROR_STREAM << "Pipeline stage '" << stage.name << "' failed: " << e.what();
+    }
+    stage.processed++;
+
+    if (forward) {
+      Dispatch(stage.downstream, frame);
+    }
+    frame.reset();
+  }
+  LOG_DEBUG_STREAM << "Pipeline stage '" << stage.name << "' exited";
+}
+
+void FramePipeline::Dispatch(const std::vector<size_t> &targets, const FramePtr &frame) {
+  for (size_t index : targets) {
+    stages_[index]->queue->Push(frame);
+  }
+}
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "FrameSet.hpp"
+#include "utils/BoundedQueue.hpp"
+
+/**
+ * @brief 帧处理流水线
+ *
+ * 每个阶段拥有一个有界输入队列和一个独立的工作线程，阶段之间按树形连接：
+ * 上游阶段处理完一帧后将其分发给所有下游阶段。帧以不可修改的快照（FrameSnapshot）在阶段间
+ * 传递，不会发生深拷贝，阶段处理函数也可以保留快照供异步使用。采集线程通过 Submit 将帧送入根阶段，从而使第 N+1 帧的采集
+ * 与第 N 帧的处理重叠执行。
+ */
+class FramePipeline
+{
+public:
+    using FramePtr = FrameSnapshot;
+
+    /**
+     * @brief 阶段处理函数
+     * @return true 继续分发给下游阶段，false 本帧在此阶段终止
+     */
+    using StageHandler = std::function<bool(const FramePtr&)>;
+
+    /**
+     * @brief 阶段运行统计
+     */
+    struct StageStats
+    {
+        std::string name;
+        size_t queue_depth = 0;       // 当前队列深度
+        size_t queue_capacity = 0;    // 队列容量
+        size_t queue_high_water = 0;  // 队列历史最大深度
+        uint64_t processed = 0;       // 已处理帧数
+        uint64_t dropped = 0;         // 队列溢出丢弃帧数
+    };
+
+    FramePipeline() = default;
+    ~FramePipeline();
+
+    FramePipeline(const FramePipeline&) = delete;
+    FramePipeline& operator=(const FramePipeline&) = delete;
+
+    /**
+     * @brief 添加处理阶段（需在 Start 之前调用）
+     * @param name 阶段名称
+     * @param capacity 输入队列容量
+     * @param policy 队列满时的处理策略
+     * @param handler 阶段处理函数
+     * @param upstream 上游阶段索引，-1 表示根阶段（直接接收 Submit 的帧）
+     * @return 阶段索引，失败返回 -1
+     */
+    int AddStage(const std::string& name, size_t capacity, OverflowPolicy policy, StageHandler handler,
+                 int upstream = -1);
+
+    /**
+     * @brief 启动所有阶段的工作线程；Stop 之后可再次调用，各阶段队列重新打开
+     */
+    bool Start();
+
+    /**
+     * @brief 按拓扑顺序关闭队列并等待各阶段排空退出
+     */
+    void Stop();
+
+    /**
+     * @brief 向所有根阶段提交一帧
+     * @return true 至少一个根阶段接收了该帧
+     */
+    bool Submit(const FramePtr& frame);
+
+    /**
+     * @brief 获取各阶段运行统计
+     */
+    std::vector<StageStats> GetStats() const;
+
+    /**
+     * @brief 获取已提交帧数
+     */
+    uint64_t GetSubmittedCount() const { return submitted_; }
+
+    bool IsRunning() const { return running_; }
+
+private:
+    struct Stage
+    {
+        std::string name;
+        std::unique_ptr<BoundedQueue<FramePtr>> queue;
+        StageHandler handler;
+        std::vector<size_t> downstream;
+        std::thread worker;
+        std::atomic<uint64_t> processed {0};
+    };
+
+    void WorkerLoop(Stage& stage);
+
+    void Dispatch(const std::vector<size_t>& targets, const FramePtr& frame);
+
+private:
+    std::vector<std::unique_ptr<Stage>> stages_;
+    std::vector<size_t> roots_;
+    std::atomic<bool> running_ {false};
+    std::atomic<uint64_t> submitted_ {0};
+};
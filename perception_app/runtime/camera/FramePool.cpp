@@ -0,0 +1,59 @@
+#include "FramePool.hpp"
+#include <algorithm>
+#include <atomic>
+
+FramePool::FramePool(size_t capacity, size_t preallocate) : capacity_(std::max<size_t>(capacity, 1)) {
+  slots_.reserve(capacity_);
+  for (size_t i = 0; i < std::min(preallocate, capacity_); ++i) {
+    slots_.push_back(std::make_shared<FrameSet>());
+  }
+  stats_.capacity = capacity_;
+}
+
+std::shared_ptr<FrameSet> FramePool::Acquire() {
+  std::shared_ptr<FrameSet> frame_set;
+  size_t in_use = 0;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats_.acquired++;
+
+    // A slot whose only owner is the pool has been released by every consumer. Nobody
+    // else can take a new reference to it, so the count cannot grow behind our back.
+    for (const auto &slot : slots_) {
+      if (slot.use_count() == 1) {
+        if (!frame_set) {
+          // use_count() is a relaxed load. Consumers drop their reference with a release decrement, so
+          // an acquire fence after observing 1 orders their last accesses to the frame before our reuse.
+          std::atomic_thread_fence(std::memory_order_acquire);
+          frame_set = slot;
+          stats_.reused++;
+        }
+      } else {
+        in_use++;
+      }
+    }
+
+    if (!frame_set) {
+      frame_set = std::make_shared<FrameSet>();
+      if (slots_.size() < capacity_) {
+        slots_.push_back(frame_set);
+      } else {
+        stats_.overflow++;
+      }
+    }
+
+    in_use++;
+    stats_.high_water = std::max(stats_.high_water, in_use);
+  }
+
+  return frame_set;
+}
+
+FramePool::Stats FramePool::GetStats() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  Stats stats = stats_;
+  stats.slots = slots_.size();
+  stats.in_use = static_cast<size_t>(
+      std::count_if(slots_.begin(), slots_.end(), [](const auto &slot) { return slot.use_count() > 1; }));
+  return stats;
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "FrameSet.hpp"
+
+/**
+ * @brief FrameSet 帧缓冲池
+ *
+ * 池中每个槽位持有一个 FrameSet，并保留其各类数据产品（伪彩色深度、变换点云、
+ * 深度图转换点云等）的存储。Acquire 优先复用没有外部引用的槽位，装载新帧后
+ * 分辨率不变时重新计算数据产品不会再分配内存（SDK 点云接口每次返回新分配的全帧点云，这部分无法复用）；
+ * 所有消费者释放 shared_ptr（包括由其转换而来的 FrameSnapshot，二者共享引用计数）后，
+ * 槽位自动回到可用状态，无需显式归还。
+ *
+ * 所有槽位都在使用中时会新建槽位（池容量以内保留，超出后用完即释放），
+ * 并记录同时在用的最大帧数（高水位），用于评估池容量是否足够。
+ */
+class FramePool
+{
+public:
+    /**
+     * @brief 帧缓冲池统计
+     */
+    struct Stats
+    {
+        size_t capacity = 0;     // 池容量（最多保留的槽位数）
+        size_t slots = 0;        // 当前槽位数
+        size_t in_use = 0;       // 当前在用帧数
+        size_t high_water = 0;   // 同时在用帧数的历史最大值
+        uint64_t acquired = 0;   // 累计分配帧数
+        uint64_t reused = 0;     // 复用已有槽位的次数
+        uint64_t overflow = 0;   // 池已满、临时新建且不保留的次数
+    };
+
+    /**
+     * @param capacity 最多保留的槽位数
+     * @param preallocate 预先创建的槽位数（不超过 capacity）
+     */
+    explicit FramePool(size_t capacity, size_t preallocate = 0);
+
+    FramePool(const FramePool&) = delete;
+    FramePool& operator=(const FramePool&) = delete;
+
+    /**
+     * @brief 获取一个可供装载新帧的 FrameSet
+     *
+     * 返回的 FrameSet 仍保留上一帧的内容，调用方需先调用 FrameSet::Reset 装载新帧，
+     * 再交给其他消费者。
+     */
+    std::shared_ptr<FrameSet> Acquire();
+
+    /**
+     * @brief 获取池统计
+     */
+    Stats GetStats() const;
+
+private:
+    const size_t capacity_;
+    std::vector<std::shared_ptr<FrameSet>> slots_;
+    mutable std::mutex mutex_;
+    Stats stats_;
+};
@@ -0,0 +1,143 @@
+#include "FrameRecorder.hpp"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <ctime>
+#include <iomanip>
+#include <sstream>
+#include "Logger.hpp"
+
+FrameRecorder::FrameRecorder(const Config &config, EventWriter writer) : config_(config), writer_(std::move(writer)) {}
+
+void FrameRecorder::Record(const FramePtr &frame) {
+  if (!frame) return;
+
+  std::unique_ptr<Event> finished;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats_.recorded++;
+
+    if (event_) {
+      event_->frames.push_back(frame);
+      if (--event_->remaining == 0) {
+        finished = std::move(event_);
+      }
+    } else {
+      // Sized once on entry; products computed later by other holders are not re-counted
+      Buffered entry{frame, frame->GetMemoryBytes()};
+      stats_.bytes += entry.bytes;
+      ring_.push_back(std::move(entry));
+
+      // The newest frame is always kept, even if it alone exceeds the memory limit
+      while (ring_.size() > 1 && (ring_.size() > config_.max_frames ||
+                                  (config_.max_bytes > 0 && stats_.bytes > config_.max_bytes))) {
+        stats_.bytes -= ring_.front().bytes;
+        ring_.pop_front();
+        stats_.evicted++;
+      }
+    }
+    stats_.frames = ring_.size();
+    stats_.capturing = event_ != nullptr;
+  }
+
+  if (finished) {
+    LOG_INFO_STREAM << "Recorded event complete: " << finished->directory;
+    Write(finished->frames, finished->directory);
+  }
+}
+
+bool FrameRecorder::Trigger(const std::string &reason) {
+  std::vector<FramePtr> frames;
+  std::string directory;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats_.triggers++;
+
+    if (event_) {
+      // Back-to-back triggers belong to the same incident; keep recording instead of starting over
+      event_->remaining = std::max(event_->remaining, config_.post_trigger_frames);
+      LOG_INFO_STREAM << "Recorder triggered (" << reason << ") during event, extending " << event_->directory;
+      return false;
+    }
+
+    stats_.events++;
+    directory = MakeEventDirectory(reason);
+    frames.reserve(ring_.size());
+    for (auto &entry : ring_) {
+      frames.push_back(std::move(entry.frame));
+    }
+    ring_.clear();
+    stats_.bytes = 0;
+    stats_.frames = 0;
+
+    if (config_.post_trigger_frames > 0) {
+      event_ = std::make_unique<Event>();
+      event_->directory = directory;
+      event_->remaining = config_.post_trigger_frames;
+      event_->frames.reserve(config_.post_trigger_frames);
+    }
+    stats_.capturing = event_ != nullptr;
+  }
+
+  LOG_INFO_STREAM << "Recorder triggered (" << reason << "), writing " << frames.size()
+                  << " pre-trigger frames to " << directory;
+  Write(frames, directory);
+  return true;
+}
+
+void FrameRecorder::Flush() {
+  std::unique_ptr<Event> finished;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    finished = std::move(event_);
+    stats_.capturing = false;
+  }
+
+  if (finished) {
+    LOG_INFO_STREAM << "Recorded event cut short with " << finished->remaining
+                    << " post-trigger frames missing: " << finished->directory;
+    Write(finished->frames, finished->directory);
+  }
+}
+
+FrameRecorder::Stats FrameRecorder::GetStats() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return stats_;
+}
+
+std::string FrameRecorder::MakeEventDirectory(const std::string &reason) const {
+  const auto now = std::chrono::system_clock::now();
+  const std::time_t seconds = std::chrono::system_clock::to_time_t(now);
+  const auto millis =
+      std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()).count() % 1000;
+  std::tm local = {};
+  localtime_r(&seconds, &local);
+
+  // Reasons come from callers (and possibly the network); keep them filesystem-safe
+  std::string safe_reason = reason.empty() ? "manual" : reason;
+  for (auto &c : safe_reason) {
+    if (!std::isalnum(static_cast<unsigned char>(c)) && c != '-' && c != '_') {
+      c = '_';
+    }
+  }
+
+  std::ostringstream name;
+  name << config_.path;
+  if (!config_.path.empty() && config_.path.back() != '/') {
+    name << '/';
+  }
+  name << std::put_time(&local, "%Y%m%d_%H%M%S") << '_' << std::setw(3) << std::setfill('0') << millis << '_'
+       << safe_reason;
+  return name.str();
+}
+
+void FrameRecorder::Write(const std::vector<FramePtr> &frames, const std::string &directory) {
+  if (frames.empty() || !writer_) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats_.flushed += frames.size();
+  }
+  writer_(frames, directory);
+}
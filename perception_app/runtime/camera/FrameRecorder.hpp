@@ -0,0 +1,104 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "FrameSet.hpp"
+
+/**
+ * @brief 内存环形帧记录器（事件触发落盘）
+ *
+ * 平时只在内存中保留最近的若干帧（按帧数和内存上限淘汰最旧的帧），不写盘；Trigger 时
+ * 将缓冲中的帧作为触发前窗口一次性交给写入回调，随后继续收集 post_trigger_frames 帧作为
+ * 触发后窗口，收满后再一次性写入。两个窗口写入同一个事件目录 <path>/<时间>_<原因>。
+ *
+ * 触发后窗口收集期间再次触发只会延长窗口，不新建事件。每个事件最多调用两次写入回调，
+ * 不会因逐帧提交而挤满落盘队列。缓冲中的帧持有 FrameSet 的快照，帧缓冲池需要为其
+ * 预留容量。线程安全；写入回调在锁外调用。
+ */
+class FrameRecorder
+{
+public:
+    using FramePtr = FrameSnapshot;
+
+    /**
+     * @brief 写入一个窗口的帧
+     * @param frames 按采集顺序排列的帧
+     * @param directory 事件目录（不保证已存在）
+     */
+    using EventWriter = std::function<void(const std::vector<FramePtr>& frames, const std::string& directory)>;
+
+    struct Config
+    {
+        size_t max_frames = 60;          // 缓冲的最大帧数
+        size_t max_bytes = 0;            // 缓冲的最大内存，0 表示不限制
+        size_t post_trigger_frames = 30; // 触发后继续记录的帧数
+        std::string path = "./dumps/events/";
+    };
+
+    struct Stats
+    {
+        size_t frames = 0;          // 当前缓冲的帧数
+        size_t bytes = 0;           // 当前缓冲占用的内存
+        uint64_t recorded = 0;      // 累计记录的帧数
+        uint64_t evicted = 0;       // 因超出上限而丢弃的帧数
+        uint64_t triggers = 0;      // 累计触发次数（含延长窗口的触发）
+        uint64_t events = 0;        // 累计事件数
+        uint64_t flushed = 0;       // 累计交给写入回调的帧数
+        bool capturing = false;     // 是否正在收集触发后窗口
+    };
+
+    FrameRecorder(const Config& config, EventWriter writer);
+
+    FrameRecorder(const FrameRecorder&) = delete;
+    FrameRecorder& operator=(const FrameRecorder&) = delete;
+
+    /**
+     * @brief 记录一帧：收集触发后窗口期间计入该窗口，否则放入环形缓冲
+     */
+    void Record(const FramePtr& frame);
+
+    /**
+     * @brief 触发一次事件，写出触发前窗口并开始收集触发后窗口
+     * @param reason 触发原因，用于事件目录名
+     * @return 新建事件返回 true，延长已有事件的触发后窗口返回 false
+     */
+    bool Trigger(const std::string& reason);
+
+    /**
+     * @brief 提前结束正在收集的触发后窗口并写出已收集的帧（如退出前）
+     */
+    void Flush();
+
+    Stats GetStats() const;
+
+private:
+    struct Buffered
+    {
+        FramePtr frame;
+        size_t bytes = 0;
+    };
+
+    struct Event
+    {
+        std::string directory;
+        std::vector<FramePtr> frames;
+        size_t remaining = 0;
+    };
+
+    std::string MakeEventDirectory(const std::string& reason) const;
+
+    void Write(const std::vector<FramePtr>& frames, const std::string& directory);
+
+    const Config config_;
+    const EventWriter writer_;
+    mutable std::mutex mutex_;
+    std::deque<Buffered> ring_;
+    std::unique_ptr<Event> event_;
+    Stats stats_;
+};
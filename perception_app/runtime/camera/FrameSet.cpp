@@ -1,89 +1,474 @@
 #include "FrameSet.hpp"
 #include "CameraInfo.hpp"
+#include "processing/DepthColorizer.hpp"
+#include "processing/DepthCropper.hpp"
+#include "processing/DepthProjector.hpp"
+#include "processing/PointCloudDownsampler.hpp"
+#include "processing/PointCloudTransformer.hpp"
+#include "processing/TemporalDepthFilter.hpp"
+#include <cstring>
 #include <opencv2/opencv.hpp>
 #include <area_scan_3d_camera/api_util.h>
-#include <area_scan_3d_camera/PointCloudTransformation.h>
 #include <area_scan_3d_camera/Frame2DAnd3D.h>
 #include <cmath>
 
-FrameSet::FrameSet(const mmind::eye::Frame2DAnd3D &frame, const std::string &suffix)
-    : frame2DAnd3D(frame), suffix(suffix) {
+const char *FrameProductToString(FrameProduct product) {
+  switch (product) {
+    case FrameProduct::Color:
+      return "Color";
+    case FrameProduct::Depth:
+      return "Depth";
+    case FrameProduct::RenderDepth:
+      return "RenderDepth";
+    case FrameProduct::PointCloud:
+      return "PointCloud";
+    case FrameProduct::PointCloudWithNormals:
+      return "PointCloudWithNormals";
+    case FrameProduct::TexturedPointCloud:
+      return "TexturedPointCloud";
+    case FrameProduct::TexturedPointCloudWithNormals:
+      return "TexturedPointCloudWithNormals";
+    case FrameProduct::PointCloudFromDepth:
+      return "PointCloudFromDepth";
+    case FrameProduct::DownsampledPointCloud:
+      return "DownsampledPointCloud";
+    case FrameProduct::CroppedDepth:
+      return "CroppedDepth";
+    default:
+      return "Unknown";
+  }
+}
+
+FrameSet::FrameSet(const mmind::eye::Frame2DAnd3D &frame, const std::string &suffix) { Reset(frame, suffix); }
+
+void FrameSet::Reset(const mmind::eye::Frame2DAnd3D &frame, const std::string &suffix) {
+  Reset(frame, suffix, CameraInfo::getInstance().cameraIntrinsics_, CameraInfo::getInstance().transformation_);
+}
+
+void FrameSet::Reset(const mmind::eye::Frame2DAnd3D &frame, const std::string &suffix,
+                     const mmind::eye::CameraIntrinsics &intrinsics,
+                     const mmind::eye::FrameTransformation &transformation) {
+  frame2DAnd3D = frame;
+  hasCameraFrame_ = true;
+
+  cv::Mat color;
   mmind::eye::Color2DImage colorImage = frame.frame2D().getColorImage();
-  color = cv::Mat(colorImage.height(), colorImage.width(), CV_8UC3, colorImage.data());
-  hasColor = true;
+  if (!colorImage.isEmpty()) {
+    color = cv::Mat(colorImage.height(), colorImage.width(), CV_8UC3, colorImage.data());
+  }
 
+  cv::Mat depth;
   mmind::eye::DepthMap depthMap = frame.frame3D().getDepthMap();
-  depthImage = cv::Mat(depthMap.height(), depthMap.width(), CV_32FC1, depthMap.data());
-  hasDepth = true;
-}
+  if (!depthMap.isEmpty()) {
+    depth = cv::Mat(depthMap.height(), depthMap.width(), CV_32FC1, depthMap.data());
+  }
 
-void FrameSet::DecodeFrame() {
-  renderDepth = renderDepthData(depthImage);
-  hasRenderDepth = true;
+  ResetImages(color, depth, suffix, intrinsics, transformation);
+}
 
-  processPointCloud(CameraInfo::getInstance().transformation_);
+void FrameSet::Reset(const cv::Mat &color, const cv::Mat &depth, const std::string &suffix,
+                     const mmind::eye::CameraIntrinsics &intrinsics,
+                     const mmind::eye::FrameTransformation &transformation) {
+  frame2DAnd3D.clear();
+  hasCameraFrame_ = false;
+  ResetImages(color, depth, suffix, intrinsics, transformation);
+}
 
-  convertDepthToPointCloud(frame2DAnd3D.frame3D().getDepthMap(), CameraInfo::getInstance().cameraIntrinsics_,
-                           pointCloudFromDepth);
-  hasPointCloudFromDepth = true;
+void FrameSet::SetPointClouds(const mmind::eye::PointCloud &pointCloud,
+                              const mmind::eye::TexturedPointCloud &texturedPointCloud) {
+  FrameProductMask loaded = kNoFrameProducts;
+  if (!pointCloud.isEmpty()) {
+    pointCloud_.resize(pointCloud.width(), pointCloud.height());
+    std::memcpy(pointCloud_.data(), pointCloud.data(),
+                pointCloud.width() * pointCloud.height() * sizeof(mmind::eye::PointXYZ));
+    loaded |= ToProductMask(FrameProduct::PointCloud);
+  }
+  if (!texturedPointCloud.isEmpty()) {
+    texturedPointCloud_.resize(texturedPointCloud.width(), texturedPointCloud.height());
+    const mmind::eye::PointXYZBGR *in = texturedPointCloud.data();
+    mmind::eye::PointXYZBGR *out = texturedPointCloud_.data();
+    for (size_t i = 0; i < texturedPointCloud.width() * texturedPointCloud.height(); ++i) {
+      // PointXYZBGR has no assignment operator
+      out[i].x = in[i].x;
+      out[i].y = in[i].y;
+      out[i].z = in[i].z;
+      out[i].b = in[i].b;
+      out[i].g = in[i].g;
+      out[i].r = in[i].r;
+      out[i].a = in[i].a;
+    }
+    loaded |= ToProductMask(FrameProduct::TexturedPointCloud);
+  }
+  loadedClouds_ = loaded;
+  ready_mask_.fetch_or(loaded, std::memory_order_release);
 }
 
-inline bool isApprox0(double d) { return std::fabs(d) <= DBL_EPSILON; }
+void FrameSet::ResetImages(const cv::Mat &color, const cv::Mat &depth, const std::string &suffix,
+                           const mmind::eye::CameraIntrinsics &intrinsics,
+                           const mmind::eye::FrameTransformation &transformation) {
+  this->suffix = suffix;
+  camera_id.clear();
+  scene_changed = true;
+  intrinsics_ = intrinsics;
+  transformation_ = transformation;
+  loadedClouds_ = kNoFrameProducts;
 
-cv::Mat FrameSet::renderDepthData(const cv::Mat &depth) {
-  if (depth.empty()) return cv::Mat();
-  cv::Mat mask = cv::Mat(depth == depth);
-  double minDepthValue, maxDepthValue;
-  cv::minMaxLoc(depth, &minDepthValue, &maxDepthValue, nullptr, nullptr, mask);
+  // Product buffers are kept so that recomputing them at the same resolution reuses the storage
+  FrameProductMask ready = kNoFrameProducts;
+  color_ = color;
+  if (!color_.empty()) {
+    ready |= ToProductMask(FrameProduct::Color);
+  }
+  depthImage_ = depth;
+  depthFiltered_ = false;
+  if (!depthImage_.empty()) {
+    ready |= ToProductMask(FrameProduct::Depth);
+  }
 
-  cv::Mat depth8U;
-  isApprox0(maxDepthValue - minDepthValue)
-      ? depth.convertTo(depth8U, CV_8UC1)
-      : depth.convertTo(depth8U, CV_8UC1, (255.0 / (minDepthValue - maxDepthValue)),
-                        (((maxDepthValue * 255.0) / (maxDepthValue - minDepthValue)) + 1));
+  ready_mask_.store(ready, std::memory_order_release);
+}
 
-  if (depth8U.empty()) return cv::Mat();
+void FrameSet::ApplyTemporalFilter(TemporalDepthFilter &filter) {
+  if (depthImage_.empty()) return;
+  // The SDK frame keeps its raw depth; the frame's own buffer is reused across pooled frames
+  filter.Apply(depthImage_, filteredDepth_);
+  depthImage_ = filteredDepth_;
+  depthFiltered_ = true;
+}
 
-  cv::Mat coloredDepth;
-  cv::applyColorMap(depth8U, coloredDepth, cv::COLORMAP_JET);
-  coloredDepth.forEach<cv::Vec3b>([&](auto &val, const int *pos) {
-    if (!depth8U.ptr<uchar>(pos[0])[pos[1]]) {
-      val[0] = 0;
-      val[1] = 0;
-      val[2] = 0;
+void FrameSet::DecodeFrame(FrameProductMask products) const {
+  // Transformed clouds of an SDK frame requested together share a single pass
+  if (hasCameraFrame_) {
+    FrameProductMask clouds = kNoFrameProducts;
+    for (FrameProduct product : kCameraCloudProducts) {
+      if ((products & ToProductMask(product)) && IsAvailable(product)) {
+        clouds |= ToProductMask(product);
+      }
     }
-  });
-  return coloredDepth;
+    ProduceCameraClouds(clouds);
+  }
+
+  for (uint32_t i = 0; i < static_cast<uint32_t>(FrameProduct::Count); ++i) {
+    FrameProduct product = static_cast<FrameProduct>(i);
+    if ((products & ToProductMask(product)) && IsAvailable(product)) {
+      Produce(product);
+    }
+  }
+}
+
+bool FrameSet::IsAvailable(FrameProduct product) const {
+  // Frames without an SDK capture (e.g. replayed from disk) derive point clouds from the
+  // depth map, which needs intrinsics, unless the clouds were loaded with SetPointClouds;
+  // normals are only computed by the SDK.
+  const bool hasIntrinsics = intrinsics_.depth.cameraMatrix.fx > 0 && intrinsics_.depth.cameraMatrix.fy > 0;
+  if (loadedClouds_ & ToProductMask(product)) return true;
+  switch (product) {
+    case FrameProduct::Color:
+      return !color_.empty();
+    case FrameProduct::Depth:
+    case FrameProduct::RenderDepth:
+    case FrameProduct::CroppedDepth:
+      return !depthImage_.empty();
+    case FrameProduct::PointCloud:
+    case FrameProduct::DownsampledPointCloud:
+      return (loadedClouds_ & ToProductMask(FrameProduct::PointCloud)) ||
+             (!depthImage_.empty() && (hasCameraFrame_ || hasIntrinsics));
+    case FrameProduct::PointCloudWithNormals:
+      return !depthImage_.empty() && hasCameraFrame_;
+    case FrameProduct::PointCloudFromDepth:
+      return !depthImage_.empty() && hasIntrinsics;
+    case FrameProduct::TexturedPointCloud:
+      return !color_.empty() && !depthImage_.empty() &&
+             (hasCameraFrame_ || (hasIntrinsics && color_.size() == depthImage_.size()));
+    case FrameProduct::TexturedPointCloudWithNormals:
+      return !color_.empty() && !depthImage_.empty() && hasCameraFrame_;
+    default:
+      return false;
+  }
+}
+
+bool FrameSet::IsReady(FrameProduct product) const { return (ReadyProducts() & ToProductMask(product)) != 0; }
+
+namespace {
+size_t MatBytes(const cv::Mat &mat) { return mat.total() * mat.elemSize(); }
+
+template <typename Array>
+size_t ArrayBytes(const Array &array) {
+  return array.width() * array.height() * sizeof(array[0]);
+}
+}  // namespace
+
+size_t FrameSet::GetMemoryBytes() const {
+  size_t bytes = MatBytes(color_) + MatBytes(depthImage_);
+  // Only products whose ready bit is set are finished; others may be under construction on another thread
+  const FrameProductMask ready = ReadyProducts();
+  auto has = [ready](FrameProduct product) { return (ready & ToProductMask(product)) != 0; };
+  if (has(FrameProduct::RenderDepth)) bytes += MatBytes(renderDepth_);
+  if (has(FrameProduct::PointCloud)) bytes += ArrayBytes(pointCloud_);
+  if (has(FrameProduct::PointCloudWithNormals)) bytes += ArrayBytes(pointCloudWithNormals_);
+  if (has(FrameProduct::TexturedPointCloud)) bytes += ArrayBytes(texturedPointCloud_);
+  if (has(FrameProduct::TexturedPointCloudWithNormals)) bytes += ArrayBytes(texturedPointCloudWithNormals_);
+  if (has(FrameProduct::PointCloudFromDepth)) bytes += ArrayBytes(pointCloudFromDepth_);
+  if (has(FrameProduct::DownsampledPointCloud)) bytes += ArrayBytes(downsampledPointCloud_);
+  if (has(FrameProduct::CroppedDepth) && crop.enable) bytes += MatBytes(croppedDepth_);
+  return bytes;
+}
+
+const cv::Mat &FrameSet::GetColor() const { return color_; }
+
+const cv::Mat &FrameSet::GetDepthImage() const { return depthImage_; }
+
+const cv::Mat &FrameSet::GetRenderDepth() const {
+  Produce(FrameProduct::RenderDepth);
+  return renderDepth_;
+}
+
+const cv::Mat &FrameSet::GetCroppedDepth() const {
+  if (!crop.enable) {
+    return depthImage_;
+  }
+  Produce(FrameProduct::CroppedDepth);
+  return croppedDepth_;
 }
 
-void FrameSet::processPointCloud(mmind::eye::FrameTransformation transformation) {
-  pointCloud = mmind::eye::transformPointCloud(transformation, frame2DAnd3D.frame3D().getUntexturedPointCloud());
-  hasPointCloud = true;
+cv::Rect FrameSet::GetCropRegion() const { return DepthCropper::Region(crop, depthImage_.size()); }
 
-  pointCloudWithNormals =
-      mmind::eye::transformPointCloudWithNormals(transformation, frame2DAnd3D.frame3D().getUntexturedPointCloud());
-  hasPointCloudWithNormals = true;
+const mmind::eye::PointCloud &FrameSet::GetPointCloud() const {
+  Produce(FrameProduct::PointCloud);
+  return pointCloud_;
+}
+
+const mmind::eye::PointCloudWithNormals &FrameSet::GetPointCloudWithNormals() const {
+  Produce(FrameProduct::PointCloudWithNormals);
+  return pointCloudWithNormals_;
+}
+
+const mmind::eye::TexturedPointCloud &FrameSet::GetTexturedPointCloud() const {
+  Produce(FrameProduct::TexturedPointCloud);
+  return texturedPointCloud_;
+}
+
+const mmind::eye::TexturedPointCloudWithNormals &FrameSet::GetTexturedPointCloudWithNormals() const {
+  Produce(FrameProduct::TexturedPointCloudWithNormals);
+  return texturedPointCloudWithNormals_;
+}
+
+const mmind::eye::PointCloud &FrameSet::GetPointCloudFromDepth() const {
+  Produce(FrameProduct::PointCloudFromDepth);
+  return pointCloudFromDepth_;
+}
+
+const mmind::eye::PointCloud &FrameSet::GetDownsampledPointCloud() const {
+  if (downsample.mode == PointCloudDownsampler::Mode::None) {
+    return GetPointCloud();
+  }
+  Produce(FrameProduct::DownsampledPointCloud);
+  return downsampledPointCloud_;
+}
+
+template <typename Producer>
+void FrameSet::EnsureProduct(FrameProduct product, Producer &&producer) const {
+  const FrameProductMask bit = ToProductMask(product);
+  if (ready_mask_.load(std::memory_order_acquire) & bit) return;
+
+  // Double-checked under a per-product lock so that independent products can be
+  // computed concurrently by different pipeline stages.
+  std::lock_guard<std::mutex> lock(product_mutexes_[static_cast<size_t>(product)]);
+  if (ready_mask_.load(std::memory_order_acquire) & bit) return;
+
+  producer();
+  ready_mask_.fetch_or(bit, std::memory_order_release);
+}
 
-  texturedPointCloud = mmind::eye::transformTexturedPointCloud(transformation, frame2DAnd3D.getTexturedPointCloud());
-  hasTexturedPointCloud = true;
+void FrameSet::Produce(FrameProduct product) const {
+  if (!IsAvailable(product)) {
+    // Drop whatever a previous (pooled) frame left behind so getters return empty data
+    EnsureProduct(product, [this, product] { ReleaseProduct(product); });
+    return;
+  }
 
-  texturedPointCloudWithNormals =
-      mmind::eye::transformTexturedPointCloudWithNormals(transformation, frame2DAnd3D.getTexturedPointCloud());
-  hasTexturedPointCloudWithNormals = true;
+  switch (product) {
+    case FrameProduct::RenderDepth:
+      EnsureProduct(product, [this] { DepthColorizer::Colorize(depthImage_, renderDepth_); });
+      break;
+    case FrameProduct::PointCloud:
+    case FrameProduct::PointCloudWithNormals:
+    case FrameProduct::TexturedPointCloud:
+    case FrameProduct::TexturedPointCloudWithNormals:
+      if (hasCameraFrame_) {
+        ProduceCameraClouds(ToProductMask(product));
+      } else if (product == FrameProduct::PointCloud) {
+        EnsureProduct(product, [this] {
+          PointCloudTransformer::Transform(transformation_, GetPointCloudFromDepth(), pointCloud_);
+        });
+      } else if (product == FrameProduct::TexturedPointCloud) {
+        EnsureProduct(product, [this] {
+          // The depth-derived cloud covers the crop region, so the color image is cut to match
+          TextureDepthPointCloud(GetPointCloudFromDepth(), color_(GetCropRegion()), texturedPointCloud_);
+          PointCloudTransformer::Transform(transformation_, texturedPointCloud_, texturedPointCloud_);
+        });
+      }
+      break;
+    case FrameProduct::PointCloudFromDepth:
+      EnsureProduct(product, [this] {
+        const cv::Mat &source = GetCroppedDepth();
+        if (source.empty()) {
+          // The crop region lies outside the depth map
+          pointCloudFromDepth_.release();
+          return;
+        }
+        const cv::Mat depth = source.isContinuous() ? source : source.clone();
+        // Pixel (col, row) of the cropped depth is (x + col, y + row) in the sensor image
+        const cv::Rect region = GetCropRegion();
+        mmind::eye::CameraMatrix matrix = intrinsics_.depth.cameraMatrix;
+        matrix.cx -= region.x;
+        matrix.cy -= region.y;
+        DepthProjector::Get(matrix, depth.cols, depth.rows)->Project(depth.ptr<float>(), pointCloudFromDepth_);
+      });
+      break;
+    case FrameProduct::DownsampledPointCloud:
+      EnsureProduct(product, [this] {
+        if (downsample.mode == PointCloudDownsampler::Mode::None) {
+          // Served by GetPointCloud() directly; computing it here only prefetches the source
+          GetPointCloud();
+          downsampledPointCloud_.release();
+        } else {
+          PointCloudDownsampler::Downsample(GetPointCloud(), downsampledPointCloud_, downsample);
+        }
+      });
+      break;
+    case FrameProduct::CroppedDepth:
+      EnsureProduct(product, [this] {
+        if (crop.enable) {
+          DepthCropper::Crop(depthImage_, intrinsics_.depth.cameraMatrix, transformation_, crop, croppedDepth_);
+        } else {
+          // Served by GetDepthImage() directly
+          croppedDepth_.release();
+        }
+      });
+      break;
+    default:
+      // Color and depth are wrapped at construction time
+      break;
+  }
 }
 
+void FrameSet::ProduceCameraClouds(FrameProductMask products) const {
+  auto pending = [this, &products] { return products & ~ReadyProducts(); };
+  if (pending() == kNoFrameProducts) return;
+
+  // Taken before the product locks below: cropping has its own product lock
+  const cv::Mat *mask = crop.enable ? &GetCroppedDepth() : nullptr;
+  // Filtered depth (cropped to the same region) replaces the SDK's depth along each ray
+  const cv::Mat *depth = depthFiltered_ ? &GetCroppedDepth() : nullptr;
+
+  // Several cloud locks are held at once, so they are taken in one fixed (product) order. Other producers may
+  // nest into these locks (DownsampledPointCloud takes PointCloud while holding its own), which is safe because
+  // nested locks only ever go to products that never lock back: nothing here takes another product's lock.
+  std::array<std::unique_lock<std::mutex>, kCameraCloudProducts.size()> locks;
+  for (size_t i = 0; i < kCameraCloudProducts.size(); ++i) {
+    const FrameProduct product = kCameraCloudProducts[i];
+    if (products & ToProductMask(product)) {
+      locks[i] = std::unique_lock<std::mutex>(product_mutexes_[static_cast<size_t>(product)]);
+    }
+  }
+  products = pending();
+  if (products == kNoFrameProducts) return;
+
+  auto wants = [products](FrameProduct product) { return (products & ToProductMask(product)) != 0; };
+  PointCloudTransformer::FusedTargets targets;
+  targets.points = wants(FrameProduct::PointCloud) ? &pointCloud_ : nullptr;
+  targets.pointsWithNormals = wants(FrameProduct::PointCloudWithNormals) ? &pointCloudWithNormals_ : nullptr;
+  targets.textured = wants(FrameProduct::TexturedPointCloud) ? &texturedPointCloud_ : nullptr;
+  targets.texturedWithNormals =
+      wants(FrameProduct::TexturedPointCloudWithNormals) ? &texturedPointCloudWithNormals_ : nullptr;
+
+  PointCloudTransformer::FusedSource source;
+  source.region = GetCropRegion();
+  source.mask = mask;
+  source.depth = depth;
+  // Normals are estimated once, in the camera frame, and shared by both variants with normals.
+  // The SDK getters return a freshly allocated full-frame Array2D on every call and cannot fill an existing
+  // buffer, so these source clouds are one heap allocation per frame that pooling cannot remove; only the
+  // transformed products below reuse the pooled storage.
+  mmind::eye::PointCloud points;
+  mmind::eye::PointCloudWithNormals normals;
+  if (targets.pointsWithNormals != nullptr || targets.texturedWithNormals != nullptr) {
+    normals = frame2DAnd3D.frame3D().getUntexturedPointCloudWithNormals();
+    source.normals = &normals;
+  } else {
+    points = frame2DAnd3D.frame3D().getUntexturedPointCloud();
+    source.points = &points;
+  }
+  mmind::eye::TexturedPointCloud colors;
+  if (targets.textured != nullptr || targets.texturedWithNormals != nullptr) {
+    colors = frame2DAnd3D.getTexturedPointCloud();
+    source.colors = &colors;
+  }
+
+  PointCloudTransformer::TransformFused(transformation_, source, targets);
+  ready_mask_.fetch_or(products, std::memory_order_release);
+}
+
+void FrameSet::ReleaseProduct(FrameProduct product) const {
+  switch (product) {
+    case FrameProduct::RenderDepth:
+      renderDepth_.release();
+      break;
+    case FrameProduct::PointCloud:
+      pointCloud_.release();
+      break;
+    case FrameProduct::PointCloudWithNormals:
+      pointCloudWithNormals_.release();
+      break;
+    case FrameProduct::TexturedPointCloud:
+      texturedPointCloud_.release();
+      break;
+    case FrameProduct::TexturedPointCloudWithNormals:
+      texturedPointCloudWithNormals_.release();
+      break;
+    case FrameProduct::PointCloudFromDepth:
+      pointCloudFromDepth_.release();
+      break;
+    case FrameProduct::DownsampledPointCloud:
+      downsampledPointCloud_.release();
+      break;
+    case FrameProduct::CroppedDepth:
+      croppedDepth_.release();
+      break;
+    default:
+      break;
+  }
+}
+
+void FrameSet::TextureDepthPointCloud(const mmind::eye::PointCloud &pointCloud, const cv::Mat &color,
+                                      mmind::eye::TexturedPointCloud &texturedPointCloud) {
+  texturedPointCloud.resize(pointCloud.width(), pointCloud.height());
+  for (size_t row = 0; row < pointCloud.height(); ++row) {
+    const cv::Vec3b *colorRow = color.ptr<cv::Vec3b>(static_cast<int>(row));
+    for (size_t col = 0; col < pointCloud.width(); ++col) {
+      const size_t i = row * pointCloud.width() + col;
+      mmind::eye::PointXYZBGR &point = texturedPointCloud[i];
+      point.x = pointCloud[i].x;
+      point.y = pointCloud[i].y;
+      point.z = pointCloud[i].z;
+      point.b = colorRow[col][0];
+      point.g = colorRow[col][1];
+      point.r = colorRow[col][2];
+      point.a = 255;
+    }
+  }
+}
+
+cv::Mat FrameSet::renderDepthData(const cv::Mat &depth) { return DepthColorizer::Colorize(depth); }
+
 void FrameSet::convertDepthToPointCloud(const mmind::eye::DepthMap &depth,
                                         const mmind::eye::CameraIntrinsics &intrinsics,
                                         mmind::eye::PointCloud &pointCloud) {
-  pointCloud.resize(depth.width(), depth.height());
-
-  for (int i = 0; i < depth.width() * depth.height(); i++) {
-    const unsigned row = i / depth.width();
-    const unsigned col = i - row * depth.width();
-    pointCloud[i].z = depth[i].z;
-    pointCloud[i].x = static_cast<float>(pointCloud[i].z * (col - intrinsics.depth.cameraMatrix.cx) /
-                                         intrinsics.depth.cameraMatrix.fx);
-    pointCloud[i].y = static_cast<float>(pointCloud[i].z * (row - intrinsics.depth.cameraMatrix.cy) /
-                                         intrinsics.depth.cameraMatrix.fy);
+  if (depth.isEmpty()) {
+    pointCloud.release();
+    return;
   }
+
+  DepthProjector::Get(intrinsics.depth.cameraMatrix, depth.width(), depth.height())->Project(depth, pointCloud);
 }
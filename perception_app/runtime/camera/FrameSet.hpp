@@ -1,54 +1,256 @@
 #pragma once
 
 #include "area_scan_3d_camera/Camera.h"
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <opencv2/opencv.hpp>
+#include "processing/DepthCropper.hpp"
+#include "processing/PointCloudDownsampler.hpp"
 
-struct FrameSet
+class TemporalDepthFilter;
+
+/**
+ * @brief FrameSet 可提供的数据产品
+ */
+enum class FrameProduct : uint32_t {
+    Color = 0,                     // 2D彩色图像, .png格式
+    Depth,                         // 深度图, .tiff格式
+    RenderDepth,                   // 伪彩色深度图
+    PointCloud,                    // 变换后的无纹理点云
+    PointCloudWithNormals,         // 变换后的带法线无纹理点云
+    TexturedPointCloud,            // 变换后的有纹理点云
+    TexturedPointCloudWithNormals, // 变换后的带法线有纹理点云
+    PointCloudFromDepth,           // 从深度图转换的点云
+    DownsampledPointCloud,         // 按 FrameSet::downsample 降采样的 PointCloud
+    CroppedDepth,                  // 按 FrameSet::crop 裁剪的深度图
+    Count
+};
+
+using FrameProductMask = uint32_t;
+
+constexpr FrameProductMask ToProductMask(FrameProduct product) {
+    return FrameProductMask(1) << static_cast<uint32_t>(product);
+}
+
+constexpr FrameProductMask kNoFrameProducts = 0;
+constexpr FrameProductMask kAllFrameProducts = (FrameProductMask(1) << static_cast<uint32_t>(FrameProduct::Count)) - 1;
+
+// 变换点云（含 / 不含纹理与法线）；SDK 采集的帧在同一次 DecodeFrame 中请求的这些产品单次遍历生成
+constexpr FrameProductMask kTransformedCloudProducts =
+    ToProductMask(FrameProduct::PointCloud) | ToProductMask(FrameProduct::PointCloudWithNormals) |
+    ToProductMask(FrameProduct::TexturedPointCloud) | ToProductMask(FrameProduct::TexturedPointCloudWithNormals);
+
+const char* FrameProductToString(FrameProduct product);
+
+/**
+ * @brief 一次采集得到的 2D + 3D 帧数据
+ *
+ * 彩色图和深度图在构造时直接引用 SDK 帧内存；其余数据产品（伪彩色深度、各类变换点云、
+ * 深度图转换点云）在首次访问时才计算并缓存，未被任何消费者读取的产品不产生开销。
+ * 访问接口是线程安全的，多个流水线阶段可以并发读取同一帧。需要多种变换点云时应通过
+ * DecodeFrame 一次请求：SDK 帧的这些产品共用一次遍历和一次法线估计。
+ *
+ * 启用深度裁剪（crop）时，所有点云类产品都由裁剪后的深度图生成，尺寸为裁剪区域大小，ROI 外的
+ * 像素不参与计算；GetCropRegion() 给出点云有序索引到原深度图像素的偏移。彩色图、深度图和
+ * 伪彩色深度图保持全幅。
+ *
+ * 经 ApplyTemporalFilter 时域滤波后，深度图及由其派生的所有产品（伪彩色、裁剪、点云）都使用滤波后的
+ * 深度；SDK 帧的变换点云沿 SDK 计算的视线移到滤波后的深度，法线仍为 SDK 对原始深度的估计。
+ *
+ * 采集阶段装载并设置完成后，帧以 FrameSnapshot（shared_ptr<const FrameSet>）发布给推理、保存、显示等
+ * 消费者：各消费者独立持有同一份数据，互不复制也不能修改，按需计算的数据产品由内部锁保护。
+ * FrameSet 由 FramePool 回收复用，最后一个快照释放后其存储才会被下一帧复用。获取到的数据产品
+ * 引用在持有该帧的快照期间有效，异步消费者应保留快照本身，而不是深拷贝数据。
+ */
+class FrameSet
 {
-    mmind::eye::Frame2DAnd3D frame2DAnd3D;
+public:
+    FrameSet() = default;
+    FrameSet(const mmind::eye::Frame2DAnd3D& frame, const std::string& suffix);
+
+    /**
+     * @brief 装载新的一帧并清空已计算的数据产品，保留其存储以便复用
+     *
+     * 相机内参和坐标变换取自 CameraInfo 的当前值。
+     * @note 非线程安全，只能在没有其他持有者时调用（由 FramePool 保证）
+     */
+    void Reset(const mmind::eye::Frame2DAnd3D& frame, const std::string& suffix);
+
+    /**
+     * @brief 装载相机采集的一帧，使用指定的相机内参和坐标变换
+     */
+    void Reset(const mmind::eye::Frame2DAnd3D& frame, const std::string& suffix,
+               const mmind::eye::CameraIntrinsics& intrinsics, const mmind::eye::FrameTransformation& transformation);
+
+    /**
+     * @brief 装载不来自 SDK 的一帧（如回放的彩色图和深度图）
+     *
+     * 点云由深度图和内参计算，内参无效时点云类产品不可用；带法线的点云只能由 SDK 计算，始终不可用。
+     * @param color CV_8UC3 BGR 彩色图，可为空
+     * @param depth CV_32FC1 深度图（毫米），可为空
+     */
+    void Reset(const cv::Mat& color, const cv::Mat& depth, const std::string& suffix,
+               const mmind::eye::CameraIntrinsics& intrinsics, const mmind::eye::FrameTransformation& transformation);
+
+    /**
+     * @brief 装载回放的变换后点云（如 SaveImages 写出的 PLY），取代由深度图和内参计算的结果
+     *
+     * 非空的点云作为 PointCloud / TexturedPointCloud 产品（不需要深度图和内参，也不按 crop 裁剪），
+     * 空点云表示不提供。点云被复制到帧自身复用的缓冲区。
+     * @note 只能在 Reset(color, depth, ...) 之后、发布之前调用
+     */
+    void SetPointClouds(const mmind::eye::PointCloud& pointCloud,
+                        const mmind::eye::TexturedPointCloud& texturedPointCloud);
+
+    /**
+     * @brief 用相机对应的时域滤波器滤波深度图，此后 GetDepthImage() 返回滤波结果
+     *
+     * 滤波结果写入帧自身复用的缓冲区，不修改 SDK 帧内存。
+     * @note 与 Reset 相同只能在没有其他持有者时调用，且须在访问任何派生数据产品之前
+     */
+    void ApplyTemporalFilter(TemporalDepthFilter& filter);
+
+    /**
+     * @brief 深度图是否经过时域滤波
+     */
+    bool IsDepthFiltered() const { return depthFiltered_; }
+
+    /**
+     * @brief 是否持有 SDK 采集的原始帧（frame2DAnd3D 有效）
+     */
+    bool HasCameraFrame() const { return hasCameraFrame_; }
+
+    /**
+     * @brief 装载该帧时使用的相机内参和坐标变换
+     */
+    const mmind::eye::CameraIntrinsics& GetIntrinsics() const { return intrinsics_; }
+    const mmind::eye::FrameTransformation& GetTransformation() const { return transformation_; }
+
+    FrameSet(const FrameSet&) = delete;
+    FrameSet& operator=(const FrameSet&) = delete;
+
+    /**
+     * @brief 预先计算指定的数据产品
+     * @param products 需要预取的产品集合，其余产品仍在首次访问时计算
+     */
+    void DecodeFrame(FrameProductMask products = kNoFrameProducts) const;
+
+    /**
+     * @brief 检查数据产品是否可以提供（源数据存在）
+     */
+    bool IsAvailable(FrameProduct product) const;
+
+    /**
+     * @brief 检查数据产品是否已经计算完成
+     */
+    bool IsReady(FrameProduct product) const;
+
+    /**
+     * @brief 获取已计算完成的产品集合
+     */
+    FrameProductMask ReadyProducts() const { return ready_mask_.load(std::memory_order_acquire); }
+
+    /**
+     * @brief 估算该帧占用的内存字节数（彩色图、深度图及已计算的数据产品）
+     */
+    size_t GetMemoryBytes() const;
 
     // 图像数据
-    cv::Mat color; // .png格式
-    cv::Mat depthImage; // .tiff格式
-    cv::Mat renderDepth; // .tiff格式
+    const cv::Mat& GetColor() const;
+    const cv::Mat& GetDepthImage() const;
+    const cv::Mat& GetRenderDepth() const;
+    // 按 crop 裁剪的深度图（ROI 大小，范围 / 包围盒外为 NaN）；未启用裁剪时即 GetDepthImage()
+    const cv::Mat& GetCroppedDepth() const;
+    // 裁剪区域在原深度图中的位置，点云类产品的 (col, row) 对应原深度图的 (x + col, y + row)；
+    // 未启用裁剪时为整幅深度图
+    cv::Rect GetCropRegion() const;
 
-    // pointCloud, .ply格式
     // 无纹理点云,只包含点的三维坐标 (X, Y, Z)
     // 适用场景：只需要几何形状信息的应用，如物体尺寸测量、碰撞检测等
-    mmind::eye::PointCloud pointCloud;
+    const mmind::eye::PointCloud& GetPointCloud() const;
     // 带法线的无纹理点云,包含点的三维坐标 (X, Y, Z) 和法线 (Nx, Ny, Nz)
     // 适用场景：需要表面方向信息的应用，如曲面重建、光照模拟、机器人抓取规划
-    mmind::eye::PointCloudWithNormals pointCloudWithNormals;
+    const mmind::eye::PointCloudWithNormals& GetPointCloudWithNormals() const;
     // 有纹理点云,包含点的三维坐标 (X, Y, Z) 和颜色信息 (R, G, B)
     // 适用场景：需要颜色信息的应用，如物体识别、场景重建、AR/VR可视化
-    mmind::eye::TexturedPointCloud texturedPointCloud;
+    const mmind::eye::TexturedPointCloud& GetTexturedPointCloud() const;
     // 带法线的有纹理点云,包含点的三维坐标 (X, Y, Z) 和法线 (Nx, Ny, Nz) 和颜色信息 (R, G, B)
     // 适用场景：需要颜色信息的应用，如物体识别、场景重建、AR/VR可视化
-    mmind::eye::TexturedPointCloudWithNormals texturedPointCloudWithNormals;
+    const mmind::eye::TexturedPointCloudWithNormals& GetTexturedPointCloudWithNormals() const;
+    // 从深度图转换的点云
+    const mmind::eye::PointCloud& GetPointCloudFromDepth() const;
+    // 降采样后的 PointCloud，供不需要全分辨率的消费者使用；降采样模式为 None 时即 GetPointCloud()
+    const mmind::eye::PointCloud& GetDownsampledPointCloud() const;
 
-    // 从深度图转换的点云, .ply格式
-    mmind::eye::PointCloud pointCloudFromDepth;
+    // 深度图伪彩色渲染（JET，近红远蓝，无效深度为黑色），与 CVWindow 共用 DepthColorizer
+    static cv::Mat renderDepthData(const cv::Mat& depth);
 
+    static void convertDepthToPointCloud(const mmind::eye::DepthMap& depth,
+                                         const mmind::eye::CameraIntrinsics& intrinsics,
+                                         mmind::eye::PointCloud& pointCloud);
+
+public:
+    mmind::eye::Frame2DAnd3D frame2DAnd3D;
     std::string suffix;
+    std::string camera_id;  // 采集该帧的相机序列号，由 FrameSource 在 Reset 之后设置
+    PointCloudDownsampler::Options downsample;  // DownsampledPointCloud 的参数，应在首次访问前设置
+    DepthCropper::Options crop;  // 点云类产品的深度裁剪参数，应在首次访问任何点云类产品前设置
+    bool scene_changed = true;  // 与该相机上一处理帧相比场景是否变化，由采集阶段检测；未启用检测时始终为 true
 
-    // 数据可用标志
-    bool hasColor = false;
-    bool hasDepth = false;
-    bool hasRenderDepth = false;
-    bool hasPointCloud = false;
-    bool hasPointCloudWithNormals = false;
-    bool hasTexturedPointCloud = false;
-    bool hasTexturedPointCloudWithNormals = false;
-    bool hasPointCloudFromDepth = false;
+private:
+    template <typename Producer>
+    void EnsureProduct(FrameProduct product, Producer&& producer) const;
 
-    FrameSet(const mmind::eye::Frame2DAnd3D& frame, const std::string& suffix);
+    void Produce(FrameProduct product) const;
+
+    /**
+     * @brief 在一次遍历中计算 SDK 帧的多种变换点云（kCameraCloudProducts 的子集），已完成的跳过
+     */
+    void ProduceCameraClouds(FrameProductMask products) const;
 
-    void DecodeFrame();
+    void ReleaseProduct(FrameProduct product) const;
 
-    cv::Mat renderDepthData(const cv::Mat& depth);
+    void ResetImages(const cv::Mat& color, const cv::Mat& depth, const std::string& suffix,
+                     const mmind::eye::CameraIntrinsics& intrinsics,
+                     const mmind::eye::FrameTransformation& transformation);
 
-    void processPointCloud(mmind::eye::FrameTransformation transformation);
+    static void TextureDepthPointCloud(const mmind::eye::PointCloud& pointCloud, const cv::Mat& color,
+                                       mmind::eye::TexturedPointCloud& texturedPointCloud);
 
-    void convertDepthToPointCloud(const mmind::eye::DepthMap& depth, const mmind::eye::CameraIntrinsics& intrinsics, mmind::eye::PointCloud& pointCloud);
+private:
+    // SDK 帧由 ProduceCameraClouds 一起计算的变换点云，按产品顺序排列
+    static constexpr std::array<FrameProduct, 4> kCameraCloudProducts = {
+        FrameProduct::PointCloud, FrameProduct::PointCloudWithNormals, FrameProduct::TexturedPointCloud,
+        FrameProduct::TexturedPointCloudWithNormals};
+
+    // 采集时的相机参数快照，保证延迟计算使用与采集一致的参数
+    mmind::eye::FrameTransformation transformation_;
+    mmind::eye::CameraIntrinsics intrinsics_;
+    bool hasCameraFrame_ = false;
+    FrameProductMask loadedClouds_ = kNoFrameProducts;  // 由 SetPointClouds 装载的点云产品
+
+    cv::Mat color_;
+    cv::Mat depthImage_;
+    cv::Mat filteredDepth_;  // 时域滤波结果的存储，滤波后 depthImage_ 引用它
+    bool depthFiltered_ = false;
+    mutable cv::Mat renderDepth_;
+    mutable mmind::eye::PointCloud pointCloud_;
+    mutable mmind::eye::PointCloudWithNormals pointCloudWithNormals_;
+    mutable mmind::eye::TexturedPointCloud texturedPointCloud_;
+    mutable mmind::eye::TexturedPointCloudWithNormals texturedPointCloudWithNormals_;
+    mutable mmind::eye::PointCloud pointCloudFromDepth_;
+    mutable mmind::eye::PointCloud downsampledPointCloud_;
+    mutable cv::Mat croppedDepth_;
+
+    mutable std::atomic<FrameProductMask> ready_mask_ {0};
+    mutable std::array<std::mutex, static_cast<size_t>(FrameProduct::Count)> product_mutexes_;
 };
+
+/**
+ * @brief 已发布的一帧：不可修改、引用计数共享，最后一个引用释放后帧回到 FramePool
+ */
+using FrameSnapshot = std::shared_ptr<const FrameSet>;
@@ -1,75 +1,507 @@
 #include "InferenceInterface.hpp"
+#include <algorithm>
+#include <nlohmann/json.hpp>
 #include "Logger.hpp"
+#include "utils/ThreadPool.hpp"
 
 InferenceManager &InferenceManager::getInstance() {
   static InferenceManager instance;
   return instance;
 }
 
+InferenceManager::~InferenceManager() { StopAsync(); }
+
+struct InferenceManager::GraphRun {
+  FrameSnapshot frame;
+  std::vector<std::any> outputs;  // Published by each node for this frame
+  std::vector<std::shared_ptr<const InferenceResult>> results;  // Structured result of each node for this frame
+  std::vector<size_t> waiting;    // Inputs of each node that have not finished yet
+  std::vector<bool> skipped;      // An input of the node failed
+  std::vector<size_t> ready;      // Nodes whose inputs have all finished
+  size_t remaining = 0;
+  bool success = true;
+  std::mutex mutex;
+  std::condition_variable cv;
+};
+
+namespace {
+// A result published as the node's graph output belongs to this run by construction. Otherwise the
+// algorithm's latest result is used only if it was produced for this frame: with reentrant workers
+// another frame may have been published in between.
+std::shared_ptr<const InferenceResult> RunResult(const InferenceInterface &algorithm, const std::any &output,
+                                                 const FrameSet &frame) {
+  if (const auto *published = std::any_cast<std::shared_ptr<const InferenceResult>>(&output)) {
+    if (*published) return *published;
+  }
+  auto latest = algorithm.GetLatestResult();
+  if (latest && latest->frame_id == frame.suffix && latest->camera_id == frame.camera_id) {
+    return latest;
+  }
+  return nullptr;
+}
+}  // namespace
+
+const std::any *InferenceContext::FindInput(const std::string &node) const {
+  for (size_t i = 0; i < input_names_.size(); ++i) {
+    if (input_names_[i] == node) {
+      return &outputs_[inputs_[i]];
+    }
+  }
+  return nullptr;
+}
+
 bool InferenceManager::RegisterInference(std::shared_ptr<InferenceInterface> inference_interface) {
   if (!inference_interface) {
     LOG_ERROR_STREAM << "Failed to register inference: null pointer";
     return false;
   }
 
-  inference_interface_ = inference_interface;
-  LOG_INFO_STREAM << "Successfully registered inference: " << inference_interface_->GetAlgorithmName();
+  // Workers must not see the algorithm being replaced under them
+  StopAsync();
+  nodes_.clear();
+  graph_width_ = 0;
+  AddNode(inference_interface->GetAlgorithmName(), inference_interface);
+  LOG_INFO_STREAM << "Successfully registered inference: " << inference_interface->GetAlgorithmName();
+  return true;
+}
+
+bool InferenceManager::AddNode(const std::string &name, std::shared_ptr<InferenceInterface> inference_interface,
+                               const std::vector<std::string> &inputs, const std::string &config_path) {
+  if (!inference_interface || name.empty()) {
+    LOG_ERROR_STREAM << "Failed to add inference node: null algorithm or empty name";
+    return false;
+  }
+  auto find = [this](const std::string &node) {
+    return std::find_if(nodes_.begin(), nodes_.end(), [&node](const Node &n) { return n.name == node; });
+  };
+  if (find(name) != nodes_.end()) {
+    LOG_ERROR_STREAM << "Failed to add inference node: duplicate name " << name;
+    return false;
+  }
+
+  Node node;
+  node.name = name;
+  node.algorithm = std::move(inference_interface);
+  node.config_path = config_path;
+  node.input_names = inputs;
+  for (const auto &input : inputs) {
+    // Inputs must already exist, so every edge points backwards and the graph cannot have a cycle
+    auto it = find(input);
+    if (it == nodes_.end()) {
+      LOG_ERROR_STREAM << "Failed to add inference node " << name << ": unknown input " << input;
+      return false;
+    }
+    node.inputs.push_back(static_cast<size_t>(it - nodes_.begin()));
+    node.depth = std::max(node.depth, it->depth + 1);
+  }
+
+  StopAsync();
+  const size_t index = nodes_.size();
+  for (size_t input : node.inputs) {
+    nodes_[input].outputs.push_back(index);
+  }
+  nodes_.push_back(std::move(node));
+  // A new node has not been initialized yet
+  is_initialized_ = false;
+
+  std::vector<size_t> per_depth;
+  for (const auto &n : nodes_) {
+    per_depth.resize(std::max(per_depth.size(), n.depth + 1));
+    graph_width_ = std::max(graph_width_, ++per_depth[n.depth]);
+  }
+  LOG_DEBUG_STREAM << "Added inference node " << name << " with " << inputs.size() << " input(s)";
   return true;
 }
 
 bool InferenceManager::InitializeInference(const std::string &config_path) {
-  if (!inference_interface_) {
+  if (nodes_.empty()) {
     LOG_ERROR_STREAM << "Failed to initialize inference: no inference interface registered";
     return false;
   }
 
-  if (inference_interface_->Initialize(config_path)) {
-    is_initialized_ = true;
-    LOG_INFO_STREAM << "Successfully initialized inference: " << inference_interface_->GetAlgorithmName();
-    return true;
-  } else {
-    LOG_ERROR_STREAM << "Failed to initialize inference: " << inference_interface_->GetAlgorithmName();
-    return false;
+  for (const auto &node : nodes_) {
+    if (!node.algorithm->Initialize(node.config_path.empty() ? config_path : node.config_path)) {
+      LOG_ERROR_STREAM << "Failed to initialize inference: " << node.name;
+      is_initialized_ = false;
+      return false;
+    }
   }
+  is_initialized_ = true;
+  LOG_INFO_STREAM << "Successfully initialized inference: " << GetCurrentAlgorithmName();
+  return true;
 }
 
 bool InferenceManager::Process(const FrameSet &frame_set) {
-  if (!is_initialized_ || !inference_interface_) {
+  if (!is_initialized_ || nodes_.empty()) {
     LOG_WARNING_STREAM << "Cannot process frame: inference not initialized";
     return false;
   }
 
-  if (inference_interface_->Process(frame_set)) {
-    LOG_DEBUG_STREAM << "Successfully processed frame with inference: " << inference_interface_->GetAlgorithmName();
-    return true;
-  } else {
-    LOG_ERROR_STREAM << "Failed to process frame with inference: " << inference_interface_->GetAlgorithmName();
+  if (nodes_.size() == 1) {
+    return LogProcessResult(nodes_.front().algorithm->Process(frame_set));
+  }
+  // Non-owning snapshot: the caller keeps the frame alive for the duration of the call
+  return LogProcessResult(RunGraph(FrameSnapshot(FrameSnapshot(), &frame_set)));
+}
+
+bool InferenceManager::Process(const FrameSnapshot &frame) {
+  if (!frame) {
+    LOG_WARNING_STREAM << "Cannot process frame: empty snapshot";
     return false;
   }
+  if (!is_initialized_ || nodes_.empty()) {
+    LOG_WARNING_STREAM << "Cannot process frame: inference not initialized";
+    return false;
+  }
+
+  return LogProcessResult(RunGraph(frame));
+}
+
+bool InferenceManager::RunGraph(const FrameSnapshot &frame, std::shared_ptr<const InferenceResult> *result) {
+  GraphRun run;
+  run.frame = frame;
+  run.outputs.resize(nodes_.size());
+  run.results.resize(nodes_.size());
+  if (nodes_.size() == 1) {
+    const bool success = RunNode(0, run);
+    if (result) *result = std::move(run.results.front());
+    return success;
+  }
+
+  run.waiting.resize(nodes_.size());
+  run.skipped.assign(nodes_.size(), false);
+  run.remaining = nodes_.size();
+  for (size_t i = 0; i < nodes_.size(); ++i) {
+    run.waiting[i] = nodes_[i].inputs.size();
+    if (run.waiting[i] == 0) {
+      run.ready.push_back(i);
+    }
+  }
+
+  // Each lane takes ready nodes until the whole graph has finished. The calling thread is a lane too,
+  // so the graph completes even if no pool worker is free, and a chain never leaves the calling thread.
+  auto lane = [this, &run](size_t, size_t) {
+    std::unique_lock<std::mutex> lock(run.mutex);
+    while (true) {
+      run.cv.wait(lock, [&run] { return !run.ready.empty() || run.remaining == 0; });
+      if (run.ready.empty()) return;
+      const size_t index = run.ready.back();
+      run.ready.pop_back();
+      const bool skip = run.skipped[index];
+
+      lock.unlock();
+      bool success = false;
+      if (skip) {
+        LOG_DEBUG_STREAM << "Skipped inference node " << nodes_[index].name << ": an input failed";
+      } else {
+        success = RunNode(index, run);
+      }
+      lock.lock();
+
+      run.success = run.success && success;
+      for (size_t next : nodes_[index].outputs) {
+        run.skipped[next] = run.skipped[next] || !success;
+        if (--run.waiting[next] == 0) {
+          run.ready.push_back(next);
+        }
+      }
+      if (--run.remaining == 0 || !run.ready.empty()) {
+        run.cv.notify_all();
+      }
+    }
+  };
+  const size_t lanes = std::min(graph_width_, ThreadPool::Shared().Size() + 1);
+  ThreadPool::Shared().ParallelFor(0, lanes, 1, lane);
+
+  // Same choice as GetLatestResult(): later nodes consume earlier ones
+  if (result) {
+    auto it = std::find_if(run.results.rbegin(), run.results.rend(),
+                           [](const std::shared_ptr<const InferenceResult> &r) { return r != nullptr; });
+    *result = it != run.results.rend() ? *it : nullptr;
+  }
+  return run.success;
+}
+
+bool InferenceManager::RunNode(size_t index, GraphRun &run) const {
+  const Node &node = nodes_[index];
+  InferenceContext context(node.name, run.frame, node.input_names, node.inputs, run.outputs, run.outputs[index]);
+  try {
+    if (node.algorithm->ProcessNode(context)) {
+      run.results[index] = RunResult(*node.algorithm, run.outputs[index], *run.frame);
+      return true;
+    }
+    LOG_WARNING_STREAM << "Inference node " << node.name << " failed";
+  } catch (const std::exception &e) {
+    LOG_ERROR_STREAM << "Inference node " << node.name << " threw: " << e.what();
+  }
+  return false;
+}
+
+bool InferenceManager::LogProcessResult(bool success) const {
+  if (success) {
+    LOG_DEBUG_STREAM << "Successfully processed frame with inference: " << GetCurrentAlgorithmName();
+  } else {
+    LOG_ERROR_STREAM << "Failed to process frame with inference: " << GetCurrentAlgorithmName();
+  }
+  return success;
 }
 
 std::string InferenceManager::GetResult() const {
-  if (!is_initialized_ || !inference_interface_) {
+  if (!is_initialized_ || nodes_.empty()) {
     return "No inference result available";
   }
-  return inference_interface_->GetResult();
+  if (nodes_.size() == 1) {
+    return nodes_.front().algorithm->GetResult();
+  }
+  nlohmann::json results = nlohmann::json::object();
+  for (const auto &node : nodes_) {
+    results[node.name] = node.algorithm->GetResult();
+  }
+  return results.dump();
+}
+
+std::shared_ptr<const InferenceResult> InferenceManager::GetLatestResult() const {
+  if (!is_initialized_) {
+    return nullptr;
+  }
+  // Later nodes consume earlier ones, so the last node with a result holds the final one
+  for (auto it = nodes_.rbegin(); it != nodes_.rend(); ++it) {
+    if (auto result = it->algorithm->GetLatestResult()) {
+      return result;
+    }
+  }
+  return nullptr;
+}
+
+std::shared_ptr<const InferenceResult> InferenceManager::GetLatestResult(const std::string &node) const {
+  if (!is_initialized_) {
+    return nullptr;
+  }
+  for (const auto &n : nodes_) {
+    if (n.name == node) {
+      return n.algorithm->GetLatestResult();
+    }
+  }
+  return nullptr;
 }
 
 void InferenceManager::Cleanup() {
-  if (inference_interface_) {
-    inference_interface_->Cleanup();
-    LOG_INFO_STREAM << "Cleaned up inference: " << inference_interface_->GetAlgorithmName();
+  StopAsync();
+  for (const auto &node : nodes_) {
+    node.algorithm->Cleanup();
+    LOG_INFO_STREAM << "Cleaned up inference: " << node.name;
   }
   is_initialized_ = false;
 }
 
 bool InferenceManager::IsInitialized() const {
-  return is_initialized_ && inference_interface_ && inference_interface_->IsInitialized();
+  return is_initialized_ && !nodes_.empty() &&
+         std::all_of(nodes_.begin(), nodes_.end(), [](const Node &node) { return node.algorithm->IsInitialized(); });
 }
 
 std::string InferenceManager::GetCurrentAlgorithmName() const {
-  if (inference_interface_) {
-    return inference_interface_->GetAlgorithmName();
+  if (nodes_.empty()) {
+    return "No algorithm registered";
+  }
+  if (nodes_.size() == 1) {
+    return nodes_.front().algorithm->GetAlgorithmName();
+  }
+  std::string names;
+  for (const auto &node : nodes_) {
+    names += (names.empty() ? "" : ", ") + node.name;
+  }
+  return names;
+}
+
+FrameProductMask InferenceManager::GetRequiredProducts() const {
+  if (!is_initialized_) {
+    return kNoFrameProducts;
+  }
+  FrameProductMask products = kNoFrameProducts;
+  for (const auto &node : nodes_) {
+    products |= node.algorithm->GetRequiredProducts();
+  }
+  return products;
+}
+
+bool InferenceManager::RunOnlyOnSceneChange() const {
+  // A node that needs every frame keeps the whole graph running
+  return is_initialized_ && !nodes_.empty() &&
+         std::all_of(nodes_.begin(), nodes_.end(),
+                     [](const Node &node) { return node.algorithm->RunOnlyOnSceneChange(); });
+}
+
+void InferenceManager::SetLatencyHistograms(LatencyHistogram *queue_wait, LatencyHistogram *model) {
+  std::lock_guard<std::mutex> lock(async_mutex_);
+  queue_wait_timer_ = queue_wait;
+  model_timer_ = model;
+}
+
+bool InferenceManager::StartAsync(size_t workers) {
+  if (!is_initialized_ || nodes_.empty()) {
+    LOG_ERROR_STREAM << "Cannot start asynchronous inference: inference not initialized";
+    return false;
+  }
+
+  StopAsync();
+  workers = std::max<size_t>(workers, 1);
+  const bool reentrant =
+      std::all_of(nodes_.begin(), nodes_.end(), [](const Node &node) { return node.algorithm->IsReentrant(); });
+  if (workers > 1 && !reentrant) {
+    LOG_WARNING_STREAM << GetCurrentAlgorithmName()
+                       << " is not reentrant, running asynchronous inference on a single worker";
+    workers = 1;
+  }
+
+  std::lock_guard<std::mutex> lock(async_mutex_);
+  stopping_ = false;
+  async_stats_ = AsyncStats();
+  async_stats_.workers = workers;
+  for (size_t i = 0; i < workers; ++i) {
+    workers_.emplace_back(&InferenceManager::WorkerLoop, this);
+  }
+  LOG_INFO_STREAM << "Asynchronous inference started with " << workers << " worker(s)";
+  return true;
+}
+
+void InferenceManager::StopAsync() {
+  std::vector<std::thread> workers;
+  std::unique_ptr<Request> pending;
+  {
+    std::lock_guard<std::mutex> lock(async_mutex_);
+    if (workers_.empty()) return;
+    stopping_ = true;
+    workers.swap(workers_);
+    pending = std::move(pending_);
+  }
+  async_cv_.notify_all();
+
+  // Frames already being processed finish; the one still waiting is reported as dropped
+  for (auto &worker : workers) {
+    worker.join();
+  }
+  if (pending) {
+    InferenceOutcome outcome;
+    Finish(*pending, outcome);
+  }
+
+  std::lock_guard<std::mutex> lock(async_mutex_);
+  async_stats_.workers = 0;
+  LOG_INFO_STREAM << "Asynchronous inference stopped: completed=" << async_stats_.completed
+                  << ", failed=" << async_stats_.failed << ", dropped=" << async_stats_.dropped << "/"
+                  << async_stats_.submitted;
+}
+
+bool InferenceManager::IsAsync() const {
+  std::lock_guard<std::mutex> lock(async_mutex_);
+  return !workers_.empty();
+}
+
+std::future<InferenceOutcome> InferenceManager::SubmitAsync(const FrameSnapshot &frame, Callback callback) {
+  auto request = std::make_unique<Request>();
+  request->frame = frame;
+  request->callback = std::move(callback);
+  request->submitted = std::chrono::steady_clock::now();
+  std::future<InferenceOutcome> future = request->promise.get_future();
+
+  std::unique_ptr<Request> replaced;
+  {
+    std::lock_guard<std::mutex> lock(async_mutex_);
+    if (frame && !workers_.empty()) {
+      async_stats_.submitted++;
+      replaced = std::move(pending_);
+      pending_ = std::move(request);
+    }
+  }
+
+  if (request) {
+    // Not running (or no frame): reported like a dropped frame so callers waiting on the future never hang
+    LOG_WARNING_STREAM << "Cannot submit frame: asynchronous inference not running";
+    InferenceOutcome outcome;
+    Finish(*request, outcome);
+    return future;
+  }
+
+  async_cv_.notify_one();
+  if (replaced) {
+    InferenceOutcome outcome;
+    Finish(*replaced, outcome);
+  }
+  return future;
+}
+
+InferenceManager::AsyncStats InferenceManager::GetAsyncStats() const {
+  std::lock_guard<std::mutex> lock(async_mutex_);
+  return async_stats_;
+}
+
+void InferenceManager::WorkerLoop() {
+  while (true) {
+    std::unique_ptr<Request> request;
+    {
+      std::unique_lock<std::mutex> lock(async_mutex_);
+      async_cv_.wait(lock, [this] { return stopping_ || pending_; });
+      if (stopping_) break;
+      request = std::move(pending_);
+    }
+
+    InferenceOutcome outcome;
+    const auto start = std::chrono::steady_clock::now();
+    outcome.queue_wait = start - request->submitted;
+    bool success = false;
+    try {
+      success = RunGraph(request->frame, &outcome.result);
+    } catch (const std::exception &e) {
+      LOG_ERROR_STREAM << "Inference threw on frame " << request->frame->suffix << ": " << e.what();
+    }
+    outcome.model_latency = std::chrono::steady_clock::now() - start;
+    outcome.status = success ? InferenceOutcome::Status::Completed : InferenceOutcome::Status::Failed;
+    if (!success) {
+      outcome.result.reset();
+    }
+    LogProcessResult(success);
+    Finish(*request, outcome);
+  }
+}
+
+void InferenceManager::Finish(Request &request, InferenceOutcome &outcome) {
+  if (request.frame) {
+    outcome.frame_id = request.frame->suffix;
+    outcome.camera_id = request.frame->camera_id;
+  }
+
+  // SetLatencyHistograms may swap the histograms while workers run, so they are read under the lock
+  LatencyHistogram *queueWaitTimer = nullptr;
+  LatencyHistogram *modelTimer = nullptr;
+  {
+    std::lock_guard<std::mutex> lock(async_mutex_);
+    queueWaitTimer = queue_wait_timer_;
+    modelTimer = model_timer_;
+    switch (outcome.status) {
+      case InferenceOutcome::Status::Completed:
+        async_stats_.completed++;
+        break;
+      case InferenceOutcome::Status::Failed:
+        async_stats_.failed++;
+        break;
+      case InferenceOutcome::Status::Dropped:
+        if (request.frame) async_stats_.dropped++;
+        break;
+    }
+  }
+  if (outcome.status != InferenceOutcome::Status::Dropped) {
+    if (queueWaitTimer) queueWaitTimer->Record(outcome.queue_wait);
+    if (modelTimer) modelTimer->Record(outcome.model_latency);
+  }
+
+  // The frame goes back to the pool before the callback runs, unless the callback's owner retained it
+  request.frame.reset();
+  if (request.callback) {
+    try {
+      request.callback(outcome);
+    } catch (const std::exception &e) {
+      LOG_ERROR_STREAM << "Inference completion callback threw: " << e.what();
+    }
   }
-  return "No algorithm registered";
+  request.promise.set_value(std::move(outcome));
 }
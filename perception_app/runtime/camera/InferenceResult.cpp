@@ -0,0 +1,310 @@
+#include "InferenceResult.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <sstream>
+
+constexpr char InferenceResult::kMagic[4];
+
+namespace {
+constexpr size_t kHeaderSize = 4 + 2 + 2 + 8;
+constexpr size_t kCountsSize = 3 * 4;
+constexpr size_t kDetectionSize = 6 * 4;
+constexpr size_t kPoseSize = 9 * 4;
+constexpr uint16_t kFlagSuccess = 0x0001;
+
+class Writer {
+public:
+  explicit Writer(uint8_t *cursor) : cursor_(cursor) {}
+
+  void Bytes(const void *data, size_t size) {
+    if (size > 0) {
+      std::memcpy(cursor_, data, size);
+      cursor_ += size;
+    }
+  }
+
+  void U8(uint8_t value) { *cursor_++ = value; }
+  void U16(uint16_t value) { Unsigned(value, 2); }
+  void U32(uint32_t value) { Unsigned(value, 4); }
+  void U64(uint64_t value) { Unsigned(value, 8); }
+  void I32(int32_t value) { U32(static_cast<uint32_t>(value)); }
+
+  void F32(float value) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    U32(bits);
+  }
+
+  void String(const std::string &value) {
+    U16(static_cast<uint16_t>(value.size()));
+    Bytes(value.data(), value.size());
+  }
+
+private:
+  void Unsigned(uint64_t value, size_t bytes) {
+    for (size_t i = 0; i < bytes; ++i) {
+      *cursor_++ = static_cast<uint8_t>((value >> (8 * i)) & 0xFF);
+    }
+  }
+
+  uint8_t *cursor_;
+};
+
+// Every read checks the remaining size; after the first failure all reads fail
+class Reader {
+public:
+  Reader(const uint8_t *data, size_t size) : cursor_(data), end_(data + size) {}
+
+  bool Ok() const { return ok_; }
+  size_t Remaining() const { return static_cast<size_t>(end_ - cursor_); }
+
+  bool Bytes(void *data, size_t size) {
+    const uint8_t *source = cursor_;
+    if (!Take(size)) return false;
+    if (size > 0) {
+      std::memcpy(data, source, size);
+    }
+    return true;
+  }
+
+  uint8_t U8() {
+    const uint8_t *source = cursor_;
+    return Take(1) ? *source : 0;
+  }
+  uint16_t U16() { return static_cast<uint16_t>(Unsigned(2)); }
+  uint32_t U32() { return static_cast<uint32_t>(Unsigned(4)); }
+  uint64_t U64() { return Unsigned(8); }
+  int32_t I32() { return static_cast<int32_t>(U32()); }
+
+  float F32() {
+    const uint32_t bits = U32();
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+  }
+
+  bool String(std::string &value) {
+    const size_t size = U16();
+    const uint8_t *source = cursor_;
+    if (!Take(size)) return false;
+    value.assign(reinterpret_cast<const char *>(source), size);
+    return true;
+  }
+
+private:
+  bool Take(size_t size) {
+    if (!ok_ || Remaining() < size) {
+      ok_ = false;
+      return false;
+    }
+    cursor_ += size;
+    return true;
+  }
+
+  uint64_t Unsigned(size_t bytes) {
+    const uint8_t *source = cursor_;
+    if (!Take(bytes)) return 0;
+    uint64_t value = 0;
+    for (size_t i = 0; i < bytes; ++i) {
+      value |= static_cast<uint64_t>(source[i]) << (8 * i);
+    }
+    return value;
+  }
+
+  const uint8_t *cursor_;
+  const uint8_t *end_;
+  bool ok_ = true;
+};
+
+size_t NameLength(const StageTiming &timing) {
+  const char *end = timing.name + StageTiming::kMaxNameLength;
+  return static_cast<size_t>(std::find(timing.name, end, '\0') - timing.name);
+}
+}  // namespace
+
+void InferenceResult::Clear() {
+  frame_id.clear();
+  camera_id.clear();
+  sequence = 0;
+  success = false;
+  detections.clear();
+  poses.clear();
+  timings.clear();
+}
+
+void InferenceResult::AddTiming(const char *name, std::chrono::steady_clock::duration duration) {
+  timings.emplace_back();
+  StageTiming &timing = timings.back();
+  std::strncpy(timing.name, name, StageTiming::kMaxNameLength);
+  timing.duration_ms = std::chrono::duration<float, std::milli>(duration).count();
+}
+
+size_t InferenceResult::SerializedSize() const {
+  size_t size = kHeaderSize + 2 + frame_id.size() + 2 + camera_id.size() + kCountsSize +
+                detections.size() * kDetectionSize + poses.size() * kPoseSize;
+  for (const auto &timing : timings) {
+    size += 1 + NameLength(timing) + 4;
+  }
+  return size;
+}
+
+bool InferenceResult::Serialize(std::vector<uint8_t> &out) const {
+  if (frame_id.size() > UINT16_MAX || camera_id.size() > UINT16_MAX || detections.size() > UINT32_MAX ||
+      poses.size() > UINT32_MAX || timings.size() > UINT32_MAX) {
+    return false;
+  }
+
+  out.resize(SerializedSize());
+  Writer writer(out.data());
+  writer.Bytes(kMagic, sizeof(kMagic));
+  writer.U16(kVersion);
+  writer.U16(success ? kFlagSuccess : 0);
+  writer.U64(sequence);
+  writer.String(frame_id);
+  writer.String(camera_id);
+  writer.U32(static_cast<uint32_t>(detections.size()));
+  writer.U32(static_cast<uint32_t>(poses.size()));
+  writer.U32(static_cast<uint32_t>(timings.size()));
+
+  for (const auto &detection : detections) {
+    writer.I32(detection.class_id);
+    writer.F32(detection.score);
+    writer.F32(detection.x);
+    writer.F32(detection.y);
+    writer.F32(detection.width);
+    writer.F32(detection.height);
+  }
+  for (const auto &pose : poses) {
+    writer.I32(pose.class_id);
+    writer.F32(pose.score);
+    for (float value : pose.position_mm) writer.F32(value);
+    for (float value : pose.rotation) writer.F32(value);
+  }
+  for (const auto &timing : timings) {
+    const size_t length = NameLength(timing);
+    writer.U8(static_cast<uint8_t>(length));
+    writer.Bytes(timing.name, length);
+    writer.F32(timing.duration_ms);
+  }
+  return true;
+}
+
+bool InferenceResult::Deserialize(const std::vector<uint8_t> &data, InferenceResult &result) {
+  return Deserialize(data.data(), data.size(), result);
+}
+
+bool InferenceResult::Deserialize(const uint8_t *data, size_t size, InferenceResult &result) {
+  if (data == nullptr) return false;
+
+  Reader reader(data, size);
+  char magic[4];
+  if (!reader.Bytes(magic, sizeof(magic)) || std::memcmp(magic, kMagic, sizeof(magic)) != 0 ||
+      reader.U16() != kVersion) {
+    return false;
+  }
+
+  result.Clear();
+  result.success = (reader.U16() & kFlagSuccess) != 0;
+  result.sequence = reader.U64();
+  reader.String(result.frame_id);
+  reader.String(result.camera_id);
+  const size_t detectionCount = reader.U32();
+  const size_t poseCount = reader.U32();
+  const size_t timingCount = reader.U32();
+  // Reject counts the remaining bytes cannot hold before resizing anything
+  if (!reader.Ok() || reader.Remaining() / kDetectionSize < detectionCount ||
+      (reader.Remaining() - detectionCount * kDetectionSize) / kPoseSize < poseCount ||
+      (reader.Remaining() - detectionCount * kDetectionSize - poseCount * kPoseSize) / 5 < timingCount) {
+    return false;
+  }
+
+  result.detections.resize(detectionCount);
+  for (auto &detection : result.detections) {
+    detection.class_id = reader.I32();
+    detection.score = reader.F32();
+    detection.x = reader.F32();
+    detection.y = reader.F32();
+    detection.width = reader.F32();
+    detection.height = reader.F32();
+  }
+  result.poses.resize(poseCount);
+  for (auto &pose : result.poses) {
+    pose.class_id = reader.I32();
+    pose.score = reader.F32();
+    for (float &value : pose.position_mm) value = reader.F32();
+    for (float &value : pose.rotation) value = reader.F32();
+  }
+  result.timings.resize(timingCount);
+  for (auto &timing : result.timings) {
+    const size_t length = reader.U8();
+    if (length > StageTiming::kMaxNameLength || !reader.Bytes(timing.name, length)) {
+      return false;
+    }
+    timing.name[length] = '\0';
+    timing.duration_ms = reader.F32();
+  }
+  return reader.Ok();
+}
+
+std::string InferenceResult::ToString() const {
+  std::ostringstream stream;
+  stream << "Frame " << sequence;
+  if (!frame_id.empty()) {
+    stream << " (" << frame_id << ")";
+  }
+  stream << (success ? " processed: " : " failed: ") << detections.size() << " detections, " << poses.size()
+         << " poses";
+  for (const auto &detection : detections) {
+    stream << "; class " << detection.class_id << " score " << detection.score << " box [" << detection.x << ","
+           << detection.y << "," << detection.width << "," << detection.height << "]";
+  }
+  for (const auto &pose : poses) {
+    stream << "; class " << pose.class_id << " score " << pose.score << " at [" << pose.position_mm[0] << ","
+           << pose.position_mm[1] << "," << pose.position_mm[2] << "] mm";
+  }
+  for (const auto &timing : timings) {
+    stream << "; " << timing.name << " " << timing.duration_ms << " ms";
+  }
+  return stream.str();
+}
+
+InferenceResult &InferenceResultBuffer::Acquire() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (!writing_) {
+    // Only this buffer still refers to a free object: it is neither published nor held by a reader
+    auto it = std::find_if(results_.begin(), results_.end(),
+                           [](const std::shared_ptr<InferenceResult> &result) { return result.use_count() == 1; });
+    if (it != results_.end()) {
+      // use_count() is a relaxed load; pair it with the readers' release decrement so their last reads of
+      // the object happen before it is cleared and rewritten
+      std::atomic_thread_fence(std::memory_order_acquire);
+      writing_ = *it;
+    } else {
+      writing_ = std::make_shared<InferenceResult>();
+      results_.push_back(writing_);
+    }
+  }
+  // Also cleared when re-acquired, so a frame abandoned before Publish leaves nothing behind
+  writing_->Clear();
+  return *writing_;
+}
+
+void InferenceResultBuffer::Publish() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (writing_) {
+    latest_ = std::move(writing_);
+    writing_.reset();
+  }
+}
+
+std::shared_ptr<const InferenceResult> InferenceResultBuffer::Latest() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return latest_;
+}
+
+void InferenceResultBuffer::Reset() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  latest_.reset();
+  writing_.reset();
+}
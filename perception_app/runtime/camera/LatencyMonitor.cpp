@@ -0,0 +1,112 @@
+#include "LatencyMonitor.hpp"
+#include <iomanip>
+#include <sstream>
+#include "Logger.hpp"
+
+namespace {
+std::string FormatSummary(const std::string &name, const LatencyHistogram::Summary &summary) {
+  std::ostringstream out;
+  out << std::fixed << std::setprecision(2) << "Latency [" << name << "]: n=" << summary.count
+      << ", fps=" << summary.fps << ", p50=" << summary.p50_ms << " ms, p95=" << summary.p95_ms
+      << " ms, p99=" << summary.p99_ms << " ms, max=" << summary.max_ms << " ms";
+  return out.str();
+}
+}  // namespace
+
+LatencyMonitor::LatencyMonitor(std::chrono::milliseconds report_interval)
+    : report_interval_(report_interval), created_(std::chrono::steady_clock::now()), last_rotate_(created_) {}
+
+LatencyMonitor::~LatencyMonitor() { Stop(); }
+
+LatencyHistogram *LatencyMonitor::Register(const std::string &name) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (auto &stage : stages_) {
+    if (stage->name == name) {
+      return stage->histogram.get();
+    }
+  }
+
+  auto stage = std::make_unique<Stage>();
+  stage->name = name;
+  stage->histogram = std::make_unique<LatencyHistogram>();
+  stages_.push_back(std::move(stage));
+  return stages_.back()->histogram.get();
+}
+
+bool LatencyMonitor::Start() {
+  std::lock_guard<std::mutex> lock(reporter_mutex_);
+  if (running_ || report_interval_.count() <= 0) {
+    return true;
+  }
+
+  running_ = true;
+  reporter_ = std::thread(&LatencyMonitor::ReportLoop, this);
+  LOG_INFO_STREAM << "Latency monitor reporting every " << report_interval_.count() << " ms";
+  return true;
+}
+
+void LatencyMonitor::Stop() {
+  {
+    std::lock_guard<std::mutex> lock(reporter_mutex_);
+    if (!running_) {
+      return;
+    }
+    running_ = false;
+  }
+  reporter_cv_.notify_all();
+  if (reporter_.joinable()) {
+    reporter_.join();
+  }
+}
+
+std::vector<LatencyMonitor::StageReport> LatencyMonitor::GetReport() const {
+  const double uptime = std::chrono::duration<double>(std::chrono::steady_clock::now() - created_).count();
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::vector<StageReport> report;
+  report.reserve(stages_.size());
+  for (const auto &stage : stages_) {
+    StageReport entry;
+    entry.name = stage->name;
+    entry.total = stage->histogram->GetSnapshot().Summarize(uptime);
+    entry.recent = stage->recent;
+    report.push_back(entry);
+  }
+  return report;
+}
+
+void LatencyMonitor::LogTotals() const {
+  for (const auto &entry : GetReport()) {
+    if (entry.total.count > 0) {
+      LOG_INFO_STREAM << FormatSummary(entry.name, entry.total);
+    }
+  }
+}
+
+void LatencyMonitor::ReportLoop() {
+  std::unique_lock<std::mutex> lock(reporter_mutex_);
+  while (running_) {
+    if (reporter_cv_.wait_for(lock, report_interval_, [this] { return !running_; })) {
+      break;
+    }
+    lock.unlock();
+    Rotate();
+    lock.lock();
+  }
+}
+
+void LatencyMonitor::Rotate() {
+  const auto now = std::chrono::steady_clock::now();
+  const double seconds = std::chrono::duration<double>(now - last_rotate_).count();
+  last_rotate_ = now;
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (auto &stage : stages_) {
+    LatencyHistogram::Snapshot current = stage->histogram->GetSnapshot();
+    stage->recent = current.Since(stage->last).Summarize(seconds);
+    stage->last = current;
+    if (stage->recent.count > 0) {
+      LOG_INFO_STREAM << FormatSummary(stage->name, stage->recent);
+    }
+  }
+}
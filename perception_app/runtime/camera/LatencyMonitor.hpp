@@ -0,0 +1,96 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "utils/LatencyHistogram.hpp"
+
+/**
+ * @brief 分阶段延迟统计
+ *
+ * 每个阶段（采集、解码及其子步骤、推理、保存、显示等）对应一个无锁延迟直方图，
+ * 计时点只做原子累加。后台报告线程按固定周期对所有直方图取快照，计算该周期内的
+ * p50 / p95 / p99 / max 和帧率并写日志；同样的数据也可以通过 GetReport 随时查询，
+ * 用于对比 SDK 或配置变更前后的性能。
+ */
+class LatencyMonitor
+{
+public:
+    /**
+     * @brief 单个阶段的延迟报告
+     */
+    struct StageReport
+    {
+        std::string name;
+        LatencyHistogram::Summary total;   // 自启动以来
+        LatencyHistogram::Summary recent;  // 最近一个完整的报告周期
+    };
+
+    /**
+     * @param report_interval 周期报告间隔，0 表示不周期性输出日志（仍可查询）
+     */
+    explicit LatencyMonitor(std::chrono::milliseconds report_interval);
+    ~LatencyMonitor();
+
+    LatencyMonitor(const LatencyMonitor&) = delete;
+    LatencyMonitor& operator=(const LatencyMonitor&) = delete;
+
+    /**
+     * @brief 注册阶段，同名阶段返回已有的直方图
+     * @return 直方图指针，在 LatencyMonitor 生命周期内有效，计时路径应缓存该指针
+     */
+    LatencyHistogram* Register(const std::string& name);
+
+    /**
+     * @brief 启动周期报告线程
+     */
+    bool Start();
+
+    /**
+     * @brief 停止周期报告线程
+     */
+    void Stop();
+
+    /**
+     * @brief 获取所有阶段的延迟报告，按注册顺序排列
+     */
+    std::vector<StageReport> GetReport() const;
+
+    /**
+     * @brief 将自启动以来的累计统计写入日志，跳过没有样本的阶段
+     */
+    void LogTotals() const;
+
+private:
+    struct Stage
+    {
+        std::string name;
+        std::unique_ptr<LatencyHistogram> histogram;
+        LatencyHistogram::Snapshot last;  // 上一个周期结束时的快照
+        LatencyHistogram::Summary recent;
+    };
+
+    void ReportLoop();
+
+    /**
+     * @brief 结束当前周期：计算各阶段增量并输出日志
+     */
+    void Rotate();
+
+private:
+    const std::chrono::milliseconds report_interval_;
+    const std::chrono::steady_clock::time_point created_;
+    std::chrono::steady_clock::time_point last_rotate_;
+
+    mutable std::mutex mutex_;
+    std::vector<std::unique_ptr<Stage>> stages_;
+
+    std::thread reporter_;
+    std::mutex reporter_mutex_;
+    std::condition_variable reporter_cv_;
+    bool running_ = false;
+};
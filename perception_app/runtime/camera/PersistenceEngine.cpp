@@ -0,0 +1,191 @@
+#include "PersistenceEngine.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include "Logger.hpp"
+
+namespace {
+uint64_t FileSize(const std::string &path) {
+  struct stat st = {};
+  if (stat(path.c_str(), &st) != 0) {
+    return 0;
+  }
+  return static_cast<uint64_t>(st.st_size);
+}
+}  // namespace
+
+PersistenceEngine::PersistenceEngine(size_t num_writers, size_t queue_capacity, OverflowPolicy policy)
+    : num_writers_(num_writers), queue_(queue_capacity, policy) {}
+
+PersistenceEngine::~PersistenceEngine() { Stop(); }
+
+bool PersistenceEngine::Start() {
+  if (running_) {
+    return true;
+  }
+
+  // Stop() closed the queue; reopen it so a restarted engine accepts jobs again
+  queue_.Reopen();
+  running_ = true;
+  writers_.reserve(num_writers_);
+  for (size_t i = 0; i < num_writers_; ++i) {
+    writers_.emplace_back(&PersistenceEngine::WriterLoop, this);
+  }
+  if (num_writers_ == 0) {
+    LOG_INFO_STREAM << "Persistence engine started in synchronous mode";
+  } else {
+    LOG_INFO_STREAM << "Persistence engine started with " << num_writers_ << " writers, queue capacity "
+                    << queue_.Capacity() << ", overflow policy " << OverflowPolicyToString(queue_.Policy());
+  }
+  return true;
+}
+
+void PersistenceEngine::Stop() {
+  if (!running_) {
+    return;
+  }
+  running_ = false;
+
+  // Writers drain whatever is already queued before exiting
+  queue_.Close();
+  for (auto &writer : writers_) {
+    if (writer.joinable()) {
+      writer.join();
+    }
+  }
+  writers_.clear();
+
+  Stats stats = GetStats();
+  LOG_INFO_STREAM << "Persistence engine stopped: jobs=" << stats.completed_jobs << "/" << stats.submitted_jobs
+                  << ", dropped=" << stats.dropped_jobs << ", files=" << stats.files_written
+                  << ", failed=" << stats.files_failed << ", avg latency=" << stats.avg_file_latency_ms
+                  << " ms, max latency=" << stats.max_file_latency_ms
+                  << " ms, throughput=" << stats.bytes_per_sec / (1024.0 * 1024.0) << " MB/s";
+}
+
+bool PersistenceEngine::Submit(Job job) {
+  if (!running_) {
+    return false;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    stats_.submitted_jobs++;
+  }
+  if (num_writers_ == 0) {
+    RunJob(job);
+    return true;
+  }
+
+  // With several submitters the drop counter may also move for a concurrent push; it only selects the message
+  const uint64_t droppedBefore = queue_.Dropped();
+  bool accepted = queue_.Push(std::move(job));
+  if (!accepted) {
+    if (queue_.IsClosed()) {
+      LOG_WARNING_STREAM << "Persistence queue closed, rejecting job";
+    } else {
+      LOG_WARNING_STREAM << "Persistence queue full, dropping newest job";
+    }
+  } else if (queue_.Policy() == OverflowPolicy::DropOldest && queue_.Dropped() > droppedBefore) {
+    LOG_WARNING_STREAM << "Persistence queue full, dropping oldest job";
+  }
+  return accepted;
+}
+
+PersistenceEngine::Stats PersistenceEngine::GetStats() const {
+  Stats stats;
+  {
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    stats = stats_;
+    const uint64_t files = stats_.files_written + stats_.files_failed;
+    stats.avg_file_latency_ms = files > 0 ? total_write_ms_ / files : 0.0;
+    stats.bytes_per_sec = total_write_ms_ > 0.0 ? stats_.bytes_written * 1000.0 / total_write_ms_ : 0.0;
+  }
+  stats.dropped_jobs = queue_.Dropped();
+  stats.queue_depth = queue_.Size();
+  stats.queue_capacity = queue_.Capacity();
+  stats.queue_high_water = queue_.HighWaterMark();
+  return stats;
+}
+
+bool PersistenceEngine::EnsureDirectory(const std::string &path) {
+  if (path.empty()) {
+    return false;
+  }
+
+  struct stat st = {};
+  if (stat(path.c_str(), &st) == 0) {
+    return S_ISDIR(st.st_mode);
+  }
+
+  // Create every missing component, tolerating races with other creators
+  for (size_t pos = path.find('/', 1); ; pos = path.find('/', pos + 1)) {
+    const std::string partial = path.substr(0, pos);
+    if (!partial.empty() && mkdir(partial.c_str(), 0755) != 0 && errno != EEXIST) {
+      LOG_ERROR_STREAM << "Failed to create directory: " << partial;
+      return false;
+    }
+    if (pos == std::string::npos) {
+      break;
+    }
+  }
+  LOG_INFO_STREAM << "Created directory: " << path;
+  return true;
+}
+
+void PersistenceEngine::WriterLoop() {
+  Job job;
+  while (queue_.Pop(job)) {
+    RunJob(job);
+    job = Job();
+  }
+}
+
+void PersistenceEngine::RunJob(Job &job) {
+  std::vector<std::string> written;
+  written.reserve(job.files.size());
+
+  for (auto &file : job.files) {
+    auto start = std::chrono::steady_clock::now();
+    bool ok = false;
+    try {
+      ok = file.write && file.write(file.path);
+    } catch (const std::exception &e) {
+      LOG_ERROR_STREAM << "Exception while writing " << file.path << ": " << e.what();
+    }
+    const double latency_ms =
+        std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    const uint64_t bytes = ok ? FileSize(file.path) : 0;
+
+    if (ok) {
+      written.push_back(file.path);
+      LOG_DEBUG_STREAM << "Saved " << file.path << ": " << bytes << " bytes in " << latency_ms << " ms ("
+                       << (latency_ms > 0.0 ? bytes * 1000.0 / latency_ms / (1024.0 * 1024.0) : 0.0) << " MB/s)";
+    } else {
+      LOG_ERROR_STREAM << "Failed to save " << file.path;
+    }
+
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    if (ok) {
+      stats_.files_written++;
+      stats_.bytes_written += bytes;
+    } else {
+      stats_.files_failed++;
+    }
+    total_write_ms_ += latency_ms;
+    stats_.max_file_latency_ms = std::max(stats_.max_file_latency_ms, latency_ms);
+  }
+
+  if (job.on_complete) {
+    try {
+      job.on_complete(written);
+    } catch (const std::exception &e) {
+      LOG_ERROR_STREAM << "Persistence completion callback for '" << job.tag << "' failed: " << e.what();
+    }
+  }
+
+  std::lock_guard<std::mutex> lock(stats_mutex_);
+  stats_.completed_jobs++;
+}
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "utils/BoundedQueue.hpp"
+
+/**
+ * @brief 异步落盘引擎
+ *
+ * 采集 / 流水线线程只负责提交写盘任务，由独立的写线程池执行实际的文件写入，
+ * 采集帧率不再受磁盘速度影响。任务队列有界，磁盘跟不上时按 OverflowPolicy
+ * 阻塞、丢弃最旧或丢弃最新的任务。一个任务对应一帧的若干文件，由同一个写线程
+ * 依次写出，全部写完后回调通知实际写成功的文件列表。
+ */
+class PersistenceEngine
+{
+public:
+    /**
+     * @brief 单个文件的写入操作
+     */
+    struct FileTask
+    {
+        std::string path;                                    // 目标文件路径
+        std::function<bool(const std::string& path)> write;  // 写入函数，返回是否成功
+    };
+
+    /**
+     * @brief 一次提交的写盘任务（通常对应一帧）
+     */
+    struct Job
+    {
+        std::string tag;              // 任务标识，用于日志
+        std::vector<FileTask> files;  // 待写文件
+        // 写完回调，在写线程中调用，参数为写入成功的文件
+        std::function<void(const std::vector<std::string>& written)> on_complete;
+    };
+
+    /**
+     * @brief 落盘统计
+     */
+    struct Stats
+    {
+        uint64_t submitted_jobs = 0;    // 已提交任务数
+        uint64_t completed_jobs = 0;    // 已完成任务数
+        uint64_t dropped_jobs = 0;      // 队列溢出丢弃的任务数
+        uint64_t files_written = 0;     // 写入成功的文件数
+        uint64_t files_failed = 0;      // 写入失败的文件数
+        uint64_t bytes_written = 0;     // 写入总字节数
+        double avg_file_latency_ms = 0.0;  // 单文件平均写入耗时
+        double max_file_latency_ms = 0.0;  // 单文件最大写入耗时
+        double bytes_per_sec = 0.0;        // 写入吞吐（总字节 / 总写入耗时）
+        size_t queue_depth = 0;            // 当前队列深度
+        size_t queue_capacity = 0;         // 队列容量
+        size_t queue_high_water = 0;       // 队列历史最大深度
+    };
+
+    /**
+     * @param num_writers 写线程数，0 表示在提交线程中同步写入
+     * @param queue_capacity 任务队列容量
+     * @param policy 队列满时的处理策略
+     */
+    PersistenceEngine(size_t num_writers, size_t queue_capacity, OverflowPolicy policy);
+    ~PersistenceEngine();
+
+    PersistenceEngine(const PersistenceEngine&) = delete;
+    PersistenceEngine& operator=(const PersistenceEngine&) = delete;
+
+    /**
+     * @brief 启动写线程
+     */
+    bool Start();
+
+    /**
+     * @brief 停止接收新任务，写完队列中剩余任务后退出
+     */
+    void Stop();
+
+    /**
+     * @brief 提交写盘任务
+     * @return true 任务已入队，false 任务被丢弃或引擎未运行
+     */
+    bool Submit(Job job);
+
+    /**
+     * @brief 获取落盘统计
+     */
+    Stats GetStats() const;
+
+    bool IsRunning() const { return running_; }
+
+    /**
+     * @brief 确保目录存在，不存在时逐级创建
+     */
+    static bool EnsureDirectory(const std::string& path);
+
+private:
+    void WriterLoop();
+
+    void RunJob(Job& job);
+
+private:
+    const size_t num_writers_;
+    BoundedQueue<Job> queue_;
+    std::vector<std::thread> writers_;
+    std::atomic<bool> running_ {false};
+
+    mutable std::mutex stats_mutex_;
+    Stats stats_;
+    double total_write_ms_ = 0.0;
+};
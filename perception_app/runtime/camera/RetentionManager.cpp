@@ -0,0 +1,244 @@
+#include "RetentionManager.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <dirent.h>
+#include <map>
+#include <sys/stat.h>
+#include <sys/statvfs.h>
+#include "Logger.hpp"
+
+namespace {
+// File name endings written by CameraManager::SaveImages (see SaveConfig::save_*_file). The textured
+// point cloud comes before the plain one because it shares its ending.
+const char *const kSavedFileEndings[] = {"_2DImage.png",           "_DepthMap.tiff",  "_DepthMap.mdc",
+                                         "_TexturedPointCloud.ply", "_PointCloud.ply", "_Frame.mfc"};
+
+// Disk usage changes behind our back too (logs, other tools), so headroom is re-checked periodically
+constexpr auto kDiskCheckInterval = std::chrono::seconds(1);
+
+bool EndsWith(const std::string &value, const std::string &ending) {
+  return value.size() >= ending.size() && value.compare(value.size() - ending.size(), ending.size(), ending) == 0;
+}
+
+double ToMB(uint64_t bytes) { return bytes / (1024.0 * 1024.0); }
+}  // namespace
+
+RetentionManager::RetentionManager(const Config &config) : config_(config) {}
+
+RetentionManager::~RetentionManager() { Stop(); }
+
+bool RetentionManager::Start() {
+  if (running_) return true;
+
+  ScanDirectory();
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    LOG_INFO_STREAM << "Retention: " << stats_.frames << " saved frames (" << ToMB(stats_.bytes) << " MB) in "
+                    << config_.directory;
+  }
+
+  running_ = true;
+  worker_ = std::thread(&RetentionManager::WorkerLoop, this);
+  return true;
+}
+
+void RetentionManager::Stop() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!running_) return;
+    running_ = false;
+  }
+  cv_.notify_all();
+  if (worker_.joinable()) {
+    worker_.join();
+  }
+}
+
+void RetentionManager::Add(std::vector<std::string> files) {
+  if (files.empty()) return;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    incoming_.push_back(std::move(files));
+    stats_.pending = incoming_.size();
+  }
+  cv_.notify_one();
+}
+
+RetentionManager::Stats RetentionManager::GetStats() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return stats_;
+}
+
+void RetentionManager::ScanDirectory() {
+  DIR *dir = opendir(config_.directory.c_str());
+  if (dir == nullptr) {
+    return;
+  }
+
+  struct Scanned
+  {
+    Group group;
+    time_t mtime = 0;
+    std::string key;
+  };
+  std::map<std::string, Scanned> frames;
+
+  const std::string directory = config_.directory + "/";
+  for (dirent *item = readdir(dir); item != nullptr; item = readdir(dir)) {
+    const std::string name = item->d_name;
+    const char *const *ending =
+        std::find_if(std::begin(kSavedFileEndings), std::end(kSavedFileEndings),
+                     [&name](const char *candidate) { return EndsWith(name, candidate); });
+    if (ending == std::end(kSavedFileEndings)) continue;
+
+    const std::string path = directory + name;
+    struct stat st = {};
+    if (stat(path.c_str(), &st) != 0 || !S_ISREG(st.st_mode)) continue;
+
+    const std::string key = name.substr(0, name.size() - std::string(*ending).size());
+    Scanned &scanned = frames[key];
+    scanned.key = key;
+    scanned.group.files.push_back(path);
+    scanned.group.bytes += static_cast<uint64_t>(st.st_size);
+    scanned.mtime = std::max(scanned.mtime, st.st_mtime);
+  }
+  closedir(dir);
+
+  std::vector<Scanned> ordered;
+  ordered.reserve(frames.size());
+  for (auto &item : frames) {
+    ordered.push_back(std::move(item.second));
+  }
+  std::sort(ordered.begin(), ordered.end(), [](const Scanned &a, const Scanned &b) {
+    return a.mtime != b.mtime ? a.mtime < b.mtime : a.key < b.key;
+  });
+
+  uint64_t bytes = 0;
+  for (auto &scanned : ordered) {
+    bytes += scanned.group.bytes;
+    groups_.push_back(std::move(scanned.group));
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  stats_.frames = groups_.size();
+  stats_.bytes = bytes;
+}
+
+void RetentionManager::WorkerLoop() {
+  while (true) {
+    RefreshDiskSpace();
+    Enforce();
+
+    std::deque<std::vector<std::string>> batch;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      cv_.wait_for(lock, kDiskCheckInterval, [this] { return !incoming_.empty() || !running_; });
+      if (incoming_.empty() && !running_) break;
+      batch.swap(incoming_);
+      stats_.pending = 0;
+    }
+
+    // Sizes are taken here rather than in Add so the writer threads never stat
+    uint64_t added = 0;
+    for (auto &files : batch) {
+      Group group;
+      for (const auto &file : files) {
+        group.bytes += FileSize(file);
+      }
+      group.files = std::move(files);
+      added += group.bytes;
+      groups_.push_back(std::move(group));
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats_.frames = groups_.size();
+    stats_.bytes += added;
+  }
+}
+
+void RetentionManager::Enforce() {
+  uint64_t bytes = 0;
+  uint64_t free_bytes = 0;
+  bool check_free = false;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    bytes = stats_.bytes;
+    free_bytes = stats_.free_bytes;
+    // No statvfs result yet (e.g. the directory does not exist) means nothing to check against
+    check_free = config_.min_free_bytes > 0 && stats_.total_bytes > 0;
+  }
+
+  size_t deleted_frames = 0;
+  uint64_t deleted_files = 0;
+  uint64_t deleted_bytes = 0;
+  uint64_t failed = 0;
+  while (!groups_.empty()) {
+    const bool over_count = config_.max_frames > 0 && groups_.size() > config_.max_frames;
+    const bool over_bytes = config_.max_bytes > 0 && bytes > config_.max_bytes;
+    const bool low_space = check_free && free_bytes < config_.min_free_bytes;
+    if (!over_count && !over_bytes && !low_space) break;
+
+    Group &oldest = groups_.front();
+    for (const auto &file : oldest.files) {
+      if (std::remove(file.c_str()) == 0) {
+        deleted_files++;
+      } else {
+        failed++;
+      }
+    }
+    bytes -= std::min(bytes, oldest.bytes);
+    free_bytes += oldest.bytes;
+    deleted_bytes += oldest.bytes;
+    deleted_frames++;
+    groups_.pop_front();
+  }
+
+  if (deleted_frames > 0) {
+    LOG_DEBUG_STREAM << "Retention: removed " << deleted_frames << " old frames (" << ToMB(deleted_bytes)
+                     << " MB), " << groups_.size() << " frames kept";
+    if (check_free) {
+      RefreshDiskSpace();
+      std::lock_guard<std::mutex> lock(mutex_);
+      free_bytes = stats_.free_bytes;
+    }
+  }
+
+  const bool headroom = !check_free || free_bytes >= config_.min_free_bytes;
+  if (has_headroom_.exchange(headroom) != headroom) {
+    if (headroom) {
+      LOG_INFO_STREAM << "Retention: free space recovered (" << ToMB(free_bytes) << " MB)";
+    } else {
+      LOG_WARNING_STREAM << "Retention: only " << ToMB(free_bytes) << " MB free on " << config_.directory
+                         << " with nothing left to delete, pausing saving";
+    }
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  stats_.frames = groups_.size();
+  stats_.bytes = bytes;
+  stats_.deleted_frames += deleted_frames;
+  stats_.deleted_files += deleted_files;
+  stats_.deleted_bytes += deleted_bytes;
+  stats_.failed_deletes += failed;
+  stats_.has_headroom = headroom;
+}
+
+void RetentionManager::RefreshDiskSpace() {
+  struct statvfs vfs = {};
+  if (statvfs(config_.directory.c_str(), &vfs) != 0) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  // f_bavail is what unprivileged writers can actually use
+  stats_.free_bytes = static_cast<uint64_t>(vfs.f_bavail) * vfs.f_frsize;
+  stats_.total_bytes = static_cast<uint64_t>(vfs.f_blocks) * vfs.f_frsize;
+}
+
+uint64_t RetentionManager::FileSize(const std::string &path) {
+  struct stat st = {};
+  if (stat(path.c_str(), &st) != 0) {
+    return 0;
+  }
+  return static_cast<uint64_t>(st.st_size);
+}
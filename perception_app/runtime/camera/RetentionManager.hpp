@@ -0,0 +1,108 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief 保存目录的配额与保留管理
+ *
+ * 以帧为单位（同一帧的图像、深度图、点云等文件为一组）管理保存目录：启动时扫描目录中已有的
+ * 保存文件并按修改时间排序，之后由落盘引擎在每帧写完后登记新文件。后台线程按帧数配额、
+ * 字节配额和磁盘最小剩余空间依次删除最旧的帧，登记和查询都不会阻塞在文件删除上。
+ *
+ * 只管理文件名符合 SaveConfig::save_*_file 格式的文件，子目录（如事件记录目录）和其他文件不受影响。
+ * 重启后配额仍然生效，崩溃前留下的旧文件会在下次启动时被回收。
+ */
+class RetentionManager
+{
+public:
+    struct Config
+    {
+        std::string directory = "./dumps/";
+        size_t max_frames = 0;          // 最多保留的帧数，0 表示不限制
+        uint64_t max_bytes = 0;         // 最多占用的字节数，0 表示不限制
+        uint64_t min_free_bytes = 0;    // 磁盘最小剩余空间，低于时删除最旧的帧，0 表示不检查
+    };
+
+    struct Stats
+    {
+        size_t frames = 0;              // 当前保留的帧数
+        uint64_t bytes = 0;             // 当前保留的字节数
+        uint64_t deleted_frames = 0;    // 累计删除的帧数
+        uint64_t deleted_files = 0;     // 累计删除的文件数
+        uint64_t deleted_bytes = 0;     // 累计释放的字节数
+        uint64_t failed_deletes = 0;    // 删除失败的文件数
+        uint64_t free_bytes = 0;        // 磁盘剩余空间（最近一次检查）
+        uint64_t total_bytes = 0;       // 磁盘总空间
+        size_t pending = 0;             // 已登记、尚未处理的帧数
+        bool has_headroom = true;       // 剩余空间是否满足 min_free_bytes
+    };
+
+    explicit RetentionManager(const Config& config);
+    ~RetentionManager();
+
+    RetentionManager(const RetentionManager&) = delete;
+    RetentionManager& operator=(const RetentionManager&) = delete;
+
+    /**
+     * @brief 扫描目录中已有的保存文件并启动后台线程
+     *
+     * 扫描在调用线程中完成，应在开始采集前调用。目录不存在时视为空目录。
+     */
+    bool Start();
+
+    /**
+     * @brief 处理完已登记的帧后停止后台线程
+     */
+    void Stop();
+
+    /**
+     * @brief 登记新写入的一帧文件，立即返回
+     */
+    void Add(std::vector<std::string> files);
+
+    /**
+     * @brief 剩余空间是否满足 min_free_bytes（已删除所有可删除的帧仍不足时为 false）
+     */
+    bool HasHeadroom() const { return has_headroom_.load(std::memory_order_relaxed); }
+
+    Stats GetStats() const;
+
+private:
+    struct Group
+    {
+        std::vector<std::string> files;
+        uint64_t bytes = 0;
+    };
+
+    void ScanDirectory();
+
+    void WorkerLoop();
+
+    /**
+     * @brief 删除最旧的帧直到满足配额，在后台线程中调用
+     */
+    void Enforce();
+
+    void RefreshDiskSpace();
+
+    static uint64_t FileSize(const std::string& path);
+
+private:
+    const Config config_;
+    std::thread worker_;
+    std::atomic<bool> running_ {false};
+    std::atomic<bool> has_headroom_ {true};
+
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<std::vector<std::string>> incoming_;  // 待后台线程统计大小的新帧
+    std::deque<Group> groups_;                       // 已保留的帧，最旧的在前；只由后台线程修改
+    Stats stats_;
+};
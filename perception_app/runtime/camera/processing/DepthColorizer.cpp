@@ -0,0 +1,260 @@
+#include "DepthColorizer.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <vector>
+#include <opencv2/imgproc.hpp>
+#include "utils/SimdSupport.hpp"
+#include "utils/ThreadPool.hpp"
+
+namespace {
+constexpr size_t kRowsPerTask = 16;
+
+// Valid pixels map to [1, 255]; index 0 is reserved for invalid (NaN) depth
+constexpr float kMinIndex = 1.0f;
+constexpr float kMaxIndex = 255.0f;
+
+inline int ScalarIndex(float z, float scale, float offset) {
+  if (z != z) return 0;
+  return static_cast<int>(std::min(std::max(std::nearbyint(z * scale + offset), kMinIndex), kMaxIndex));
+}
+
+inline void WriteColor(const uint8_t *lut, int index, uint8_t *bgr) { std::memcpy(bgr, lut + index * 3, 3); }
+
+#if defined(PERCEPTION_SIMD_X86)
+PERCEPTION_TARGET_AVX2 void MinMaxRowAvx2(const float *depth, size_t width, float &minValue, float &maxValue) {
+  // min/max return the second operand when the first one is NaN, so invalid depth never wins
+  __m256 minVec = _mm256_set1_ps(minValue);
+  __m256 maxVec = _mm256_set1_ps(maxValue);
+  size_t col = 0;
+  for (; col + 8 <= width; col += 8) {
+    const __m256 z = _mm256_loadu_ps(depth + col);
+    minVec = _mm256_min_ps(z, minVec);
+    maxVec = _mm256_max_ps(z, maxVec);
+  }
+
+  alignas(32) float mins[8];
+  alignas(32) float maxs[8];
+  _mm256_store_ps(mins, minVec);
+  _mm256_store_ps(maxs, maxVec);
+  for (int i = 0; i < 8; ++i) {
+    minValue = std::min(minValue, mins[i]);
+    maxValue = std::max(maxValue, maxs[i]);
+  }
+
+  for (; col < width; ++col) {
+    const float z = depth[col];
+    if (z == z) {
+      minValue = std::min(minValue, z);
+      maxValue = std::max(maxValue, z);
+    }
+  }
+}
+
+PERCEPTION_TARGET_AVX2 void ColorizeRowAvx2(const float *depth, size_t width, float scale, float offset,
+                                            const uint8_t *lut, uint8_t *bgr) {
+  const __m256 scaleVec = _mm256_set1_ps(scale);
+  const __m256 offsetVec = _mm256_set1_ps(offset);
+  const __m256i minIndex = _mm256_set1_epi32(static_cast<int>(kMinIndex));
+  const __m256i maxIndex = _mm256_set1_epi32(static_cast<int>(kMaxIndex));
+
+  alignas(32) int32_t indices[8];
+  size_t col = 0;
+  for (; col + 8 <= width; col += 8) {
+    const __m256 z = _mm256_loadu_ps(depth + col);
+    const __m256 valid = _mm256_cmp_ps(z, z, _CMP_ORD_Q);
+    __m256i index = _mm256_cvtps_epi32(_mm256_fmadd_ps(z, scaleVec, offsetVec));
+    index = _mm256_min_epi32(_mm256_max_epi32(index, minIndex), maxIndex);
+    index = _mm256_and_si256(index, _mm256_castps_si256(valid));
+    _mm256_store_si256(reinterpret_cast<__m256i *>(indices), index);
+    for (int i = 0; i < 8; ++i) {
+      WriteColor(lut, indices[i], bgr + (col + i) * 3);
+    }
+  }
+
+  for (; col < width; ++col) {
+    WriteColor(lut, ScalarIndex(depth[col], scale, offset), bgr + col * 3);
+  }
+}
+#endif
+
+#if defined(PERCEPTION_SIMD_NEON)
+void MinMaxRowNeon(const float *depth, size_t width, float &minValue, float &maxValue) {
+  float32x4_t minVec = vdupq_n_f32(minValue);
+  float32x4_t maxVec = vdupq_n_f32(maxValue);
+  size_t col = 0;
+  for (; col + 4 <= width; col += 4) {
+    const float32x4_t z = vld1q_f32(depth + col);
+    const uint32x4_t valid = vceqq_f32(z, z);
+    minVec = vbslq_f32(valid, vminq_f32(z, minVec), minVec);
+    maxVec = vbslq_f32(valid, vmaxq_f32(z, maxVec), maxVec);
+  }
+
+  float mins[4];
+  float maxs[4];
+  vst1q_f32(mins, minVec);
+  vst1q_f32(maxs, maxVec);
+  for (int i = 0; i < 4; ++i) {
+    minValue = std::min(minValue, mins[i]);
+    maxValue = std::max(maxValue, maxs[i]);
+  }
+
+  for (; col < width; ++col) {
+    const float z = depth[col];
+    if (z == z) {
+      minValue = std::min(minValue, z);
+      maxValue = std::max(maxValue, z);
+    }
+  }
+}
+
+void ColorizeRowNeon(const float *depth, size_t width, float scale, float offset, const uint8_t *lut,
+                     uint8_t *bgr) {
+  const float32x4_t scaleVec = vdupq_n_f32(scale);
+  const float32x4_t offsetVec = vdupq_n_f32(offset + 0.5f);  // valid values are positive, truncation rounds
+  const float32x4_t minIndex = vdupq_n_f32(kMinIndex);
+  const float32x4_t maxIndex = vdupq_n_f32(kMaxIndex);
+
+  int32_t indices[4];
+  size_t col = 0;
+  for (; col + 4 <= width; col += 4) {
+    const float32x4_t z = vld1q_f32(depth + col);
+    const uint32x4_t valid = vceqq_f32(z, z);
+    float32x4_t value = vmlaq_f32(offsetVec, z, scaleVec);
+    value = vminq_f32(vmaxq_f32(value, minIndex), maxIndex);
+    const int32x4_t index = vandq_s32(vcvtq_s32_f32(value), vreinterpretq_s32_u32(valid));
+    vst1q_s32(indices, index);
+    for (int i = 0; i < 4; ++i) {
+      WriteColor(lut, indices[i], bgr + (col + i) * 3);
+    }
+  }
+
+  for (; col < width; ++col) {
+    WriteColor(lut, ScalarIndex(depth[col], scale, offset), bgr + col * 3);
+  }
+}
+#endif
+}  // namespace
+
+const uint8_t *DepthColorizer::JetLut() {
+  static const std::array<uint8_t, 256 * 3> lut = [] {
+    // Sample OpenCV's own JET map once so the output matches applyColorMap exactly
+    cv::Mat ramp(1, 256, CV_8UC1);
+    for (int i = 0; i < 256; ++i) {
+      ramp.at<uchar>(0, i) = static_cast<uchar>(i);
+    }
+    cv::Mat colored;
+    cv::applyColorMap(ramp, colored, cv::COLORMAP_JET);
+
+    std::array<uint8_t, 256 * 3> table {};
+    for (int i = 1; i < 256; ++i) {
+      const cv::Vec3b &color = colored.at<cv::Vec3b>(0, i);
+      table[i * 3 + 0] = color[0];
+      table[i * 3 + 1] = color[1];
+      table[i * 3 + 2] = color[2];
+    }
+    return table;
+  }();
+  return lut.data();
+}
+
+cv::Mat DepthColorizer::Colorize(const cv::Mat &depth, bool parallel) {
+  cv::Mat colored;
+  Colorize(depth, colored, parallel);
+  return colored;
+}
+
+void DepthColorizer::Colorize(const cv::Mat &depth, cv::Mat &colored, bool parallel) {
+  if (depth.empty() || depth.type() != CV_32FC1) {
+    colored.release();
+    return;
+  }
+
+  const size_t width = static_cast<size_t>(depth.cols);
+  const size_t height = static_cast<size_t>(depth.rows);
+  auto forEachRowBlock = [parallel, height](const std::function<void(size_t, size_t)> &body) {
+    if (parallel) {
+      ThreadPool::Shared().ParallelFor(0, height, kRowsPerTask, body);
+    } else {
+      body(0, height);
+    }
+  };
+
+  // Pass 1: per-row min/max of valid depth, reduced afterwards. The scratch rows are kept per
+  // calling thread so steady-state rendering does not allocate; lambdas name thread_locals directly
+  // rather than capturing them, so pool tasks go through these references to the caller's buffers.
+  thread_local std::vector<float> threadRowMin;
+  thread_local std::vector<float> threadRowMax;
+  std::vector<float> &rowMin = threadRowMin;
+  std::vector<float> &rowMax = threadRowMax;
+  rowMin.assign(height, std::numeric_limits<float>::infinity());
+  rowMax.assign(height, -std::numeric_limits<float>::infinity());
+  forEachRowBlock([&](size_t rowBegin, size_t rowEnd) {
+    for (size_t row = rowBegin; row < rowEnd; ++row) {
+      MinMaxRow(depth.ptr<float>(static_cast<int>(row)), width, rowMin[row], rowMax[row]);
+    }
+  });
+  const float minDepth = *std::min_element(rowMin.begin(), rowMin.end());
+  const float maxDepth = *std::max_element(rowMax.begin(), rowMax.end());
+
+  colored.create(depth.size(), CV_8UC3);
+  if (minDepth > maxDepth) {
+    colored.setTo(cv::Scalar(0, 0, 0));  // no valid depth at all
+    return;
+  }
+
+  // Near (min) -> 255, far (max) -> 1; a flat depth map renders with the top color
+  float scale = 0.0f;
+  float offset = kMaxIndex;
+  if (maxDepth > minDepth) {
+    const double range = static_cast<double>(maxDepth) - minDepth;
+    scale = static_cast<float>(-255.0 / range);
+    offset = static_cast<float>(maxDepth * 255.0 / range + 1.0);
+  }
+
+  // Pass 2: normalize, look up and mask in one go
+  forEachRowBlock([&](size_t rowBegin, size_t rowEnd) {
+    for (size_t row = rowBegin; row < rowEnd; ++row) {
+      ColorizeRow(depth.ptr<float>(static_cast<int>(row)), width, scale, offset,
+                  colored.ptr<uint8_t>(static_cast<int>(row)));
+    }
+  });
+}
+
+void DepthColorizer::MinMaxRow(const float *depth, size_t width, float &minValue, float &maxValue) {
+#if defined(PERCEPTION_SIMD_X86)
+  if (CpuSupportsAvx2()) {
+    MinMaxRowAvx2(depth, width, minValue, maxValue);
+    return;
+  }
+#elif defined(PERCEPTION_SIMD_NEON)
+  MinMaxRowNeon(depth, width, minValue, maxValue);
+  return;
+#endif
+  for (size_t col = 0; col < width; ++col) {
+    const float z = depth[col];
+    if (z == z) {
+      minValue = std::min(minValue, z);
+      maxValue = std::max(maxValue, z);
+    }
+  }
+}
+
+void DepthColorizer::ColorizeRow(const float *depth, size_t width, float scale, float offset, uint8_t *bgr) {
+  const uint8_t *lut = JetLut();
+#if defined(PERCEPTION_SIMD_X86)
+  if (CpuSupportsAvx2()) {
+    ColorizeRowAvx2(depth, width, scale, offset, lut, bgr);
+    return;
+  }
+#elif defined(PERCEPTION_SIMD_NEON)
+  ColorizeRowNeon(depth, width, scale, offset, lut, bgr);
+  return;
+#endif
+  for (size_t col = 0; col < width; ++col) {
+    WriteColor(lut, ScalarIndex(depth[col], scale, offset), bgr + col * 3);
+  }
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <opencv2/core.hpp>
+
+/**
+ * @brief 深度图伪彩色渲染内核
+ *
+ * 将 CV_32FC1 深度图渲染为 JET 伪彩色 BGR 图，共两遍扫描：第一遍按行求有效深度（非 NaN）的
+ * 最小 / 最大值，第二遍将深度归一化为索引并直接查 JET 表写出颜色。近处偏红、远处偏蓝，
+ * 无效深度输出黑色，效果与 minMaxLoc + convertTo + applyColorMap + 掩码的组合一致。
+ * 两遍均按行切分到共享线程池，行内使用 AVX2 / NEON 向量化。
+ */
+class DepthColorizer {
+public:
+    /**
+     * @brief 渲染深度图
+     * @param depth CV_32FC1 深度图
+     * @param parallel 是否按行并行
+     * @return CV_8UC3 伪彩色图，输入为空或类型不符时返回空图
+     */
+    static cv::Mat Colorize(const cv::Mat& depth, bool parallel = true);
+
+    /**
+     * @brief 渲染深度图到已有的输出图，尺寸不变时复用其存储
+     * @param colored 输出 CV_8UC3 伪彩色图，输入无效时被释放
+     */
+    static void Colorize(const cv::Mat& depth, cv::Mat& colored, bool parallel = true);
+
+    /**
+     * @brief JET 颜色查找表，256 项 BGR，索引 0 固定为黑色（无效深度）
+     */
+    static const uint8_t* JetLut();
+
+private:
+    static void MinMaxRow(const float* depth, size_t width, float& minValue, float& maxValue);
+    static void ColorizeRow(const float* depth, size_t width, float scale, float offset, uint8_t* bgr);
+};
@@ -0,0 +1,111 @@
+#include "DepthCropper.hpp"
+#include <cmath>
+#include <limits>
+#include <vector>
+#include "utils/ThreadPool.hpp"
+
+namespace {
+constexpr size_t kRowsPerTask = 16;
+
+// Box test in camera coordinates: for a depth pixel with ray (a, b, 1) and depth z the point in box
+// coordinates is q = z * (A * (a, b, 1)) + offset, where A = Rb^T * R and offset = Rb^T * (t - c).
+struct BoxTest {
+  double a[3][3];
+  double offset[3];
+  double half[3];
+
+  BoxTest(const DepthCropper::Box &box, const mmind::eye::FrameTransformation &transformation) {
+    const mmind::eye::FrameTransformation pose(box.rotation_deg[0], box.rotation_deg[1], box.rotation_deg[2], 0, 0,
+                                               0);
+    for (int i = 0; i < 3; ++i) {
+      for (int j = 0; j < 3; ++j) {
+        a[i][j] = 0;
+        for (int k = 0; k < 3; ++k) {
+          a[i][j] += pose.rotation[k][i] * transformation.rotation[k][j];
+        }
+      }
+      offset[i] = 0;
+      for (int k = 0; k < 3; ++k) {
+        offset[i] += pose.rotation[k][i] * (transformation.translation[k] - box.center_mm[k]);
+      }
+      half[i] = std::abs(box.size_mm[i]) * 0.5;
+    }
+  }
+};
+
+template <typename Body>
+void ForEachRow(size_t rows, bool parallel, Body &&body) {
+  if (parallel) {
+    ThreadPool::Shared().ParallelFor(0, rows, kRowsPerTask, body);
+  } else {
+    body(0, rows);
+  }
+}
+
+}  // namespace
+
+cv::Rect DepthCropper::Region(const Options &options, const cv::Size &depthSize) {
+  const cv::Rect full(0, 0, depthSize.width, depthSize.height);
+  if (!options.enable) {
+    return full;
+  }
+
+  cv::Rect roi = options.roi;
+  if (roi.width <= 0) roi.width = depthSize.width - roi.x;
+  if (roi.height <= 0) roi.height = depthSize.height - roi.y;
+  return roi & full;
+}
+
+void DepthCropper::Crop(const cv::Mat &depth, const mmind::eye::CameraMatrix &matrix,
+                        const mmind::eye::FrameTransformation &transformation, const Options &options,
+                        cv::Mat &cropped) {
+  const cv::Rect region = Region(options, depth.size());
+  if (depth.empty() || depth.type() != CV_32FC1 || region.empty()) {
+    cropped.release();
+    return;
+  }
+  cropped.create(region.size(), CV_32FC1);
+
+  // Unset limits become comparisons that always pass
+  const float minDepth = options.min_depth_mm > 0 ? options.min_depth_mm : 0.0f;
+  const float maxDepth = options.max_depth_mm > 0 ? options.max_depth_mm : std::numeric_limits<float>::infinity();
+
+  const bool useBox = options.enable && options.box.enable && matrix.fx > 0 && matrix.fy > 0;
+  const BoxTest box(options.box, transformation);
+  std::vector<double> colRays;
+  if (useBox) {
+    colRays.resize(region.width);
+    for (int col = 0; col < region.width; ++col) {
+      colRays[col] = (region.x + col - matrix.cx) / matrix.fx;
+    }
+  }
+
+  const float nan = std::numeric_limits<float>::quiet_NaN();
+  ForEachRow(static_cast<size_t>(region.height), options.parallel, [&](size_t rowBegin, size_t rowEnd) {
+    for (size_t row = rowBegin; row < rowEnd; ++row) {
+      const float *src = depth.ptr<float>(static_cast<int>(region.y + row)) + region.x;
+      float *dst = cropped.ptr<float>(static_cast<int>(row));
+      // The per-row part of A * (a, b, 1) is shared by every pixel in the row
+      double rowTerm[3] = {0, 0, 0};
+      if (useBox) {
+        const double b = (region.y + static_cast<double>(row) - matrix.cy) / matrix.fy;
+        for (int i = 0; i < 3; ++i) {
+          rowTerm[i] = box.a[i][1] * b + box.a[i][2];
+        }
+      }
+
+      for (int col = 0; col < region.width; ++col) {
+        const float z = src[col];
+        // Also rejects NaN and zero (invalid) depth
+        bool keep = z > minDepth && z <= maxDepth;
+        if (keep && useBox) {
+          for (int i = 0; i < 3 && keep; ++i) {
+            const double q = z * (box.a[i][0] * colRays[col] + rowTerm[i]) + box.offset[i];
+            keep = std::abs(q) <= box.half[i];
+          }
+        }
+        dst[col] = keep ? z : nan;
+      }
+    }
+  });
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <array>
+#include <opencv2/core.hpp>
+#include "area_scan_3d_camera/CameraProperties.h"
+#include "CommonTypes.h"
+
+/**
+ * @brief 深度图级裁剪内核
+ *
+ * 在生成点云之前按 2D ROI、深度范围和 3D 包围盒裁剪深度图：输出为 ROI 大小的深度图，
+ * 深度范围或包围盒之外的像素置为 NaN。后续的点云生成、坐标变换和降采样只处理 ROI 内的
+ * 像素，耗时随 ROI 面积缩小。
+ *
+ * 包围盒定义在点云的目标坐标系（即 FrameSet 点云类产品的坐标系）中，判断时将盒子换算到相机
+ * 坐标系，每个像素只需一次 3x3 仿射变换，不需要先生成完整点云。裁剪结果保持有序：ROI 内
+ * 像素 (col, row) 对应原深度图的 (roi.x + col, roi.y + row)。SDK 点云按裁剪结果截取由
+ * PointCloudTransformer::TransformFused 在变换的同一次遍历中完成。
+ */
+class DepthCropper {
+public:
+    struct Box {
+        bool enable = false;
+        std::array<double, 3> center_mm {};     // 盒子中心
+        std::array<double, 3> size_mm {};       // 盒子在自身坐标轴上的边长
+        std::array<double, 3> rotation_deg {};  // 依次绕 X、Y、Z 轴旋转（与 FrameTransformation 相同），全 0 为轴对齐
+    };
+
+    struct Options {
+        bool enable = false;
+        cv::Rect roi;              // 深度图像素坐标，宽或高为 0 时延伸到图像边缘
+        float min_depth_mm = 0.0f; // 深度下限，0 表示不限制
+        float max_depth_mm = 0.0f; // 深度上限，0 表示不限制
+        Box box;
+        bool parallel = true;
+    };
+
+    /**
+     * @brief 计算裁剪区域（ROI 与图像范围的交集）；未启用裁剪时为整幅图像
+     */
+    static cv::Rect Region(const Options& options, const cv::Size& depthSize);
+
+    /**
+     * @brief 裁剪深度图
+     * @param depth CV_32FC1 深度图（毫米）
+     * @param matrix 深度相机内参，包围盒裁剪需要有效内参，内参无效时忽略包围盒
+     * @param transformation 相机坐标系到包围盒所在坐标系的变换
+     * @param cropped 输出 Region() 大小的 CV_32FC1 深度图，按需调整大小，不能与 depth 共享内存
+     */
+    static void Crop(const cv::Mat& depth, const mmind::eye::CameraMatrix& matrix,
+                     const mmind::eye::FrameTransformation& transformation, const Options& options, cv::Mat& cropped);
+};
@@ -0,0 +1,163 @@
+#include "DepthProjector.hpp"
+#include <algorithm>
+#include <mutex>
+#include "utils/ThreadPool.hpp"
+
+static_assert(sizeof(mmind::eye::PointZ) == sizeof(float), "PointZ must be a packed float");
+static_assert(sizeof(mmind::eye::PointXYZ) == 3 * sizeof(float), "PointXYZ must be three packed floats");
+
+namespace {
+constexpr size_t kMaxCachedProjectors = 4;
+constexpr size_t kRowsPerTask = 16;
+}  // namespace
+
+DepthProjector::DepthProjector(const mmind::eye::CameraMatrix &matrix, size_t width, size_t height)
+    : matrix_(matrix), width_(width), height_(height), useAvx2_(CpuSupportsAvx2()) {
+  colFactors_.resize(width_);
+  for (size_t col = 0; col < width_; ++col) {
+    colFactors_[col] = static_cast<float>((static_cast<double>(col) - matrix.cx) / matrix.fx);
+  }
+
+  rowFactors_.resize(height_);
+  for (size_t row = 0; row < height_; ++row) {
+    rowFactors_[row] = static_cast<float>((static_cast<double>(row) - matrix.cy) / matrix.fy);
+  }
+}
+
+std::shared_ptr<const DepthProjector> DepthProjector::Get(const mmind::eye::CameraMatrix &matrix, size_t width,
+                                                          size_t height) {
+  static std::mutex cacheMutex;
+  static std::vector<std::shared_ptr<const DepthProjector>> cache;
+
+  std::lock_guard<std::mutex> lock(cacheMutex);
+  for (const auto &projector : cache) {
+    if (projector->Matches(matrix, width, height)) {
+      return projector;
+    }
+  }
+
+  if (cache.size() >= kMaxCachedProjectors) {
+    cache.erase(cache.begin());
+  }
+  cache.push_back(std::make_shared<DepthProjector>(matrix, width, height));
+  return cache.back();
+}
+
+bool DepthProjector::Matches(const mmind::eye::CameraMatrix &matrix, size_t width, size_t height) const {
+  return width_ == width && height_ == height && matrix_.fx == matrix.fx && matrix_.fy == matrix.fy &&
+         matrix_.cx == matrix.cx && matrix_.cy == matrix.cy;
+}
+
+void DepthProjector::Project(const mmind::eye::DepthMap &depth, mmind::eye::PointCloud &pointCloud,
+                             bool parallel) const {
+  if (depth.isEmpty() || depth.width() != width_ || depth.height() != height_) {
+    pointCloud.release();
+    return;
+  }
+
+  Project(reinterpret_cast<const float *>(depth.data()), pointCloud, parallel);
+}
+
+void DepthProjector::Project(const float *src, mmind::eye::PointCloud &pointCloud, bool parallel) const {
+  if (src == nullptr || width_ == 0 || height_ == 0) {
+    pointCloud.release();
+    return;
+  }
+
+  pointCloud.resize(width_, height_);
+  float *dst = reinterpret_cast<float *>(pointCloud.data());
+
+  if (!parallel) {
+    ProjectRows(src, dst, 0, height_);
+    return;
+  }
+
+  ThreadPool::Shared().ParallelFor(0, height_, kRowsPerTask,
+                                   [this, src, dst](size_t rowBegin, size_t rowEnd) {
+                                     ProjectRows(src, dst, rowBegin, rowEnd);
+                                   });
+}
+
+void DepthProjector::ProjectRows(const float *depth, float *xyz, size_t rowBegin, size_t rowEnd) const {
+  rowEnd = std::min(rowEnd, height_);
+  for (size_t row = rowBegin; row < rowEnd; ++row) {
+    const float *depthRow = depth + row * width_;
+    float *xyzRow = xyz + row * width_ * 3;
+#if defined(PERCEPTION_SIMD_X86)
+    if (useAvx2_) {
+      ProjectRowAvx2(depthRow, xyzRow, rowFactors_[row]);
+      continue;
+    }
+#elif defined(PERCEPTION_SIMD_NEON)
+    ProjectRowNeon(depthRow, xyzRow, rowFactors_[row]);
+    continue;
+#endif
+    ProjectRowScalar(depthRow, xyzRow, rowFactors_[row]);
+  }
+}
+
+void DepthProjector::ProjectRowScalar(const float *depth, float *xyz, float rowFactor) const {
+  for (size_t col = 0; col < width_; ++col) {
+    const float z = depth[col];
+    xyz[col * 3 + 0] = z * colFactors_[col];
+    xyz[col * 3 + 1] = z * rowFactor;
+    xyz[col * 3 + 2] = z;
+  }
+}
+
+#if defined(PERCEPTION_SIMD_X86)
+PERCEPTION_TARGET_AVX2 void DepthProjector::ProjectRowAvx2(const float *depth, float *xyz, float rowFactor) const {
+  const __m256 rowFactorVec = _mm256_set1_ps(rowFactor);
+  const float *colFactors = colFactors_.data();
+
+  size_t col = 0;
+  for (; col + 8 <= width_; col += 8) {
+    const __m256 z = _mm256_loadu_ps(depth + col);
+    const __m256 x = _mm256_mul_ps(z, _mm256_loadu_ps(colFactors + col));
+    const __m256 y = _mm256_mul_ps(z, rowFactorVec);
+
+    // Interleave planar x/y/z into eight packed PointXYZ (3 x 256-bit stores)
+    const __m256 xy = _mm256_shuffle_ps(x, y, _MM_SHUFFLE(2, 0, 2, 0));    // x0 x2 y0 y2 | x4 x6 y4 y6
+    const __m256 yz = _mm256_shuffle_ps(y, z, _MM_SHUFFLE(3, 1, 3, 1));    // y1 y3 z1 z3 | y5 y7 z5 z7
+    const __m256 zx = _mm256_shuffle_ps(z, x, _MM_SHUFFLE(3, 1, 2, 0));    // z0 z2 x1 x3 | z4 z6 x5 x7
+    const __m256 p03 = _mm256_shuffle_ps(xy, zx, _MM_SHUFFLE(2, 0, 2, 0));  // x0 y0 z0 x1 | x4 y4 z4 x5
+    const __m256 p14 = _mm256_shuffle_ps(yz, xy, _MM_SHUFFLE(3, 1, 2, 0));  // y1 z1 x2 y2 | y5 z5 x6 y6
+    const __m256 p25 = _mm256_shuffle_ps(zx, yz, _MM_SHUFFLE(3, 1, 3, 1));  // z2 x3 y3 z3 | z6 x7 y7 z7
+
+    float *out = xyz + col * 3;
+    _mm256_storeu_ps(out, _mm256_permute2f128_ps(p03, p14, 0x20));
+    _mm256_storeu_ps(out + 8, _mm256_permute2f128_ps(p25, p03, 0x30));
+    _mm256_storeu_ps(out + 16, _mm256_permute2f128_ps(p14, p25, 0x31));
+  }
+
+  for (; col < width_; ++col) {
+    const float z = depth[col];
+    xyz[col * 3 + 0] = z * colFactors[col];
+    xyz[col * 3 + 1] = z * rowFactor;
+    xyz[col * 3 + 2] = z;
+  }
+}
+#endif
+
+#if defined(PERCEPTION_SIMD_NEON)
+void DepthProjector::ProjectRowNeon(const float *depth, float *xyz, float rowFactor) const {
+  const float32x4_t rowFactorVec = vdupq_n_f32(rowFactor);
+  const float *colFactors = colFactors_.data();
+
+  size_t col = 0;
+  for (; col + 4 <= width_; col += 4) {
+    float32x4x3_t points;
+    points.val[2] = vld1q_f32(depth + col);
+    points.val[0] = vmulq_f32(points.val[2], vld1q_f32(colFactors + col));
+    points.val[1] = vmulq_f32(points.val[2], rowFactorVec);
+    vst3q_f32(xyz + col * 3, points);
+  }
+
+  for (; col < width_; ++col) {
+    const float z = depth[col];
+    xyz[col * 3 + 0] = z * colFactors[col];
+    xyz[col * 3 + 1] = z * rowFactor;
+    xyz[col * 3 + 2] = z;
+  }
+}
+#endif
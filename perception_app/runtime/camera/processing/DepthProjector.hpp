@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+#include "area_scan_3d_camera/CameraProperties.h"
+#include "area_scan_3d_camera/Frame3D.h"
+#include "utils/SimdSupport.hpp"
+
+/**
+ * @brief 深度图到有序点云的投影内核
+ *
+ * 针对一组深度相机内参和分辨率预先计算每列 (col - cx) / fx 与每行 (row - cy) / fy 查找表，
+ * 投影时每个像素只需两次乘法；按行切分到共享线程池并行执行，行内使用 AVX2 / NEON
+ * 向量化并直接写入 mmind::eye::PointCloud 的存储。
+ */
+class DepthProjector {
+public:
+    DepthProjector(const mmind::eye::CameraMatrix& matrix, size_t width, size_t height);
+
+    /**
+     * @brief 获取与内参和分辨率匹配的投影器
+     *
+     * 投影器按内参缓存，同一组内参只构建一次查找表，内参变化（如重新标定或多相机）时自动新建。
+     */
+    static std::shared_ptr<const DepthProjector> Get(const mmind::eye::CameraMatrix& matrix, size_t width,
+                                                     size_t height);
+
+    /**
+     * @brief 检查投影器是否对应给定的内参和分辨率
+     */
+    bool Matches(const mmind::eye::CameraMatrix& matrix, size_t width, size_t height) const;
+
+    /**
+     * @brief 将深度图投影为有序点云，无效深度（NaN）对应的点坐标同样为 NaN
+     * @param depth 深度图，分辨率须与投影器一致
+     * @param pointCloud 输出点云，按需调整大小
+     * @param parallel 是否按行并行
+     */
+    void Project(const mmind::eye::DepthMap& depth, mmind::eye::PointCloud& pointCloud, bool parallel = true) const;
+
+    /**
+     * @brief 将连续存储的深度数据投影为有序点云
+     * @param depth 深度数据首地址（行主序，Width() x Height() 个 float）
+     */
+    void Project(const float* depth, mmind::eye::PointCloud& pointCloud, bool parallel = true) const;
+
+    /**
+     * @brief 投影 [rowBegin, rowEnd) 行
+     * @param depth 深度数据首地址（行主序，width 个 float 一行）
+     * @param xyz 输出点首地址（行主序，每点 3 个 float）
+     */
+    void ProjectRows(const float* depth, float* xyz, size_t rowBegin, size_t rowEnd) const;
+
+    size_t Width() const { return width_; }
+    size_t Height() const { return height_; }
+
+private:
+    void ProjectRowScalar(const float* depth, float* xyz, float rowFactor) const;
+#if defined(PERCEPTION_SIMD_X86)
+    void ProjectRowAvx2(const float* depth, float* xyz, float rowFactor) const;
+#endif
+#if defined(PERCEPTION_SIMD_NEON)
+    void ProjectRowNeon(const float* depth, float* xyz, float rowFactor) const;
+#endif
+
+private:
+    mmind::eye::CameraMatrix matrix_;
+    size_t width_;
+    size_t height_;
+    std::vector<float> colFactors_;  // (col - cx) / fx
+    std::vector<float> rowFactors_;  // (row - cy) / fy
+    bool useAvx2_;
+};
@@ -0,0 +1,275 @@
+#include "DetectionPostprocessor.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <string>
+#include <nlohmann/json.hpp>
+#include "Logger.hpp"
+
+namespace {
+// Union formed in the same order as in the vector kernels, so every path yields bit-identical values
+inline float IoU(float intersection, float area, float otherArea) {
+  const float unionArea = area + otherArea - intersection;
+  return unionArea > 0.0f ? intersection / unionArea : 0.0f;
+}
+}  // namespace
+
+void DetectionPostprocessor::BoxSet::Clear() {
+  x1.clear();
+  y1.clear();
+  x2.clear();
+  y2.clear();
+  area.clear();
+  score.clear();
+  class_id.clear();
+  index.clear();
+}
+
+void DetectionPostprocessor::BoxSet::Push(const Detection &detection, uint32_t position) {
+  const float width = std::max(detection.width, 0.0f);
+  const float height = std::max(detection.height, 0.0f);
+  x1.push_back(detection.x);
+  y1.push_back(detection.y);
+  x2.push_back(detection.x + width);
+  y2.push_back(detection.y + height);
+  area.push_back(width * height);
+  score.push_back(detection.score);
+  class_id.push_back(detection.class_id);
+  index.push_back(position);
+}
+
+void DetectionPostprocessor::BoxSet::SwapRemove(size_t position) {
+  auto remove = [position](auto &values) {
+    values[position] = values.back();
+    values.pop_back();
+  };
+  remove(x1);
+  remove(y1);
+  remove(x2);
+  remove(y2);
+  remove(area);
+  remove(score);
+  remove(class_id);
+  remove(index);
+}
+
+bool DetectionPostprocessor::ParseOptions(const nlohmann::json &config, Options &options) {
+  if (!config.contains("postprocessing")) return true;
+
+  Options parsed = options;
+  try {
+    const auto &postprocessing = config["postprocessing"];
+    parsed.score_threshold = postprocessing.value("score_threshold", parsed.score_threshold);
+    parsed.nms_threshold = postprocessing.value("nms_threshold", parsed.nms_threshold);
+    parsed.soft_sigma = postprocessing.value("soft_sigma", parsed.soft_sigma);
+    parsed.class_aware = postprocessing.value("class_aware", parsed.class_aware);
+
+    const int64_t maxDetections =
+        postprocessing.value("max_detections", static_cast<int64_t>(parsed.max_detections));
+    if (maxDetections < 0) {
+      LOG_ERROR_STREAM << "postprocessing max_detections must not be negative";
+      return false;
+    }
+    parsed.max_detections = static_cast<size_t>(maxDetections);
+
+    const std::string method = postprocessing.value("method", std::string("greedy"));
+    if (method == "greedy") {
+      parsed.method = Method::Greedy;
+    } else if (method == "soft_linear") {
+      parsed.method = Method::SoftLinear;
+    } else if (method == "soft_gaussian") {
+      parsed.method = Method::SoftGaussian;
+    } else {
+      LOG_ERROR_STREAM << "Unknown postprocessing method '" << method << "'";
+      return false;
+    }
+  } catch (const nlohmann::json::exception &e) {
+    LOG_ERROR_STREAM << "Invalid postprocessing config: " << e.what();
+    return false;
+  }
+
+  if (!(parsed.nms_threshold >= 0.0f && parsed.nms_threshold <= 1.0f) || !(parsed.soft_sigma > 0.0f)) {
+    LOG_ERROR_STREAM << "postprocessing nms_threshold must be in [0, 1] and soft_sigma positive";
+    return false;
+  }
+  options = parsed;
+  return true;
+}
+
+DetectionPostprocessor::DetectionPostprocessor(const Options &options) : options_(options) {}
+
+void DetectionPostprocessor::Run(const std::vector<Detection> &candidates, std::vector<Detection> &detections) {
+  detections.clear();
+  const size_t limit = options_.max_detections > 0 ? options_.max_detections : std::numeric_limits<size_t>::max();
+  if (options_.method == Method::Greedy) {
+    RunGreedy(candidates, detections, limit);
+  } else {
+    RunSoft(candidates, detections, limit);
+  }
+}
+
+void DetectionPostprocessor::RunGreedy(const std::vector<Detection> &candidates, std::vector<Detection> &detections,
+                                       size_t limit) {
+  heap_.clear();
+  for (size_t i = 0; i < candidates.size(); ++i) {
+    if (candidates[i].score >= options_.score_threshold) {
+      heap_.push_back(static_cast<uint32_t>(i));
+    }
+  }
+
+  // Heap instead of a full sort: only as many candidates are ordered as it takes to fill max_detections
+  auto lower = [&candidates](uint32_t a, uint32_t b) {
+    return candidates[a].score < candidates[b].score || (candidates[a].score == candidates[b].score && a > b);
+  };
+  std::make_heap(heap_.begin(), heap_.end(), lower);
+
+  boxes_.Clear();
+  iou_.resize(std::min(limit, heap_.size()));
+  while (!heap_.empty() && detections.size() < limit) {
+    std::pop_heap(heap_.begin(), heap_.end(), lower);
+    const uint32_t index = heap_.back();
+    heap_.pop_back();
+
+    // Compared against the kept boxes only, which never exceed max_detections
+    const Detection &candidate = candidates[index];
+    const size_t kept = boxes_.Size();
+    ComputeIoU(candidate, boxes_, options_.class_aware, iou_.data());
+    if (std::none_of(iou_.data(), iou_.data() + kept, [this](float iou) { return iou > options_.nms_threshold; })) {
+      boxes_.Push(candidate, index);
+      detections.push_back(candidate);
+    }
+  }
+}
+
+void DetectionPostprocessor::RunSoft(const std::vector<Detection> &candidates, std::vector<Detection> &detections,
+                                     size_t limit) {
+  boxes_.Clear();
+  for (size_t i = 0; i < candidates.size(); ++i) {
+    if (candidates[i].score >= options_.score_threshold) {
+      boxes_.Push(candidates[i], static_cast<uint32_t>(i));
+    }
+  }
+  iou_.resize(boxes_.Size());
+
+  const float gaussianScale = -1.0f / options_.soft_sigma;
+  while (boxes_.Size() > 0 && detections.size() < limit) {
+    size_t best = 0;
+    for (size_t i = 1; i < boxes_.Size(); ++i) {
+      if (boxes_.score[i] > boxes_.score[best] ||
+          (boxes_.score[i] == boxes_.score[best] && boxes_.index[i] < boxes_.index[best])) {
+        best = i;
+      }
+    }
+
+    Detection selected = candidates[boxes_.index[best]];
+    selected.score = boxes_.score[best];
+    detections.push_back(selected);
+    boxes_.SwapRemove(best);
+
+    ComputeIoU(selected, boxes_, options_.class_aware, iou_.data());
+    // Backwards so a swap-removed slot is refilled with a box that is already decayed
+    for (size_t i = boxes_.Size(); i-- > 0;) {
+      const float iou = iou_[i];
+      float &score = boxes_.score[i];
+      if (options_.method == Method::SoftLinear) {
+        if (iou > options_.nms_threshold) score *= 1.0f - iou;
+      } else if (iou > 0.0f) {
+        score *= std::exp(iou * iou * gaussianScale);
+      }
+      if (score < options_.score_threshold) {
+        boxes_.SwapRemove(i);
+      }
+    }
+  }
+}
+
+void DetectionPostprocessor::ComputeIoU(const Detection &box, const BoxSet &boxes, bool classAware, float *iou) {
+  const float width = std::max(box.width, 0.0f);
+  const float height = std::max(box.height, 0.0f);
+  const Reference reference{box.x, box.y, box.x + width, box.y + height, width * height, box.class_id, classAware};
+  const size_t count = boxes.Size();
+#if defined(PERCEPTION_SIMD_X86)
+  if (CpuSupportsAvx2()) {
+    ComputeIoUAvx2(reference, boxes, iou, count);
+    return;
+  }
+#elif defined(PERCEPTION_SIMD_NEON)
+  ComputeIoUNeon(reference, boxes, iou, count);
+  return;
+#endif
+  ComputeIoUScalar(reference, boxes, iou, 0, count);
+}
+
+void DetectionPostprocessor::ComputeIoUScalar(const Reference &reference, const BoxSet &boxes, float *iou,
+                                              size_t begin, size_t end) {
+  for (size_t i = begin; i < end; ++i) {
+    const float width = std::max(std::min(reference.x2, boxes.x2[i]) - std::max(reference.x1, boxes.x1[i]), 0.0f);
+    const float height = std::max(std::min(reference.y2, boxes.y2[i]) - std::max(reference.y1, boxes.y1[i]), 0.0f);
+    const bool comparable = !reference.class_aware || boxes.class_id[i] == reference.class_id;
+    iou[i] = comparable ? IoU(width * height, reference.area, boxes.area[i]) : 0.0f;
+  }
+}
+
+#if defined(PERCEPTION_SIMD_X86)
+PERCEPTION_TARGET_AVX2 void DetectionPostprocessor::ComputeIoUAvx2(const Reference &reference, const BoxSet &boxes,
+                                                                   float *iou, size_t count) {
+  const __m256 x1 = _mm256_set1_ps(reference.x1);
+  const __m256 y1 = _mm256_set1_ps(reference.y1);
+  const __m256 x2 = _mm256_set1_ps(reference.x2);
+  const __m256 y2 = _mm256_set1_ps(reference.y2);
+  const __m256 area = _mm256_set1_ps(reference.area);
+  const __m256i classId = _mm256_set1_epi32(reference.class_id);
+  const __m256 zero = _mm256_setzero_ps();
+
+  size_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    const __m256 right = _mm256_min_ps(x2, _mm256_loadu_ps(&boxes.x2[i]));
+    const __m256 left = _mm256_max_ps(x1, _mm256_loadu_ps(&boxes.x1[i]));
+    const __m256 bottom = _mm256_min_ps(y2, _mm256_loadu_ps(&boxes.y2[i]));
+    const __m256 top = _mm256_max_ps(y1, _mm256_loadu_ps(&boxes.y1[i]));
+    const __m256 width = _mm256_max_ps(_mm256_sub_ps(right, left), zero);
+    const __m256 height = _mm256_max_ps(_mm256_sub_ps(bottom, top), zero);
+    const __m256 intersection = _mm256_mul_ps(width, height);
+    const __m256 unionArea = _mm256_sub_ps(_mm256_add_ps(area, _mm256_loadu_ps(&boxes.area[i])), intersection);
+    __m256 valid = _mm256_cmp_ps(unionArea, zero, _CMP_GT_OQ);
+    if (reference.class_aware) {
+      const __m256i classes = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(&boxes.class_id[i]));
+      valid = _mm256_and_ps(valid, _mm256_castsi256_ps(_mm256_cmpeq_epi32(classes, classId)));
+    }
+    _mm256_storeu_ps(iou + i, _mm256_and_ps(_mm256_div_ps(intersection, unionArea), valid));
+  }
+
+  ComputeIoUScalar(reference, boxes, iou, i, count);
+}
+#endif
+
+#if defined(PERCEPTION_SIMD_NEON)
+void DetectionPostprocessor::ComputeIoUNeon(const Reference &reference, const BoxSet &boxes, float *iou,
+                                            size_t count) {
+  const float32x4_t x1 = vdupq_n_f32(reference.x1);
+  const float32x4_t y1 = vdupq_n_f32(reference.y1);
+  const float32x4_t x2 = vdupq_n_f32(reference.x2);
+  const float32x4_t y2 = vdupq_n_f32(reference.y2);
+  const float32x4_t area = vdupq_n_f32(reference.area);
+  const int32x4_t classId = vdupq_n_s32(reference.class_id);
+  const float32x4_t zero = vdupq_n_f32(0.0f);
+
+  size_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    const float32x4_t width =
+        vmaxq_f32(vsubq_f32(vminq_f32(x2, vld1q_f32(&boxes.x2[i])), vmaxq_f32(x1, vld1q_f32(&boxes.x1[i]))), zero);
+    const float32x4_t height =
+        vmaxq_f32(vsubq_f32(vminq_f32(y2, vld1q_f32(&boxes.y2[i])), vmaxq_f32(y1, vld1q_f32(&boxes.y1[i]))), zero);
+    const float32x4_t intersection = vmulq_f32(width, height);
+    const float32x4_t unionArea = vsubq_f32(vaddq_f32(area, vld1q_f32(&boxes.area[i])), intersection);
+    uint32x4_t valid = vcgtq_f32(unionArea, zero);
+    if (reference.class_aware) {
+      valid = vandq_u32(valid, vceqq_s32(vld1q_s32(&boxes.class_id[i]), classId));
+    }
+    const uint32x4_t value = vreinterpretq_u32_f32(vdivq_f32(intersection, unionArea));
+    vst1q_f32(iou + i, vreinterpretq_f32_u32(vandq_u32(value, valid)));
+  }
+
+  ComputeIoUScalar(reference, boxes, iou, i, count);
+}
+#endif
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <nlohmann/json_fwd.hpp>
+#include "InferenceResult.hpp"
+#include "utils/SimdSupport.hpp"
+
+/**
+ * @brief 检测结果后处理：得分过滤、NMS 和 top-k 截断
+ *
+ * 供各检测算法共用，按推理配置的 postprocessing 设置：
+ * - Greedy：候选按得分建堆，依次弹出当前最高分的候选，与已保留的框（至多 max_detections 个）批量计算
+ *   IoU，均不超过 nms_threshold 时保留。保留数达到 max_detections 即停止，不需要对全部候选排序。
+ * - SoftLinear / SoftGaussian（Soft-NMS）：每轮选出当前最高分的框，按与它的 IoU 衰减其余候选的得分
+ *   （线性：IoU 超过 nms_threshold 时乘以 1 - IoU；高斯：乘以 exp(-IoU^2 / soft_sigma)），得分低于
+ *   score_threshold 的候选被移除，选满 max_detections 个或没有候选时停止。
+ *
+ * 框以结构数组（BoxSet）存放，批量 IoU 按运行时检测选择 AVX2 / NEON / 标量内核。候选、堆和 IoU 缓冲
+ * 在调用之间复用，候选数不超过历史最大值时 Run 不分配内存。一个后处理器对应一个算法实例，非线程安全。
+ */
+class DetectionPostprocessor {
+public:
+    enum class Method {
+        Greedy,
+        SoftLinear,
+        SoftGaussian
+    };
+
+    struct Options {
+        float score_threshold = 0.0f;  // 低于该得分的候选不参与 NMS（Soft-NMS 中也用于移除衰减后的候选）
+        float nms_threshold = 0.5f;    // IoU 阈值
+        size_t max_detections = 100;   // 最多输出的检测数，0 表示不限制
+        Method method = Method::Greedy;
+        float soft_sigma = 0.5f;       // SoftGaussian 的高斯参数
+        bool class_aware = true;       // 只在同一类别的框之间抑制
+    };
+
+    /**
+     * @brief 按结构数组存放的框（左上、右下角点），供批量 IoU 使用
+     */
+    struct BoxSet {
+        std::vector<float> x1;
+        std::vector<float> y1;
+        std::vector<float> x2;
+        std::vector<float> y2;
+        std::vector<float> area;
+        std::vector<float> score;
+        std::vector<int32_t> class_id;
+        std::vector<uint32_t> index;  // 在输入候选中的下标
+
+        size_t Size() const { return x1.size(); }
+        void Clear();
+        void Push(const Detection& detection, uint32_t index);
+        // 把最后一个框移到 position 并删除末尾，不保持顺序
+        void SwapRemove(size_t position);
+    };
+
+    /**
+     * @brief 从推理配置读取 postprocessing
+     * @param config 推理配置文件的 JSON 根对象，缺少的字段保持默认值
+     * @return 字段类型不符或取值非法时返回 false，options 保持调用前的值
+     */
+    static bool ParseOptions(const nlohmann::json& config, Options& options);
+
+    explicit DetectionPostprocessor(const Options& options);
+
+    /**
+     * @brief 对候选检测执行得分过滤、NMS 和 top-k 截断
+     * @param candidates 模型输出的候选检测
+     * @param detections 输出：按得分降序保留的检测（Soft-NMS 为衰减后的得分），先清空，复用其容量；
+     *                   不能与 candidates 是同一对象
+     */
+    void Run(const std::vector<Detection>& candidates, std::vector<Detection>& detections);
+
+    /**
+     * @brief 批量计算一个框与 boxes 中每个框的 IoU
+     * @param box 参照框
+     * @param classAware 为 true 时类别不同的框 IoU 记为 0
+     * @param iou 输出，至少 boxes.Size() 个元素
+     */
+    static void ComputeIoU(const Detection& box, const BoxSet& boxes, bool classAware, float* iou);
+
+    const Options& GetOptions() const { return options_; }
+
+private:
+    // 参照框按角点和面积展开，供各内核使用
+    struct Reference {
+        float x1;
+        float y1;
+        float x2;
+        float y2;
+        float area;
+        int32_t class_id;
+        bool class_aware;
+    };
+
+    void RunGreedy(const std::vector<Detection>& candidates, std::vector<Detection>& detections, size_t limit);
+    void RunSoft(const std::vector<Detection>& candidates, std::vector<Detection>& detections, size_t limit);
+
+    static void ComputeIoUScalar(const Reference& reference, const BoxSet& boxes, float* iou, size_t begin,
+                                 size_t end);
+#if defined(PERCEPTION_SIMD_X86)
+    static void ComputeIoUAvx2(const Reference& reference, const BoxSet& boxes, float* iou, size_t count);
+#endif
+#if defined(PERCEPTION_SIMD_NEON)
+    static void ComputeIoUNeon(const Reference& reference, const BoxSet& boxes, float* iou, size_t count);
+#endif
+
+private:
+    Options options_;
+    std::vector<uint32_t> heap_;  // Greedy：按得分排列的候选下标
+    BoxSet boxes_;                // Greedy：已保留的框；Soft-NMS：剩余的候选
+    std::vector<float> iou_;
+};
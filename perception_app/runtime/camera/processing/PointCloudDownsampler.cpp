@@ -0,0 +1,440 @@
+#include "PointCloudDownsampler.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <vector>
+#include "utils/ThreadPool.hpp"
+
+namespace {
+constexpr size_t kRowsPerTask = 8;
+constexpr size_t kMaxChunks = 64;
+constexpr size_t kShards = 64;  // power of two
+constexpr int kShardShift = 58;  // 64 - log2(kShards)
+
+// Voxel coordinates are packed 21 bits per axis, i.e. +-2^20 voxels (+-5 km at 5 mm voxels)
+constexpr int64_t kCoordBias = int64_t(1) << 20;
+constexpr int64_t kCoordLimit = int64_t(1) << 21;
+constexpr uint64_t kInvalidKey = std::numeric_limits<uint64_t>::max();
+
+// splitmix64 finalizer: both the top bits (shard) and the low bits (table slot) depend on every axis
+inline uint64_t HashKey(uint64_t key) {
+  key = (key ^ (key >> 30)) * 0xBF58476D1CE4E5B9ull;
+  key = (key ^ (key >> 27)) * 0x94D049BB133111EBull;
+  return key ^ (key >> 31);
+}
+
+inline size_t ShardOf(uint64_t key) { return static_cast<size_t>(HashKey(key) >> kShardShift); }
+
+// std::floor is a libm call on baseline x86-64 (no SSE4.1 roundsd); this is the hot loop
+inline int64_t FloorToInt(double value) {
+  const int64_t truncated = static_cast<int64_t>(value);
+  return truncated - (value < static_cast<double>(truncated) ? 1 : 0);
+}
+
+template <typename Point>
+inline bool IsValid(const Point &point) {
+  return std::isfinite(point.x) && std::isfinite(point.y) && std::isfinite(point.z);
+}
+
+// PointXYZBGR declares a copy constructor but no assignment, so copies go field by field
+inline void CopyPoint(const mmind::eye::PointXYZ &in, mmind::eye::PointXYZ &out) { out = in; }
+
+inline void CopyPoint(const mmind::eye::PointXYZBGR &in, mmind::eye::PointXYZBGR &out) {
+  out.x = in.x;
+  out.y = in.y;
+  out.z = in.z;
+  out.rgb = in.rgb;
+}
+
+inline void SetInvalid(mmind::eye::PointXYZ &point) {
+  point.x = point.y = point.z = std::numeric_limits<float>::quiet_NaN();
+}
+
+inline void SetInvalid(mmind::eye::PointXYZBGR &point) {
+  point.x = point.y = point.z = std::numeric_limits<float>::quiet_NaN();
+  point.b = point.g = point.r = 0;
+  point.a = 255;
+}
+
+// Running sums for one output point; colors are averaged alongside the coordinates
+template <typename Point>
+struct Accumulator;
+
+template <>
+struct Accumulator<mmind::eye::PointXYZ> {
+  double x = 0.0, y = 0.0, z = 0.0;
+  uint32_t count = 0;
+
+  void Add(const mmind::eye::PointXYZ &p) {
+    x += p.x;
+    y += p.y;
+    z += p.z;
+    count++;
+  }
+
+  void Merge(const Accumulator &other) {
+    x += other.x;
+    y += other.y;
+    z += other.z;
+    count += other.count;
+  }
+
+  void Write(mmind::eye::PointXYZ &out) const {
+    const double inv = 1.0 / count;
+    out.x = static_cast<float>(x * inv);
+    out.y = static_cast<float>(y * inv);
+    out.z = static_cast<float>(z * inv);
+  }
+};
+
+template <>
+struct Accumulator<mmind::eye::PointXYZBGR> {
+  double x = 0.0, y = 0.0, z = 0.0;
+  uint32_t b = 0, g = 0, r = 0;
+  uint32_t count = 0;
+
+  void Add(const mmind::eye::PointXYZBGR &p) {
+    x += p.x;
+    y += p.y;
+    z += p.z;
+    b += p.b;
+    g += p.g;
+    r += p.r;
+    count++;
+  }
+
+  void Merge(const Accumulator &other) {
+    x += other.x;
+    y += other.y;
+    z += other.z;
+    b += other.b;
+    g += other.g;
+    r += other.r;
+    count += other.count;
+  }
+
+  void Write(mmind::eye::PointXYZBGR &out) const {
+    const double inv = 1.0 / count;
+    out.x = static_cast<float>(x * inv);
+    out.y = static_cast<float>(y * inv);
+    out.z = static_cast<float>(z * inv);
+    out.b = static_cast<uint8_t>((b + count / 2) / count);
+    out.g = static_cast<uint8_t>((g + count / 2) / count);
+    out.r = static_cast<uint8_t>((r + count / 2) / count);
+    out.a = 255;
+  }
+};
+
+void RunRange(size_t begin, size_t end, size_t grain, bool parallel, const std::function<void(size_t, size_t)> &body) {
+  if (parallel) {
+    ThreadPool::Shared().ParallelFor(begin, end, grain, body);
+  } else {
+    body(begin, end);
+  }
+}
+
+// Partial sum of a run of neighbouring points that fall into the same voxel
+template <typename Point>
+struct VoxelRun {
+  uint64_t key;
+  Accumulator<Point> sum;
+};
+
+// Buffers are kept per calling thread so steady-state frames do not reallocate
+template <typename Point>
+struct VoxelScratch {
+  std::vector<std::vector<VoxelRun<Point>>> chunk_runs;
+  std::vector<VoxelRun<Point>> runs;
+  std::vector<uint32_t> counts;
+  std::vector<uint32_t> offsets;
+  std::vector<uint32_t> shard_begin;
+  std::vector<std::vector<Point>> shard_points;
+};
+
+// Pass 3 hash table, kept per worker thread since shards are merged by pool tasks
+template <typename Point>
+struct ShardTable {
+  std::vector<uint64_t> slot_keys;
+  std::vector<uint32_t> slot_index;
+  std::vector<uint64_t> old_keys;
+  std::vector<uint32_t> old_index;
+  std::vector<Accumulator<Point>> voxels;
+};
+
+template <typename Point>
+void DownsampleVoxel(const mmind::eye::Array2D<Point> &source, mmind::eye::Array2D<Point> &target,
+                     const PointCloudDownsampler::Options &options) {
+  const size_t width = source.width();
+  const size_t height = source.height();
+  const Point *in = source.data();
+  const double inv_size = 1.0 / options.voxel_size_mm;
+
+  // Lambdas name thread_locals directly rather than capturing them, so pool tasks go through this reference
+  thread_local VoxelScratch<Point> thread_scratch;
+  VoxelScratch<Point> &scratch = thread_scratch;
+  const size_t chunks = std::min(height, kMaxChunks);
+  const size_t rows_per_chunk = (height + chunks - 1) / chunks;
+  scratch.chunk_runs.resize(chunks);
+
+  // Pass 1: voxel key per point. Consecutive pixels of a row usually share a voxel, so each run of
+  // equal keys is summed on the spot; the later passes move runs instead of points. Also counts the
+  // runs per (chunk, shard).
+  std::vector<uint32_t> &counts = scratch.counts;
+  counts.assign(chunks * kShards, 0);
+  RunRange(0, chunks, 1, options.parallel, [&](size_t chunkBegin, size_t chunkEnd) {
+    for (size_t chunk = chunkBegin; chunk < chunkEnd; ++chunk) {
+      auto &runs = scratch.chunk_runs[chunk];
+      runs.clear();
+      uint32_t *histogram = counts.data() + chunk * kShards;
+      const size_t row_end = std::min(height, (chunk + 1) * rows_per_chunk);
+      for (size_t row = chunk * rows_per_chunk; row < row_end; ++row) {
+        const Point *line = in + row * width;
+        uint64_t run_key = kInvalidKey;
+        for (size_t col = 0; col < width; ++col) {
+          const Point &p = line[col];
+          if (!IsValid(p)) continue;
+          const int64_t ix = FloorToInt(p.x * inv_size) + kCoordBias;
+          const int64_t iy = FloorToInt(p.y * inv_size) + kCoordBias;
+          const int64_t iz = FloorToInt(p.z * inv_size) + kCoordBias;
+          if (ix < 0 || iy < 0 || iz < 0 || ix >= kCoordLimit || iy >= kCoordLimit || iz >= kCoordLimit) continue;
+          const uint64_t key = (static_cast<uint64_t>(ix) << 42) | (static_cast<uint64_t>(iy) << 21) |
+                               static_cast<uint64_t>(iz);
+          if (key != run_key) {
+            runs.push_back({key, Accumulator<Point>()});
+            histogram[ShardOf(key)]++;
+            run_key = key;
+          }
+          runs.back().sum.Add(p);
+        }
+      }
+    }
+  });
+
+  // Shard-major offsets: shard s owns [shard_begin[s], shard_begin[s + 1]) of the run array
+  std::vector<uint32_t> &offsets = scratch.offsets;
+  std::vector<uint32_t> &shard_begin = scratch.shard_begin;
+  offsets.resize(chunks * kShards);
+  shard_begin.resize(kShards + 1);
+  uint32_t running = 0;
+  for (size_t shard = 0; shard < kShards; ++shard) {
+    shard_begin[shard] = running;
+    for (size_t chunk = 0; chunk < chunks; ++chunk) {
+      offsets[chunk * kShards + shard] = running;
+      running += counts[chunk * kShards + shard];
+    }
+  }
+  shard_begin[kShards] = running;
+
+  // Pass 2: scatter runs into their shard's range. Chunks are fixed row ranges, so this is a
+  // stable counting sort and the output order does not depend on scheduling.
+  scratch.runs.resize(running);
+  VoxelRun<Point> *sorted = scratch.runs.data();
+  RunRange(0, chunks, 1, options.parallel, [&](size_t chunkBegin, size_t chunkEnd) {
+    for (size_t chunk = chunkBegin; chunk < chunkEnd; ++chunk) {
+      uint32_t *cursor = offsets.data() + chunk * kShards;
+      for (const auto &run : scratch.chunk_runs[chunk]) {
+        sorted[cursor[ShardOf(run.key)]++] = run;
+      }
+    }
+  });
+
+  // Pass 3: each shard merges its runs in a private open-addressing table
+  std::vector<std::vector<Point>> &shard_points = scratch.shard_points;
+  shard_points.resize(kShards);
+  RunRange(0, kShards, 1, options.parallel, [&](size_t shardBegin, size_t shardEnd) {
+    thread_local ShardTable<Point> table;
+    std::vector<uint64_t> &slot_keys = table.slot_keys;
+    std::vector<uint32_t> &slot_index = table.slot_index;
+    std::vector<Accumulator<Point>> &voxels = table.voxels;
+    for (size_t shard = shardBegin; shard < shardEnd; ++shard) {
+      const uint32_t begin = shard_begin[shard];
+      const uint32_t end = shard_begin[shard + 1];
+      shard_points[shard].clear();
+      if (begin == end) continue;
+
+      // Sized for the voxels, not the runs, and grown at half load so probes stay short
+      size_t mask = 255;
+      slot_keys.assign(mask + 1, kInvalidKey);
+      slot_index.resize(mask + 1);
+      voxels.clear();
+      auto find_slot = [&](uint64_t key) {
+        // The top hash bits chose the shard; the low bits pick the slot
+        size_t slot = static_cast<size_t>(HashKey(key)) & mask;
+        while (slot_keys[slot] != kInvalidKey && slot_keys[slot] != key) {
+          slot = (slot + 1) & mask;
+        }
+        return slot;
+      };
+
+      for (uint32_t k = begin; k < end; ++k) {
+        const VoxelRun<Point> &run = sorted[k];
+        size_t slot = find_slot(run.key);
+        if (slot_keys[slot] == kInvalidKey) {
+          if (2 * (voxels.size() + 1) > mask + 1) {
+            std::vector<uint64_t> &old_keys = table.old_keys;
+            std::vector<uint32_t> &old_index = table.old_index;
+            old_keys.swap(slot_keys);
+            old_index.swap(slot_index);
+            mask = 2 * mask + 1;
+            slot_keys.assign(mask + 1, kInvalidKey);
+            slot_index.resize(mask + 1);
+            for (size_t s = 0; s < old_keys.size(); ++s) {
+              if (old_keys[s] == kInvalidKey) continue;
+              const size_t moved = find_slot(old_keys[s]);
+              slot_keys[moved] = old_keys[s];
+              slot_index[moved] = old_index[s];
+            }
+            slot = find_slot(run.key);
+          }
+          slot_keys[slot] = run.key;
+          slot_index[slot] = static_cast<uint32_t>(voxels.size());
+          voxels.emplace_back();
+        }
+        voxels[slot_index[slot]].Merge(run.sum);
+      }
+
+      std::vector<Point> &points = shard_points[shard];
+      points.resize(voxels.size());
+      for (size_t v = 0; v < voxels.size(); ++v) {
+        voxels[v].Write(points[v]);
+      }
+    }
+  });
+
+  size_t count = 0;
+  for (const auto &points : shard_points) {
+    count += points.size();
+  }
+  if (count == 0) {
+    target.release();
+    return;
+  }
+  target.resize(count, 1);
+  Point *out = target.data();
+  for (const auto &points : shard_points) {
+    for (const auto &point : points) {
+      CopyPoint(point, *out++);
+    }
+  }
+}
+
+template <typename Point>
+void DownsampleOrganized(const mmind::eye::Array2D<Point> &source, mmind::eye::Array2D<Point> &target,
+                         const PointCloudDownsampler::Options &options) {
+  const size_t stride = std::max<size_t>(options.stride, 1);
+  const size_t width = source.width();
+  const size_t height = source.height();
+  const size_t out_width = (width + stride - 1) / stride;
+  const size_t out_height = (height + stride - 1) / stride;
+  target.resize(out_width, out_height);
+
+  const Point *in = source.data();
+  Point *out = target.data();
+  const bool bin = options.mode == PointCloudDownsampler::Mode::Bin;
+  RunRange(0, out_height, kRowsPerTask, options.parallel, [=](size_t rowBegin, size_t rowEnd) {
+    for (size_t row = rowBegin; row < rowEnd; ++row) {
+      Point *line = out + row * out_width;
+      if (!bin) {
+        const Point *src = in + row * stride * width;
+        for (size_t col = 0; col < out_width; ++col) {
+          CopyPoint(src[col * stride], line[col]);
+        }
+        continue;
+      }
+
+      const size_t row_end = std::min(height, (row + 1) * stride);
+      for (size_t col = 0; col < out_width; ++col) {
+        const size_t col_end = std::min(width, (col + 1) * stride);
+        Accumulator<Point> sum;
+        for (size_t r = row * stride; r < row_end; ++r) {
+          const Point *src = in + r * width;
+          for (size_t c = col * stride; c < col_end; ++c) {
+            if (IsValid(src[c])) sum.Add(src[c]);
+          }
+        }
+        if (sum.count > 0) {
+          sum.Write(line[col]);
+        } else {
+          SetInvalid(line[col]);
+        }
+      }
+    }
+  });
+}
+
+template <typename Point>
+void DownsampleCloud(const mmind::eye::Array2D<Point> &source, mmind::eye::Array2D<Point> &target,
+                     const PointCloudDownsampler::Options &options) {
+  if (source.isEmpty()) {
+    target.release();
+    return;
+  }
+
+  switch (options.mode) {
+    case PointCloudDownsampler::Mode::Voxel:
+      if (options.voxel_size_mm > 0.0f) {
+        DownsampleVoxel(source, target, options);
+        return;
+      }
+      break;
+    case PointCloudDownsampler::Mode::Stride:
+    case PointCloudDownsampler::Mode::Bin:
+      if (options.stride > 1) {
+        DownsampleOrganized(source, target, options);
+        return;
+      }
+      break;
+    default:
+      break;
+  }
+  // Plain copy; Array2D::clone memcpy()s the non-trivial point types
+  target.resize(source.width(), source.height());
+  const size_t count = source.width() * source.height();
+  const Point *in = source.data();
+  Point *out = target.data();
+  for (size_t i = 0; i < count; ++i) {
+    CopyPoint(in[i], out[i]);
+  }
+}
+}  // namespace
+
+bool PointCloudDownsampler::ParseMode(const std::string &name, Mode &mode) {
+  if (name == "none") {
+    mode = Mode::None;
+  } else if (name == "voxel") {
+    mode = Mode::Voxel;
+  } else if (name == "stride") {
+    mode = Mode::Stride;
+  } else if (name == "bin") {
+    mode = Mode::Bin;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+const char *PointCloudDownsampler::ModeToString(Mode mode) {
+  switch (mode) {
+    case Mode::Voxel:
+      return "voxel";
+    case Mode::Stride:
+      return "stride";
+    case Mode::Bin:
+      return "bin";
+    default:
+      return "none";
+  }
+}
+
+void PointCloudDownsampler::Downsample(const mmind::eye::PointCloud &source, mmind::eye::PointCloud &target,
+                                       const Options &options) {
+  DownsampleCloud(source, target, options);
+}
+
+void PointCloudDownsampler::Downsample(const mmind::eye::TexturedPointCloud &source,
+                                       mmind::eye::TexturedPointCloud &target, const Options &options) {
+  DownsampleCloud(source, target, options);
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include "area_scan_3d_camera/Frame2DAnd3D.h"
+#include "area_scan_3d_camera/Frame3D.h"
+
+/**
+ * @brief 点云降采样内核
+ *
+ * - Voxel：体素滤波，每个体素输出其中有效点的质心，结果为无序点云（N x 1）。点按体素坐标
+ *   哈希分片，先按行并行计算体素键并按分片计数排序，再按分片并行聚合，分片之间无共享写入；
+ *   输出顺序只取决于输入，与线程调度无关。
+ * - Stride：有序点云每 stride 行 / 列取一点，结果仍为有序点云。
+ * - Bin：有序点云按 stride x stride 块取有效点的均值（无有效点时为 NaN），结果仍为有序点云。
+ *
+ * 无效点（NaN）不参与计算。有纹理点云的颜色随坐标一起降采样（Voxel / Bin 取均值）。
+ */
+class PointCloudDownsampler {
+public:
+    enum class Mode {
+        None,    // 不降采样
+        Voxel,   // 体素质心
+        Stride,  // 有序抽点
+        Bin      // 有序分块均值
+    };
+
+    struct Options {
+        Mode mode = Mode::None;
+        float voxel_size_mm = 5.0f;  // Voxel 模式的体素边长
+        size_t stride = 4;           // Stride / Bin 模式的步长
+        bool parallel = true;
+    };
+
+    /**
+     * @brief 解析模式名（none / voxel / stride / bin）
+     * @return 模式名无效时返回 false
+     */
+    static bool ParseMode(const std::string& name, Mode& mode);
+
+    static const char* ModeToString(Mode mode);
+
+    /**
+     * @brief 降采样无纹理点云
+     * @param source 源点云
+     * @param target 输出点云，按需调整大小，不能与 source 为同一对象；Mode::None 时为源点云的拷贝
+     */
+    static void Downsample(const mmind::eye::PointCloud& source, mmind::eye::PointCloud& target,
+                           const Options& options);
+
+    /**
+     * @brief 降采样有纹理点云
+     */
+    static void Downsample(const mmind::eye::TexturedPointCloud& source, mmind::eye::TexturedPointCloud& target,
+                           const Options& options);
+};
@@ -0,0 +1,250 @@
+#include "PointCloudTransformer.hpp"
+#include <limits>
+#include "utils/ThreadPool.hpp"
+
+namespace {
+constexpr size_t kRowsPerTask = 16;
+
+struct Affine {
+  float r[3][3];
+  float t[3];
+
+  explicit Affine(const mmind::eye::FrameTransformation &transformation) {
+    for (int i = 0; i < 3; ++i) {
+      for (int j = 0; j < 3; ++j) {
+        r[i][j] = static_cast<float>(transformation.rotation[i][j]);
+      }
+      t[i] = static_cast<float>(transformation.translation[i]);
+    }
+  }
+
+  // Reads the input before writing, so in and out may be the same point
+  template <typename Point>
+  void Apply(const Point &in, Point &out) const {
+    const float x = in.x;
+    const float y = in.y;
+    const float z = in.z;
+    out.x = r[0][0] * x + r[0][1] * y + r[0][2] * z + t[0];
+    out.y = r[1][0] * x + r[1][1] * y + r[1][2] * z + t[1];
+    out.z = r[2][0] * x + r[2][1] * y + r[2][2] * z + t[2];
+  }
+
+  // Normals are directions: rotated, not translated
+  void Rotate(const mmind::eye::NormalVector &in, mmind::eye::NormalVector &out) const {
+    out.x = r[0][0] * in.x + r[0][1] * in.y + r[0][2] * in.z;
+    out.y = r[1][0] * in.x + r[1][1] * in.y + r[1][2] * in.z;
+    out.z = r[2][0] * in.x + r[2][1] * in.y + r[2][2] * in.z;
+    out.curvature = in.curvature;
+  }
+};
+
+inline void CopyColor(const mmind::eye::PointXYZ &, mmind::eye::PointXYZ &) {}
+
+inline void CopyColor(const mmind::eye::PointXYZBGR &in, mmind::eye::PointXYZBGR &out) {
+  out.b = in.b;
+  out.g = in.g;
+  out.r = in.r;
+  out.a = in.a;
+}
+
+// PointXYZBGR declares a copy constructor but no assignment, so copies go field by field
+inline void CopyPoint(const mmind::eye::PointXYZBGR &in, mmind::eye::PointXYZBGR &out) {
+  out.x = in.x;
+  out.y = in.y;
+  out.z = in.z;
+  out.rgb = in.rgb;
+}
+
+inline void SetInvalid(mmind::eye::PointXYZ &point) {
+  point.x = point.y = point.z = std::numeric_limits<float>::quiet_NaN();
+}
+
+inline void SetInvalid(mmind::eye::PointXYZBGR &point) {
+  point.x = point.y = point.z = std::numeric_limits<float>::quiet_NaN();
+  point.b = point.g = point.r = 0;
+  point.a = 255;
+}
+
+inline void SetInvalid(mmind::eye::NormalVector &normal) {
+  normal.x = normal.y = normal.z = std::numeric_limits<float>::quiet_NaN();
+  normal.curvature = 0;
+}
+
+// Moves a camera-frame point along its viewing ray to depth z; the ray is kept exactly as the SDK computed it
+inline const mmind::eye::PointXYZ &AlongRay(const mmind::eye::PointXYZ &point, const float *depth, size_t col,
+                                            mmind::eye::PointXYZ &moved) {
+  if (depth == nullptr) return point;
+  const float scale = point.z > 0 ? depth[col] / point.z : std::numeric_limits<float>::quiet_NaN();
+  moved.x = point.x * scale;
+  moved.y = point.y * scale;
+  moved.z = point.z * scale;
+  return moved;
+}
+
+template <typename Cloud>
+bool Covers(const Cloud *cloud, const cv::Rect &region) {
+  return cloud != nullptr && region.x >= 0 && region.y >= 0 &&
+         static_cast<size_t>(region.x + region.width) <= cloud->width() &&
+         static_cast<size_t>(region.y + region.height) <= cloud->height();
+}
+
+template <typename Cloud>
+Cloud *Prepare(Cloud *target, bool usable, const cv::Rect &region) {
+  if (target == nullptr) return nullptr;
+  if (!usable) {
+    target->release();
+    return nullptr;
+  }
+  target->resize(static_cast<size_t>(region.width), static_cast<size_t>(region.height));
+  return target;
+}
+
+// One pass over the region: each pixel is read and transformed once, then scattered to every requested
+// output. kNormalSource selects whether coordinates (and normals) come from the cloud with normals.
+// Normals always come from the SDK estimate, also when the depth source moves the points.
+template <bool kNormalSource>
+void FuseRows(const Affine &affine, const PointCloudTransformer::FusedSource &source,
+              const PointCloudTransformer::FusedTargets &targets, size_t rowBegin, size_t rowEnd) {
+  const cv::Rect &region = source.region;
+  const size_t width = static_cast<size_t>(region.width);
+  const size_t sourceWidth = kNormalSource ? source.normals->width() : source.points->width();
+  const size_t colorWidth = source.colors != nullptr ? source.colors->width() : 0;
+  const mmind::eye::PointXYZWithNormals *normals = kNormalSource ? source.normals->data() : nullptr;
+  const mmind::eye::PointXYZ *points = kNormalSource ? nullptr : source.points->data();
+  const mmind::eye::PointXYZBGR *colors = source.colors != nullptr ? source.colors->data() : nullptr;
+
+  mmind::eye::PointXYZ *outPoints = targets.points != nullptr ? targets.points->data() : nullptr;
+  mmind::eye::PointXYZWithNormals *outNormals =
+      targets.pointsWithNormals != nullptr ? targets.pointsWithNormals->data() : nullptr;
+  mmind::eye::PointXYZBGR *outTextured = targets.textured != nullptr ? targets.textured->data() : nullptr;
+  mmind::eye::PointXYZBGRWithNormals *outTexturedNormals =
+      targets.texturedWithNormals != nullptr ? targets.texturedWithNormals->data() : nullptr;
+  const bool needNormals = outNormals != nullptr || outTexturedNormals != nullptr;
+
+  for (size_t row = rowBegin; row < rowEnd; ++row) {
+    const float *mask = source.mask != nullptr ? source.mask->ptr<float>(static_cast<int>(row)) : nullptr;
+    const float *depth = source.depth != nullptr ? source.depth->ptr<float>(static_cast<int>(row)) : nullptr;
+    const size_t in = (region.y + row) * sourceWidth + region.x;
+    const size_t colorIn = (region.y + row) * colorWidth + region.x;
+    for (size_t col = 0, out = row * width; col < width; ++col, ++out) {
+      mmind::eye::PointXYZ point;
+      mmind::eye::PointXYZ moved;
+      mmind::eye::NormalVector normal;
+      const bool valid = (mask == nullptr || mask[col] > 0) && (depth == nullptr || depth[col] > 0);
+      if (!valid) {
+        SetInvalid(point);
+        SetInvalid(normal);
+      } else if (kNormalSource) {
+        affine.Apply(AlongRay(normals[in + col].point, depth, col, moved), point);
+        if (needNormals) affine.Rotate(normals[in + col].normal, normal);
+      } else {
+        affine.Apply(AlongRay(points[in + col], depth, col, moved), point);
+      }
+
+      if (outPoints != nullptr) {
+        outPoints[out] = point;
+      }
+      if (outNormals != nullptr) {
+        outNormals[out].point = point;
+        outNormals[out].normal = normal;
+      }
+      if (outTextured != nullptr || outTexturedNormals != nullptr) {
+        mmind::eye::PointXYZBGR colored;
+        if (valid) {
+          colored.x = point.x;
+          colored.y = point.y;
+          colored.z = point.z;
+          colored.rgb = colors[colorIn + col].rgb;
+        } else {
+          SetInvalid(colored);
+        }
+        if (outTextured != nullptr) {
+          CopyPoint(colored, outTextured[out]);
+        }
+        if (outTexturedNormals != nullptr) {
+          CopyPoint(colored, outTexturedNormals[out].colorPoint);
+          outTexturedNormals[out].normal = normal;
+        }
+      }
+    }
+  }
+}
+
+template <typename Cloud>
+void TransformCloud(const mmind::eye::FrameTransformation &transformation, const Cloud &source, Cloud &target,
+                    bool parallel) {
+  if (source.isEmpty()) {
+    target.release();
+    return;
+  }
+
+  const size_t width = source.width();
+  const size_t height = source.height();
+  target.resize(width, height);
+
+  const Affine affine(transformation);
+  const auto *in = source.data();
+  auto *out = target.data();
+  auto body = [&affine, in, out, width](size_t rowBegin, size_t rowEnd) {
+    for (size_t i = rowBegin * width; i < rowEnd * width; ++i) {
+      affine.Apply(in[i], out[i]);
+      CopyColor(in[i], out[i]);
+    }
+  };
+
+  if (parallel) {
+    ThreadPool::Shared().ParallelFor(0, height, kRowsPerTask, body);
+  } else {
+    body(0, height);
+  }
+}
+}  // namespace
+
+void PointCloudTransformer::TransformFused(const mmind::eye::FrameTransformation &transformation,
+                                           const FusedSource &source, const FusedTargets &targets, bool parallel) {
+  const cv::Rect &region = source.region;
+  const bool hasNormals = Covers(source.normals, region);
+  const bool hasPoints = hasNormals || Covers(source.points, region);
+  const bool hasColors = Covers(source.colors, region);
+  const bool hasMask = source.mask == nullptr || source.mask->size() == region.size();
+  const bool hasDepth = source.depth == nullptr || source.depth->size() == region.size();
+  const bool usable = !region.empty() && hasPoints && hasMask && hasDepth;
+
+  FusedTargets prepared;
+  prepared.points = Prepare(targets.points, usable, region);
+  prepared.pointsWithNormals = Prepare(targets.pointsWithNormals, usable && hasNormals, region);
+  prepared.textured = Prepare(targets.textured, usable && hasColors, region);
+  prepared.texturedWithNormals = Prepare(targets.texturedWithNormals, usable && hasNormals && hasColors, region);
+  if (prepared.points == nullptr && prepared.pointsWithNormals == nullptr && prepared.textured == nullptr &&
+      prepared.texturedWithNormals == nullptr) {
+    return;
+  }
+
+  const Affine affine(transformation);
+  auto body = [&](size_t rowBegin, size_t rowEnd) {
+    if (hasNormals) {
+      FuseRows<true>(affine, source, prepared, rowBegin, rowEnd);
+    } else {
+      FuseRows<false>(affine, source, prepared, rowBegin, rowEnd);
+    }
+  };
+
+  const size_t height = static_cast<size_t>(region.height);
+  if (parallel) {
+    ThreadPool::Shared().ParallelFor(0, height, kRowsPerTask, body);
+  } else {
+    body(0, height);
+  }
+}
+
+void PointCloudTransformer::Transform(const mmind::eye::FrameTransformation &transformation,
+                                      const mmind::eye::PointCloud &source, mmind::eye::PointCloud &target,
+                                      bool parallel) {
+  TransformCloud(transformation, source, target, parallel);
+}
+
+void PointCloudTransformer::Transform(const mmind::eye::FrameTransformation &transformation,
+                                      const mmind::eye::TexturedPointCloud &source,
+                                      mmind::eye::TexturedPointCloud &target, bool parallel) {
+  TransformCloud(transformation, source, target, parallel);
+}
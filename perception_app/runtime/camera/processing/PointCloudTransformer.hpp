@@ -0,0 +1,67 @@
+#pragma once
+
+#include "area_scan_3d_camera/Frame2DAnd3D.h"
+#include "area_scan_3d_camera/Frame3D.h"
+#include "CommonTypes.h"
+#include <opencv2/core.hpp>
+
+/**
+ * @brief 点云刚体变换内核
+ *
+ * 与 SDK 的 transformPointCloud / transformTexturedPointCloud 计算相同（p' = R * p + t，
+ * 无效点保持 NaN），但结果写入调用方提供的点云：目标点云尺寸不变时不重新分配内存，
+ * 可与帧缓冲池配合复用点云存储。按行切分到共享线程池并行执行。TransformFused 在同一次遍历中
+ * 生成无纹理 / 有纹理、带 / 不带法线的任意组合，并可同时按深度裁剪区域截取。
+ */
+class PointCloudTransformer {
+public:
+    /**
+     * @brief 变换无纹理点云
+     * @param transformation 相机坐标系到目标坐标系的变换
+     * @param source 源点云
+     * @param target 输出点云，按需调整大小，可与 source 为同一对象
+     * @param parallel 是否按行并行
+     */
+    static void Transform(const mmind::eye::FrameTransformation& transformation, const mmind::eye::PointCloud& source,
+                          mmind::eye::PointCloud& target, bool parallel = true);
+
+    /**
+     * @brief 变换有纹理点云，颜色原样复制
+     */
+    static void Transform(const mmind::eye::FrameTransformation& transformation,
+                          const mmind::eye::TexturedPointCloud& source, mmind::eye::TexturedPointCloud& target,
+                          bool parallel = true);
+
+    /**
+     * @brief TransformFused 的输入，各点云均为相机坐标系下与深度图逐像素对齐的有序点云
+     */
+    struct FusedSource {
+        const mmind::eye::PointCloud* points = nullptr;              // 坐标，normals 非空时不使用
+        const mmind::eye::PointCloudWithNormals* normals = nullptr;  // 坐标和法线，输出带法线点云时必须提供
+        const mmind::eye::TexturedPointCloud* colors = nullptr;      // 只取颜色，输出有纹理点云时必须提供
+        cv::Rect region;                // 处理的像素区域，输出为该区域大小
+        const cv::Mat* mask = nullptr;  // region 大小的 CV_32FC1，非正值（含 NaN）的像素输出无效点；为空时不过滤
+        // region 大小的 CV_32FC1（如时域滤波后的深度），非空时每个点沿相机视线移到该深度，非正值的像素输出无效点
+        const cv::Mat* depth = nullptr;
+    };
+
+    /**
+     * @brief TransformFused 的输出，为空的输出不计算
+     */
+    struct FusedTargets {
+        mmind::eye::PointCloud* points = nullptr;
+        mmind::eye::PointCloudWithNormals* pointsWithNormals = nullptr;
+        mmind::eye::TexturedPointCloud* textured = nullptr;
+        mmind::eye::TexturedPointCloudWithNormals* texturedWithNormals = nullptr;
+    };
+
+    /**
+     * @brief 一次遍历生成多种变换点云
+     *
+     * 每个像素只读取一次坐标、法线和颜色，只做一次变换（法线只旋转），再写入所有请求的输出，
+     * 有纹理和无纹理的带法线输出共用同一份法线。缺少所需来源或尺寸不一致的输出被清空。
+     * 输出不能与任何来源为同一对象。
+     */
+    static void TransformFused(const mmind::eye::FrameTransformation& transformation, const FusedSource& source,
+                               const FusedTargets& targets, bool parallel = true);
+};
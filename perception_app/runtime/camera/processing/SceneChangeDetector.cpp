@@ -0,0 +1,280 @@
+#include "SceneChangeDetector.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include "utils/ThreadPool.hpp"
+
+namespace {
+constexpr size_t kSignatureRowsPerTask = 2;
+constexpr int kMinCellSize = 2;
+// 64 rows of 255 still fit the 16-bit color accumulators
+constexpr int kMaxCellSize = 64;
+
+// Upper bound on the body calls ForEachRow makes: every call but the last covers at least the grain
+size_t RowTaskCount(size_t rows) { return (rows + kSignatureRowsPerTask - 1) / kSignatureRowsPerTask; }
+
+template <typename Body>
+void ForEachRow(size_t rows, bool parallel, Body &&body) {
+  if (parallel) {
+    ThreadPool::Shared().ParallelFor(0, rows, kSignatureRowsPerTask, body);
+  } else {
+    body(0, rows);
+  }
+}
+}  // namespace
+
+SceneChangeDetector::SceneChangeDetector(const Options &options) : options_(options), useAvx2_(CpuSupportsAvx2()) {
+  options_.cell_size = std::min(std::max(options_.cell_size, kMinCellSize), kMaxCellSize);
+  options_.block_cells = std::max(options_.block_cells, 1);
+  options_.min_changed_ratio = std::max(options_.min_changed_ratio, 0.0f);
+}
+
+void SceneChangeDetector::Reset() {
+  hasReference_ = false;
+  skipped_ = 0;
+}
+
+SceneChangeDetector::Result SceneChangeDetector::Update(const cv::Mat &color, const cv::Mat &depth) {
+  ComputeSignature(color, depth, current_);
+  stats_.frames++;
+
+  Result result;
+  const bool comparable = hasReference_ && current_.depthCols == reference_.depthCols &&
+                          current_.depthRows == reference_.depthRows &&
+                          current_.colorCols == reference_.colorCols && current_.colorRows == reference_.colorRows;
+  if (comparable) {
+    size_t depthBlocks = 0;
+    size_t colorBlocks = 0;
+    const size_t depthChanged = CountChangedBlocks(current_.depth, reference_.depth, current_.depthCols,
+                                                   current_.depthRows, options_.depth_threshold_mm, depthBlocks);
+    const size_t colorChanged = CountChangedBlocks(current_.color, reference_.color, current_.colorCols,
+                                                   current_.colorRows, options_.color_threshold, colorBlocks);
+    result.changed_blocks = depthChanged + colorChanged;
+    result.blocks = depthBlocks + colorBlocks;
+
+    // Depth and color grids differ in size, so each is judged by its own share of changed blocks
+    auto exceeds = [this](size_t changed, size_t blocks) {
+      return changed > 0 && static_cast<float>(changed) > options_.min_changed_ratio * static_cast<float>(blocks);
+    };
+    result.changed = exceeds(depthChanged, depthBlocks) || exceeds(colorChanged, colorBlocks);
+    if (!result.changed && options_.max_skipped_frames > 0 && ++skipped_ >= options_.max_skipped_frames) {
+      // Periodic refresh, so consumers never go stale for longer than the configured number of frames
+      result.changed = true;
+    }
+  }
+
+  if (result.changed) {
+    // The changed frame becomes the reference; its buffers are reused for the next signature
+    std::swap(reference_, current_);
+    hasReference_ = true;
+    skipped_ = 0;
+    stats_.changed++;
+  }
+  return result;
+}
+
+void SceneChangeDetector::ComputeSignature(const cv::Mat &color, const cv::Mat &depth, Signature &signature) {
+  if (!depth.empty() && depth.type() == CV_32FC1 && options_.depth_threshold_mm > 0) {
+    ReduceDepth(depth, signature);
+  } else {
+    signature.depthCols = signature.depthRows = 0;
+  }
+
+  if (!color.empty() && color.type() == CV_8UC3 && options_.color_threshold > 0) {
+    ReduceColor(color, signature);
+  } else {
+    signature.colorCols = signature.colorRows = 0;
+  }
+}
+
+void SceneChangeDetector::ReduceDepth(const cv::Mat &depth, Signature &signature) {
+  const size_t cell = static_cast<size_t>(options_.cell_size);
+  const size_t cols = static_cast<size_t>(depth.cols) / cell;
+  const size_t rows = static_cast<size_t>(depth.rows) / cell;
+  signature.depthCols = cols;
+  signature.depthRows = rows;
+  signature.depth.resize(cols * rows);
+
+  // Pixels past the last whole cell are ignored
+  const size_t width = cols * cell;
+  float *out = signature.depth.data();
+  // Each task claims its own stretch of the detector's accumulators, so frames reuse them
+  depthSum_.resize(RowTaskCount(rows) * width);
+  depthCount_.resize(depthSum_.size());
+  std::atomic<size_t> nextTask(0);
+  ForEachRow(rows, options_.parallel, [&](size_t rowBegin, size_t rowEnd) {
+    const size_t task = nextTask++;
+    float *sum = depthSum_.data() + task * width;
+    float *count = depthCount_.data() + task * width;
+    for (size_t row = rowBegin; row < rowEnd; ++row) {
+      std::fill(sum, sum + width, 0.0f);
+      std::fill(count, count + width, 0.0f);
+      for (size_t k = 0; k < cell; ++k) {
+        const float *in = depth.ptr<float>(static_cast<int>(row * cell + k));
+#if defined(PERCEPTION_SIMD_X86)
+        if (useAvx2_) {
+          AccumulateDepthRowAvx2(in, sum, count, width);
+          continue;
+        }
+#elif defined(PERCEPTION_SIMD_NEON)
+        AccumulateDepthRowNeon(in, sum, count, width);
+        continue;
+#endif
+        AccumulateDepthRowScalar(in, sum, count, width);
+      }
+
+      for (size_t col = 0; col < cols; ++col) {
+        float cellSum = 0.0f;
+        float cellCount = 0.0f;
+        for (size_t j = col * cell; j < (col + 1) * cell; ++j) {
+          cellSum += sum[j];
+          cellCount += count[j];
+        }
+        out[row * cols + col] = cellCount > 0 ? cellSum / cellCount : 0.0f;
+      }
+    }
+  });
+}
+
+void SceneChangeDetector::ReduceColor(const cv::Mat &color, Signature &signature) {
+  const size_t cell = static_cast<size_t>(options_.cell_size);
+  const size_t cols = static_cast<size_t>(color.cols) / cell;
+  const size_t rows = static_cast<size_t>(color.rows) / cell;
+  signature.colorCols = cols;
+  signature.colorRows = rows;
+  signature.color.resize(cols * rows);
+
+  // B, G and R are summed alike: the signature tracks brightness, which is all a change test needs
+  const size_t bytes = cols * cell * 3;
+  const float scale = 1.0f / static_cast<float>(cell * cell * 3);
+  float *out = signature.color.data();
+  colorSum_.resize(RowTaskCount(rows) * bytes);
+  std::atomic<size_t> nextTask(0);
+  ForEachRow(rows, options_.parallel, [&](size_t rowBegin, size_t rowEnd) {
+    uint16_t *sum = colorSum_.data() + nextTask++ * bytes;
+    for (size_t row = rowBegin; row < rowEnd; ++row) {
+      std::fill(sum, sum + bytes, static_cast<uint16_t>(0));
+      for (size_t k = 0; k < cell; ++k) {
+        const uint8_t *in = color.ptr<uint8_t>(static_cast<int>(row * cell + k));
+#if defined(PERCEPTION_SIMD_X86)
+        if (useAvx2_) {
+          AccumulateColorRowAvx2(in, sum, bytes);
+          continue;
+        }
+#elif defined(PERCEPTION_SIMD_NEON)
+        AccumulateColorRowNeon(in, sum, bytes);
+        continue;
+#endif
+        AccumulateColorRowScalar(in, sum, bytes);
+      }
+
+      for (size_t col = 0; col < cols; ++col) {
+        uint32_t cellSum = 0;
+        for (size_t j = col * cell * 3; j < (col + 1) * cell * 3; ++j) {
+          cellSum += sum[j];
+        }
+        out[row * cols + col] = static_cast<float>(cellSum) * scale;
+      }
+    }
+  });
+}
+
+size_t SceneChangeDetector::CountChangedBlocks(const std::vector<float> &current, const std::vector<float> &reference,
+                                               size_t cols, size_t rows, float threshold, size_t &blocks) const {
+  const size_t block = static_cast<size_t>(options_.block_cells);
+  size_t changed = 0;
+  for (size_t blockRow = 0; blockRow < rows; blockRow += block) {
+    const size_t rowEnd = std::min(blockRow + block, rows);
+    for (size_t blockCol = 0; blockCol < cols; blockCol += block) {
+      const size_t colEnd = std::min(blockCol + block, cols);
+      float sad = 0.0f;
+      for (size_t row = blockRow; row < rowEnd; ++row) {
+        const float *a = current.data() + row * cols;
+        const float *b = reference.data() + row * cols;
+        for (size_t col = blockCol; col < colEnd; ++col) {
+          sad += std::abs(a[col] - b[col]);
+        }
+      }
+      // Edge blocks may be partial; the threshold applies to the mean difference per cell
+      const float cells = static_cast<float>((rowEnd - blockRow) * (colEnd - blockCol));
+      if (sad > threshold * cells) {
+        changed++;
+      }
+      blocks++;
+    }
+  }
+  return changed;
+}
+
+void SceneChangeDetector::AccumulateDepthRowScalar(const float *depth, float *sum, float *count, size_t width) {
+  for (size_t col = 0; col < width; ++col) {
+    // Zero and NaN depth are invalid and do not contribute
+    if (depth[col] > 0) {
+      sum[col] += depth[col];
+      count[col] += 1.0f;
+    }
+  }
+}
+
+void SceneChangeDetector::AccumulateColorRowScalar(const uint8_t *color, uint16_t *sum, size_t bytes) {
+  for (size_t i = 0; i < bytes; ++i) {
+    sum[i] = static_cast<uint16_t>(sum[i] + color[i]);
+  }
+}
+
+#if defined(PERCEPTION_SIMD_X86)
+PERCEPTION_TARGET_AVX2 void SceneChangeDetector::AccumulateDepthRowAvx2(const float *depth, float *sum, float *count,
+                                                                        size_t width) {
+  const __m256 zero = _mm256_setzero_ps();
+  const __m256 one = _mm256_set1_ps(1.0f);
+
+  size_t col = 0;
+  for (; col + 8 <= width; col += 8) {
+    const __m256 value = _mm256_loadu_ps(depth + col);
+    const __m256 valid = _mm256_cmp_ps(value, zero, _CMP_GT_OQ);
+    _mm256_storeu_ps(sum + col, _mm256_add_ps(_mm256_loadu_ps(sum + col), _mm256_and_ps(value, valid)));
+    _mm256_storeu_ps(count + col, _mm256_add_ps(_mm256_loadu_ps(count + col), _mm256_and_ps(one, valid)));
+  }
+
+  AccumulateDepthRowScalar(depth + col, sum + col, count + col, width - col);
+}
+
+PERCEPTION_TARGET_AVX2 void SceneChangeDetector::AccumulateColorRowAvx2(const uint8_t *color, uint16_t *sum,
+                                                                        size_t bytes) {
+  size_t i = 0;
+  for (; i + 16 <= bytes; i += 16) {
+    const __m256i widened = _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i *>(color + i)));
+    __m256i *acc = reinterpret_cast<__m256i *>(sum + i);
+    _mm256_storeu_si256(acc, _mm256_add_epi16(_mm256_loadu_si256(acc), widened));
+  }
+
+  AccumulateColorRowScalar(color + i, sum + i, bytes - i);
+}
+#endif
+
+#if defined(PERCEPTION_SIMD_NEON)
+void SceneChangeDetector::AccumulateDepthRowNeon(const float *depth, float *sum, float *count, size_t width) {
+  const float32x4_t zero = vdupq_n_f32(0.0f);
+  const uint32x4_t one = vreinterpretq_u32_f32(vdupq_n_f32(1.0f));
+
+  size_t col = 0;
+  for (; col + 4 <= width; col += 4) {
+    const float32x4_t value = vld1q_f32(depth + col);
+    const uint32x4_t valid = vcgtq_f32(value, zero);
+    const float32x4_t kept = vreinterpretq_f32_u32(vandq_u32(vreinterpretq_u32_f32(value), valid));
+    vst1q_f32(sum + col, vaddq_f32(vld1q_f32(sum + col), kept));
+    vst1q_f32(count + col, vaddq_f32(vld1q_f32(count + col), vreinterpretq_f32_u32(vandq_u32(one, valid))));
+  }
+
+  AccumulateDepthRowScalar(depth + col, sum + col, count + col, width - col);
+}
+
+void SceneChangeDetector::AccumulateColorRowNeon(const uint8_t *color, uint16_t *sum, size_t bytes) {
+  size_t i = 0;
+  for (; i + 8 <= bytes; i += 8) {
+    vst1q_u16(sum + i, vaddw_u8(vld1q_u16(sum + i), vld1_u8(color + i)));
+  }
+
+  AccumulateColorRowScalar(color + i, sum + i, bytes - i);
+}
+#endif
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <opencv2/core.hpp>
+#include "utils/SimdSupport.hpp"
+
+/**
+ * @brief 场景变化检测
+ *
+ * 将深度图和彩色图按 cell_size 下采样为签名（每个签名像素为对应区域的有效深度均值和 BGR 亮度均值），
+ * 与上一次判定为变化的帧（参考帧）的签名按 block_cells x block_cells 的块计算平均绝对差（块 SAD），
+ * 超过阈值的块占比大于 min_changed_ratio 时判定场景变化，并以当前帧作为新的参考帧。参考帧只在
+ * 变化时更新，缓慢漂移会逐渐累积直到触发，不会被逐帧比较漏掉。
+ *
+ * 签名计算是唯一需要遍历全图的步骤：每个签名行先把 cell_size 个图像行纵向累加（AVX2 / NEON 按
+ * 运行时检测选择，否则为标量），再横向归并，按签名行切分到共享线程池并行执行。签名缓冲和各并行
+ * 任务的累加缓冲都由检测器持有，在帧之间复用。一个检测器对应一路相机，非线程安全。
+ */
+class SceneChangeDetector {
+public:
+    struct Options {
+        bool enable = false;
+        int cell_size = 8;                 // 签名下采样倍数，取值 [2, 64]
+        int block_cells = 4;               // SAD 块边长（签名像素）
+        float depth_threshold_mm = 10.0f;  // 块内深度平均绝对差阈值，<= 0 时不比较深度
+        float color_threshold = 12.0f;     // 块内亮度（0-255）平均绝对差阈值，<= 0 时不比较彩色
+        float min_changed_ratio = 0.0f;    // 变化块占比超过该值才判定变化，0 表示任一块变化即可
+        int max_skipped_frames = 0;        // 连续未变化帧数达到该值时强制判定变化，0 表示不限制
+        bool parallel = true;
+    };
+
+    struct Result {
+        bool changed = true;        // 是否判定为场景变化（含首帧、分辨率变化和强制刷新）
+        size_t changed_blocks = 0;  // 超过阈值的块数（深度与彩色之和）
+        size_t blocks = 0;          // 参与比较的块数
+    };
+
+    struct Stats {
+        uint64_t frames = 0;   // 检测的帧数
+        uint64_t changed = 0;  // 判定为变化的帧数
+    };
+
+    explicit SceneChangeDetector(const Options& options);
+
+    /**
+     * @brief 与参考帧比较，变化时以当前帧作为新的参考帧
+     * @param color CV_8UC3 彩色图，为空时只比较深度
+     * @param depth CV_32FC1 深度图（毫米），为空时只比较彩色
+     */
+    Result Update(const cv::Mat& color, const cv::Mat& depth);
+
+    /**
+     * @brief 丢弃参考帧，下一帧必定判定为变化
+     */
+    void Reset();
+
+    const Stats& GetStats() const { return stats_; }
+
+private:
+    // 按行主序存储的下采样图，深度无有效像素的签名像素为 0
+    struct Signature {
+        size_t depthCols = 0;
+        size_t depthRows = 0;
+        std::vector<float> depth;
+        size_t colorCols = 0;
+        size_t colorRows = 0;
+        std::vector<float> color;
+    };
+
+    void ComputeSignature(const cv::Mat& color, const cv::Mat& depth, Signature& signature);
+    void ReduceDepth(const cv::Mat& depth, Signature& signature);
+    void ReduceColor(const cv::Mat& color, Signature& signature);
+
+    // 超过阈值的块数，blocks 累加参与比较的块数
+    size_t CountChangedBlocks(const std::vector<float>& current, const std::vector<float>& reference, size_t cols,
+                              size_t rows, float threshold, size_t& blocks) const;
+
+    // 纵向累加一行：深度累加有效值及其个数，彩色逐字节累加 BGR
+    static void AccumulateDepthRowScalar(const float* depth, float* sum, float* count, size_t width);
+    static void AccumulateColorRowScalar(const uint8_t* color, uint16_t* sum, size_t bytes);
+#if defined(PERCEPTION_SIMD_X86)
+    static void AccumulateDepthRowAvx2(const float* depth, float* sum, float* count, size_t width);
+    static void AccumulateColorRowAvx2(const uint8_t* color, uint16_t* sum, size_t bytes);
+#endif
+#if defined(PERCEPTION_SIMD_NEON)
+    static void AccumulateDepthRowNeon(const float* depth, float* sum, float* count, size_t width);
+    static void AccumulateColorRowNeon(const uint8_t* color, uint16_t* sum, size_t bytes);
+#endif
+
+private:
+    Options options_;
+    Signature reference_;
+    Signature current_;
+    bool hasReference_ = false;
+    int skipped_ = 0;
+    Stats stats_;
+    bool useAvx2_;
+    // 纵向累加缓冲，每个并行任务占用一段（宽度为累加行长度）
+    std::vector<float> depthSum_;
+    std::vector<float> depthCount_;
+    std::vector<uint16_t> colorSum_;
+};
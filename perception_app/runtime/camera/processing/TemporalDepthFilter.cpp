@@ -0,0 +1,139 @@
+#include "TemporalDepthFilter.hpp"
+#include <algorithm>
+#include <cmath>
+#include "utils/ThreadPool.hpp"
+
+namespace {
+constexpr size_t kRowsPerTask = 16;
+}  // namespace
+
+TemporalDepthFilter::TemporalDepthFilter(const Options &options) : options_(options), useAvx2_(CpuSupportsAvx2()) {
+  options_.alpha = std::min(std::max(options_.alpha, 0.0f), 1.0f);
+  options_.reset_threshold_mm = std::max(options_.reset_threshold_mm, 0.0f);
+  options_.reset_ratio = std::max(options_.reset_ratio, 0.0f);
+}
+
+void TemporalDepthFilter::Reset() {
+  state_.release();
+  frames_ = 0;
+}
+
+void TemporalDepthFilter::Apply(const cv::Mat &depth, cv::Mat &filtered) {
+  if (depth.empty() || depth.type() != CV_32FC1) {
+    filtered.release();
+    return;
+  }
+
+  if (state_.size() != depth.size()) {
+    // First frame of a stream (or a new resolution): nothing to average with yet
+    depth.copyTo(state_);
+    if (&filtered != &depth) {
+      depth.copyTo(filtered);
+    }
+    frames_ = 1;
+    return;
+  }
+
+  filtered.create(depth.size(), CV_32FC1);
+  const Params params {options_.alpha, options_.reset_threshold_mm, options_.reset_ratio};
+  const size_t width = static_cast<size_t>(depth.cols);
+  auto body = [&](size_t rowBegin, size_t rowEnd) {
+    for (size_t row = rowBegin; row < rowEnd; ++row) {
+      const float *in = depth.ptr<float>(static_cast<int>(row));
+      float *state = state_.ptr<float>(static_cast<int>(row));
+      float *out = filtered.ptr<float>(static_cast<int>(row));
+#if defined(PERCEPTION_SIMD_X86)
+      if (useAvx2_) {
+        FilterRowAvx2(params, in, state, out, width);
+        continue;
+      }
+#elif defined(PERCEPTION_SIMD_NEON)
+      FilterRowNeon(params, in, state, out, width);
+      continue;
+#endif
+      FilterRowScalar(params, in, state, out, width);
+    }
+  };
+
+  const size_t height = static_cast<size_t>(depth.rows);
+  if (options_.parallel) {
+    ThreadPool::Shared().ParallelFor(0, height, kRowsPerTask, body);
+  } else {
+    body(0, height);
+  }
+  frames_++;
+}
+
+// Every kernel reads the input and the state of a pixel before writing either, so out may alias depth
+void TemporalDepthFilter::FilterRowScalar(const Params &params, const float *depth, float *state, float *out,
+                                          size_t width) {
+  for (size_t col = 0; col < width; ++col) {
+    const float current = depth[col];
+    const float previous = state[col];
+    const float diff = current - previous;
+    // Comparisons against NaN are false, so invalid depth on either side never blends
+    const bool blend = current > 0 && previous > 0 &&
+                       std::abs(diff) <= params.threshold + params.ratio * current;
+    const float result = blend ? previous + params.alpha * diff : current;
+    out[col] = result;
+    state[col] = current > 0 ? result : previous;
+  }
+}
+
+#if defined(PERCEPTION_SIMD_X86)
+PERCEPTION_TARGET_AVX2 void TemporalDepthFilter::FilterRowAvx2(const Params &params, const float *depth,
+                                                               float *state, float *out, size_t width) {
+  const __m256 zero = _mm256_setzero_ps();
+  const __m256 alpha = _mm256_set1_ps(params.alpha);
+  const __m256 threshold = _mm256_set1_ps(params.threshold);
+  const __m256 ratio = _mm256_set1_ps(params.ratio);
+  const __m256 absMask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff));
+
+  size_t col = 0;
+  for (; col + 8 <= width; col += 8) {
+    const __m256 current = _mm256_loadu_ps(depth + col);
+    const __m256 previous = _mm256_loadu_ps(state + col);
+    const __m256 diff = _mm256_sub_ps(current, previous);
+
+    // Ordered compares are false for NaN, matching the scalar kernel
+    const __m256 currentValid = _mm256_cmp_ps(current, zero, _CMP_GT_OQ);
+    const __m256 previousValid = _mm256_cmp_ps(previous, zero, _CMP_GT_OQ);
+    const __m256 limit = _mm256_fmadd_ps(ratio, current, threshold);
+    const __m256 still = _mm256_cmp_ps(_mm256_and_ps(diff, absMask), limit, _CMP_LE_OQ);
+    const __m256 blend = _mm256_and_ps(_mm256_and_ps(currentValid, previousValid), still);
+
+    const __m256 result = _mm256_blendv_ps(current, _mm256_fmadd_ps(alpha, diff, previous), blend);
+    _mm256_storeu_ps(out + col, result);
+    _mm256_storeu_ps(state + col, _mm256_blendv_ps(previous, result, currentValid));
+  }
+
+  FilterRowScalar(params, depth + col, state + col, out + col, width - col);
+}
+#endif
+
+#if defined(PERCEPTION_SIMD_NEON)
+void TemporalDepthFilter::FilterRowNeon(const Params &params, const float *depth, float *state, float *out,
+                                        size_t width) {
+  const float32x4_t zero = vdupq_n_f32(0.0f);
+  const float32x4_t threshold = vdupq_n_f32(params.threshold);
+
+  size_t col = 0;
+  for (; col + 4 <= width; col += 4) {
+    const float32x4_t current = vld1q_f32(depth + col);
+    const float32x4_t previous = vld1q_f32(state + col);
+    const float32x4_t diff = vsubq_f32(current, previous);
+
+    const uint32x4_t currentValid = vcgtq_f32(current, zero);
+    const uint32x4_t previousValid = vcgtq_f32(previous, zero);
+    const float32x4_t limit = vmlaq_n_f32(threshold, current, params.ratio);
+    const uint32x4_t still = vcleq_f32(vabdq_f32(current, previous), limit);
+    const uint32x4_t blend = vandq_u32(vandq_u32(currentValid, previousValid), still);
+
+    const float32x4_t result = vbslq_f32(blend, vmlaq_n_f32(previous, diff, params.alpha), current);
+    vst1q_f32(out + col, result);
+    vst1q_f32(state + col, vbslq_f32(currentValid, result, previous));
+  }
+
+  FilterRowScalar(params, depth + col, state + col, out + col, width - col);
+}
+#endif
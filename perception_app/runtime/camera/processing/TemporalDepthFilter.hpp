@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstdint>
+#include <opencv2/core.hpp>
+#include "utils/SimdSupport.hpp"
+
+/**
+ * @brief 深度图时域滤波内核
+ *
+ * 对同一相机连续帧的深度逐像素做指数滑动平均：out = prev + alpha * (cur - prev)，结果同时作为
+ * 下一帧的 prev。当前深度与历史值之差超过 reset_threshold_mm + reset_ratio * cur 时判定该像素
+ * 发生了运动，直接采用当前深度并从该值重新开始平均，运动物体不会拖尾。当前帧无效（0 或 NaN）
+ * 的像素输出原值，历史值保留到该像素恢复有效；滤波不会把无效像素变成有效像素。
+ *
+ * 历史状态保存在滤波器内复用的缓冲区中，分辨率变化时自动重新开始。每个像素只有一次读写，
+ * x86 平台 AVX2 + FMA（运行时检测）、ARM64 平台 NEON 内核按行切分到共享线程池并行执行。
+ * 一个滤波器对应一路深度流，非线程安全，同一时刻只能处理一帧。
+ */
+class TemporalDepthFilter {
+public:
+    struct Options {
+        bool enable = false;
+        float alpha = 0.4f;               // 当前帧权重 (0, 1]，越小越平滑，1 等同于不滤波
+        float reset_threshold_mm = 8.0f;  // 运动判定的固定阈值
+        float reset_ratio = 0.01f;        // 运动判定阈值随深度增长的比例（深度噪声随距离增大）
+        bool parallel = true;
+    };
+
+    explicit TemporalDepthFilter(const Options& options);
+
+    /**
+     * @brief 滤波一帧并更新历史状态
+     * @param depth CV_32FC1 深度图（毫米）
+     * @param filtered 输出同尺寸的 CV_32FC1 深度图，按需调整大小，可与 depth 为同一对象
+     */
+    void Apply(const cv::Mat& depth, cv::Mat& filtered);
+
+    /**
+     * @brief 丢弃历史状态，下一帧原样输出
+     */
+    void Reset();
+
+    const Options& GetOptions() const { return options_; }
+
+    // 已滤波的帧数（自上次重置或分辨率变化起）
+    uint64_t FilteredFrames() const { return frames_; }
+
+private:
+    struct Params {
+        float alpha;
+        float threshold;
+        float ratio;
+    };
+
+    static void FilterRowScalar(const Params& params, const float* depth, float* state, float* out, size_t width);
+#if defined(PERCEPTION_SIMD_X86)
+    static void FilterRowAvx2(const Params& params, const float* depth, float* state, float* out, size_t width);
+#endif
+#if defined(PERCEPTION_SIMD_NEON)
+    static void FilterRowNeon(const Params& params, const float* depth, float* state, float* out, size_t width);
+#endif
+
+private:
+    Options options_;
+    cv::Mat state_;  // 上一帧的滤波结果
+    uint64_t frames_ = 0;
+    bool useAvx2_;
+};
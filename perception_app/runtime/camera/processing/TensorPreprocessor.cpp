@@ -0,0 +1,340 @@
+#include "TensorPreprocessor.hpp"
+#include <algorithm>
+#include <cmath>
+#include <nlohmann/json.hpp>
+#include "Logger.hpp"
+#include "utils/ThreadPool.hpp"
+
+namespace {
+constexpr size_t kRowsPerTask = 8;
+
+template <typename Body>
+void ForEachRow(size_t rows, bool parallel, Body &&body) {
+  if (parallel) {
+    ThreadPool::Shared().ParallelFor(0, rows, kRowsPerTask, body);
+  } else {
+    body(0, rows);
+  }
+}
+
+// Round-to-nearest-even like the vector conversion, so every path produces identical bytes
+void Store(float value, float *out) { *out = value; }
+void Store(float value, uint8_t *out) {
+  *out = static_cast<uint8_t>(std::lrint(std::min(std::max(value, 0.0f), 255.0f)));
+}
+
+bool ReadTriple(const nlohmann::json &config, const char *key, float (&values)[3]) {
+  if (!config.contains(key)) return true;
+  const auto &array = config[key];
+  if (!array.is_array() || array.size() != 3) return false;
+  for (size_t i = 0; i < 3; ++i) {
+    values[i] = array[i].get<float>();
+  }
+  return true;
+}
+}  // namespace
+
+bool TensorPreprocessor::ParseOptions(const nlohmann::json &config, Options &options) {
+  Options parsed = options;
+  try {
+    if (config.contains("input_size")) {
+      const auto &size = config["input_size"];
+      if (!size.is_array() || size.size() != 2) {
+        LOG_ERROR_STREAM << "input_size must be [width, height]";
+        return false;
+      }
+      parsed.width = size[0].get<int>();
+      parsed.height = size[1].get<int>();
+    }
+
+    if (config.contains("preprocessing")) {
+      const auto &preprocessing = config["preprocessing"];
+      parsed.normalize = preprocessing.value("normalize", parsed.normalize);
+      if (!ReadTriple(preprocessing, "mean", parsed.mean) || !ReadTriple(preprocessing, "std", parsed.std)) {
+        LOG_ERROR_STREAM << "preprocessing mean and std must have 3 values";
+        return false;
+      }
+
+      const std::string order = preprocessing.value("channel_order", std::string(parsed.rgb ? "RGB" : "BGR"));
+      const std::string output =
+          preprocessing.value("output_type", std::string(parsed.output == OutputType::UInt8 ? "uint8" : "float32"));
+      if ((order != "RGB" && order != "BGR") || (output != "float32" && output != "uint8")) {
+        LOG_ERROR_STREAM << "Unknown preprocessing channel_order '" << order << "' or output_type '" << output << "'";
+        return false;
+      }
+      parsed.rgb = order == "RGB";
+      parsed.output = output == "uint8" ? OutputType::UInt8 : OutputType::Float32;
+      parsed.include_depth = preprocessing.value("include_depth", parsed.include_depth);
+      parsed.depth_scale = preprocessing.value("depth_scale", parsed.depth_scale);
+    }
+  } catch (const nlohmann::json::exception &e) {
+    LOG_ERROR_STREAM << "Invalid preprocessing config: " << e.what();
+    return false;
+  }
+
+  if (parsed.width <= 0 || parsed.height <= 0 ||
+      std::any_of(std::begin(parsed.std), std::end(parsed.std), [](float value) { return !(value > 0.0f); })) {
+    LOG_ERROR_STREAM << "Invalid preprocessing input_size " << parsed.width << "x" << parsed.height << " or std";
+    return false;
+  }
+  options = parsed;
+  return true;
+}
+
+TensorPreprocessor::TensorPreprocessor(const Options &options) : options_(options), useAvx2_(CpuSupportsAvx2()) {
+  options_.width = std::max(options_.width, 1);
+  options_.height = std::max(options_.height, 1);
+
+  // (x / 255 - mean) / std folded into one multiply-add per value
+  const bool normalize = options_.normalize && options_.output == OutputType::Float32;
+  for (int k = 0; k < 3; ++k) {
+    params_.source[k] = options_.rgb ? 2 - k : k;
+    params_.scale[k] = normalize ? 1.0f / (255.0f * options_.std[k]) : 1.0f;
+    params_.bias[k] = normalize ? -options_.mean[k] / options_.std[k] : 0.0f;
+  }
+}
+
+const cv::Mat &TensorPreprocessor::Process(const cv::Mat &color, const cv::Mat &depth) {
+  if (color.empty() || color.type() != CV_8UC3) {
+    tensor_.release();
+    return tensor_;
+  }
+
+  // Interpolation tables only change with the input resolution
+  if (columns_.source != color.cols || rows_.source != color.rows) {
+    BuildAxis(color.cols, options_.width, 3, columns_);
+    BuildAxis(color.rows, options_.height, 1, rows_);
+  }
+  const bool hasDepth = options_.include_depth && !depth.empty() && depth.type() == CV_32FC1;
+  if (hasDepth && depth.size() != depthSource_) {
+    BuildNearest(depth.cols, options_.width, depthColumns_);
+    BuildNearest(depth.rows, options_.height, depthRows_);
+    depthSource_ = depth.size();
+  }
+
+  tensor_.create(Channels() * options_.height, options_.width,
+                 options_.output == OutputType::Float32 ? CV_32FC1 : CV_8UC1);
+  const size_t height = static_cast<size_t>(options_.height);
+  ForEachRow(height, options_.parallel, [&](size_t rowBegin, size_t rowEnd) {
+    ProcessColorRows(color, rowBegin, rowEnd);
+    if (hasDepth) {
+      ProcessDepthRows(depth, rowBegin, rowEnd);
+    } else if (options_.include_depth) {
+      // Planes are contiguous, so the rows of this task form one span
+      uint8_t *begin = tensor_.ptr<uint8_t>(static_cast<int>(3 * height + rowBegin));
+      std::fill(begin, begin + (rowEnd - rowBegin) * tensor_.step[0], static_cast<uint8_t>(0));
+    }
+  });
+  return tensor_;
+}
+
+// Same sampling positions as cv::resize with INTER_LINEAR
+void TensorPreprocessor::BuildAxis(int source, int target, int stride, Axis &axis) {
+  axis.source = source;
+  axis.first.resize(static_cast<size_t>(target));
+  axis.second.resize(static_cast<size_t>(target));
+  axis.weight.resize(static_cast<size_t>(target));
+
+  const double scale = static_cast<double>(source) / target;
+  for (int i = 0; i < target; ++i) {
+    const double position = std::max((i + 0.5) * scale - 0.5, 0.0);
+    int first = static_cast<int>(position);
+    float weight = static_cast<float>(position - first);
+    if (first >= source - 1) {
+      first = source - 1;
+      weight = 0.0f;
+    }
+    axis.first[i] = first * stride;
+    axis.second[i] = std::min(first + 1, source - 1) * stride;
+    axis.weight[i] = weight;
+  }
+}
+
+void TensorPreprocessor::BuildNearest(int source, int target, std::vector<int32_t> &nearest) {
+  nearest.resize(static_cast<size_t>(target));
+  const double scale = static_cast<double>(source) / target;
+  for (int i = 0; i < target; ++i) {
+    nearest[i] = std::min(static_cast<int>((i + 0.5) * scale), source - 1);
+  }
+}
+
+void TensorPreprocessor::ProcessColorRows(const cv::Mat &color, size_t rowBegin, size_t rowEnd) {
+  // One blended source row per output row; kept per thread so steady state does not allocate
+  thread_local std::vector<float> row;
+  const size_t count = static_cast<size_t>(color.cols) * 3;
+  row.resize(count);
+
+  const size_t width = static_cast<size_t>(options_.width);
+  const int height = options_.height;
+  for (size_t y = rowBegin; y < rowEnd; ++y) {
+    const uint8_t *top = color.ptr<uint8_t>(rows_.first[y]);
+    const uint8_t *bottom = color.ptr<uint8_t>(rows_.second[y]);
+    const float weight = rows_.weight[y];
+#if defined(PERCEPTION_SIMD_X86)
+    if (useAvx2_) {
+      BlendRowsAvx2(top, bottom, weight, row.data(), count);
+    } else {
+      BlendRowsScalar(top, bottom, weight, row.data(), count);
+    }
+#elif defined(PERCEPTION_SIMD_NEON)
+    BlendRowsNeon(top, bottom, weight, row.data(), count);
+#else
+    BlendRowsScalar(top, bottom, weight, row.data(), count);
+#endif
+
+    const int r = static_cast<int>(y);
+    if (options_.output == OutputType::Float32) {
+      float *const planes[3] = {tensor_.ptr<float>(r), tensor_.ptr<float>(height + r),
+                                tensor_.ptr<float>(2 * height + r)};
+#if defined(PERCEPTION_SIMD_X86)
+      if (useAvx2_) {
+        ResampleRowAvx2(params_, columns_, row.data(), planes, width);
+        continue;
+      }
+#endif
+      ResampleRowScalar(params_, columns_, row.data(), planes, 0, width);
+    } else {
+      uint8_t *const planes[3] = {tensor_.ptr<uint8_t>(r), tensor_.ptr<uint8_t>(height + r),
+                                  tensor_.ptr<uint8_t>(2 * height + r)};
+#if defined(PERCEPTION_SIMD_X86)
+      if (useAvx2_) {
+        ResampleRowAvx2(params_, columns_, row.data(), planes, width);
+        continue;
+      }
+#endif
+      ResampleRowScalar(params_, columns_, row.data(), planes, 0, width);
+    }
+  }
+}
+
+void TensorPreprocessor::ProcessDepthRows(const cv::Mat &depth, size_t rowBegin, size_t rowEnd) {
+  const size_t width = static_cast<size_t>(options_.width);
+  const int offset = 3 * options_.height;
+  const float scale = options_.depth_scale;
+  for (size_t y = rowBegin; y < rowEnd; ++y) {
+    const float *source = depth.ptr<float>(depthRows_[y]);
+    const int r = offset + static_cast<int>(y);
+    // Nearest neighbour: interpolating across an edge or an invalid pixel would invent depth
+    if (options_.output == OutputType::Float32) {
+      float *out = tensor_.ptr<float>(r);
+      for (size_t x = 0; x < width; ++x) {
+        const float value = source[depthColumns_[x]];
+        out[x] = value > 0 ? value * scale : 0.0f;
+      }
+    } else {
+      uint8_t *out = tensor_.ptr<uint8_t>(r);
+      for (size_t x = 0; x < width; ++x) {
+        const float value = source[depthColumns_[x]];
+        Store(value > 0 ? value * scale : 0.0f, out + x);
+      }
+    }
+  }
+}
+
+void TensorPreprocessor::BlendRowsScalar(const uint8_t *top, const uint8_t *bottom, float weight, float *out,
+                                         size_t count) {
+  for (size_t i = 0; i < count; ++i) {
+    const float a = top[i];
+    out[i] = a + weight * (static_cast<float>(bottom[i]) - a);
+  }
+}
+
+template <typename T>
+void TensorPreprocessor::ResampleRowScalar(const Params &params, const Axis &columns, const float *row,
+                                           T *const planes[3], size_t begin, size_t end) {
+  for (size_t x = begin; x < end; ++x) {
+    const float *left = row + columns.first[x];
+    const float *right = row + columns.second[x];
+    const float weight = columns.weight[x];
+    for (int k = 0; k < 3; ++k) {
+      const float a = left[params.source[k]];
+      const float value = a + weight * (right[params.source[k]] - a);
+      Store(value * params.scale[k] + params.bias[k], planes[k] + x);
+    }
+  }
+}
+
+#if defined(PERCEPTION_SIMD_X86)
+PERCEPTION_TARGET_AVX2 void TensorPreprocessor::BlendRowsAvx2(const uint8_t *top, const uint8_t *bottom, float weight,
+                                                              float *out, size_t count) {
+  const __m256 w = _mm256_set1_ps(weight);
+  size_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    const __m256 a = _mm256_cvtepi32_ps(
+        _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(top + i))));
+    const __m256 b = _mm256_cvtepi32_ps(
+        _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(bottom + i))));
+    _mm256_storeu_ps(out + i, _mm256_fmadd_ps(w, _mm256_sub_ps(b, a), a));
+  }
+
+  BlendRowsScalar(top + i, bottom + i, weight, out + i, count - i);
+}
+
+namespace {
+// Bilinear sample and affine normalization of one output channel for 8 pixels
+PERCEPTION_TARGET_AVX2 inline __m256 ResampleChannelAvx2(const float *row, __m256i first, __m256i second,
+                                                         __m256 weight, int32_t source, float scale, float bias) {
+  const __m256i channel = _mm256_set1_epi32(source);
+  const __m256 a = _mm256_i32gather_ps(row, _mm256_add_epi32(first, channel), 4);
+  const __m256 b = _mm256_i32gather_ps(row, _mm256_add_epi32(second, channel), 4);
+  const __m256 value = _mm256_fmadd_ps(weight, _mm256_sub_ps(b, a), a);
+  return _mm256_fmadd_ps(value, _mm256_set1_ps(scale), _mm256_set1_ps(bias));
+}
+}  // namespace
+
+PERCEPTION_TARGET_AVX2 void TensorPreprocessor::ResampleRowAvx2(const Params &params, const Axis &columns,
+                                                                const float *row, float *const planes[3],
+                                                                size_t width) {
+  size_t x = 0;
+  for (; x + 8 <= width; x += 8) {
+    const __m256i first = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(columns.first.data() + x));
+    const __m256i second = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(columns.second.data() + x));
+    const __m256 weight = _mm256_loadu_ps(columns.weight.data() + x);
+    for (int k = 0; k < 3; ++k) {
+      _mm256_storeu_ps(planes[k] + x, ResampleChannelAvx2(row, first, second, weight, params.source[k],
+                                                          params.scale[k], params.bias[k]));
+    }
+  }
+
+  ResampleRowScalar(params, columns, row, planes, x, width);
+}
+
+PERCEPTION_TARGET_AVX2 void TensorPreprocessor::ResampleRowAvx2(const Params &params, const Axis &columns,
+                                                                const float *row, uint8_t *const planes[3],
+                                                                size_t width) {
+  size_t x = 0;
+  for (; x + 8 <= width; x += 8) {
+    const __m256i first = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(columns.first.data() + x));
+    const __m256i second = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(columns.second.data() + x));
+    const __m256 weight = _mm256_loadu_ps(columns.weight.data() + x);
+    for (int k = 0; k < 3; ++k) {
+      const __m256i value = _mm256_cvtps_epi32(
+          ResampleChannelAvx2(row, first, second, weight, params.source[k], params.scale[k], params.bias[k]));
+      // Saturating packs clamp to 0-255 like the scalar store
+      const __m128i words = _mm_packus_epi32(_mm256_castsi256_si128(value), _mm256_extracti128_si256(value, 1));
+      _mm_storel_epi64(reinterpret_cast<__m128i *>(planes[k] + x), _mm_packus_epi16(words, words));
+    }
+  }
+
+  ResampleRowScalar(params, columns, row, planes, x, width);
+}
+#endif
+
+#if defined(PERCEPTION_SIMD_NEON)
+void TensorPreprocessor::BlendRowsNeon(const uint8_t *top, const uint8_t *bottom, float weight, float *out,
+                                       size_t count) {
+  size_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    const uint16x8_t a16 = vmovl_u8(vld1_u8(top + i));
+    const uint16x8_t b16 = vmovl_u8(vld1_u8(bottom + i));
+    const float32x4_t aLow = vcvtq_f32_u32(vmovl_u16(vget_low_u16(a16)));
+    const float32x4_t aHigh = vcvtq_f32_u32(vmovl_u16(vget_high_u16(a16)));
+    const float32x4_t bLow = vcvtq_f32_u32(vmovl_u16(vget_low_u16(b16)));
+    const float32x4_t bHigh = vcvtq_f32_u32(vmovl_u16(vget_high_u16(b16)));
+    vst1q_f32(out + i, vmlaq_n_f32(aLow, vsubq_f32(bLow, aLow), weight));
+    vst1q_f32(out + i + 4, vmlaq_n_f32(aHigh, vsubq_f32(bHigh, aHigh), weight));
+  }
+
+  BlendRowsScalar(top + i, bottom + i, weight, out + i, count - i);
+}
+#endif
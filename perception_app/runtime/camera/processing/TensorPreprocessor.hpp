@@ -0,0 +1,115 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <nlohmann/json_fwd.hpp>
+#include <opencv2/core.hpp>
+#include "utils/SimdSupport.hpp"
+
+/**
+ * @brief 模型输入预处理
+ *
+ * 把 CV_8UC3 BGR 彩色图（可选附加深度图）一次性转换为模型输入张量：双线性缩放到 input_size、
+ * 按 channel_order 调整通道顺序、按 (x / 255 - mean) / std 归一化，并写成平面（CHW）布局。
+ * 这些步骤融合在同一次遍历中完成，不产生缩放图、转换图、浮点图等中间图像：每个输出行先把对应的
+ * 两行源像素纵向插值到行内缓冲，再横向插值、归一化并直接写入各通道平面。纵向插值和横向插值
+ * 按运行时检测选择 AVX2 / NEON / 标量内核（NEON 平台横向插值为标量，AVX2 使用 gather），输出行切分到
+ * 共享线程池并行执行。
+ *
+ * 张量为单通道 cv::Mat，行数为 通道数 x height、列数为 width，各通道平面纵向依次排列且内存连续，
+ * data 指针可直接作为模型输入。输出缓冲、插值表和行内缓冲在帧之间复用，尺寸不变时不再分配内存。
+ * 一个预处理器对应一路输入，非线程安全，返回的张量在下一次 Process 前有效。
+ */
+class TensorPreprocessor {
+public:
+    enum class OutputType {
+        Float32,  // CV_32F，按 mean / std 归一化（normalize 为 false 时为 0-255 原值）
+        UInt8     // CV_8U，不做归一化
+    };
+
+    struct Options {
+        int width = 640;   // 输出宽度
+        int height = 480;  // 输出高度
+        bool normalize = true;
+        float mean[3] = {0.485f, 0.456f, 0.406f};  // 按输出通道顺序，取值相对于 0-1
+        float std[3] = {0.229f, 0.224f, 0.225f};
+        bool rgb = true;  // 输出通道顺序为 RGB，否则保持 BGR
+        OutputType output = OutputType::Float32;
+        bool include_depth = false;  // 在彩色平面之后追加一个深度平面（最近邻缩放，无效深度为 0）
+        float depth_scale = 0.001f;  // 深度平面的值 = 深度（毫米）* depth_scale
+        bool parallel = true;
+    };
+
+    /**
+     * @brief 从推理配置读取 input_size 和 preprocessing
+     * @param config 推理配置文件的 JSON 根对象，缺少的字段保持默认值
+     * @return 字段类型不符或取值非法时返回 false，options 保持调用前的值
+     */
+    static bool ParseOptions(const nlohmann::json& config, Options& options);
+
+    explicit TensorPreprocessor(const Options& options);
+
+    /**
+     * @brief 生成模型输入张量
+     * @param color CV_8UC3 BGR 彩色图
+     * @param depth CV_32FC1 深度图（毫米），仅在 include_depth 时使用，可与彩色图尺寸不同，为空时深度平面为 0
+     * @return 张量，彩色图为空或类型不符时为空
+     */
+    const cv::Mat& Process(const cv::Mat& color, const cv::Mat& depth = cv::Mat());
+
+    const Options& GetOptions() const { return options_; }
+
+    /**
+     * @brief 张量的通道数（3，或附加深度平面时为 4）
+     */
+    int Channels() const { return options_.include_depth ? 4 : 3; }
+
+private:
+    // 一个输出轴上的双线性插值表
+    struct Axis {
+        int source = 0;               // 源图像在该轴上的尺寸
+        std::vector<int32_t> first;   // 左（上）侧源像素的下标，已乘以 stride
+        std::vector<int32_t> second;  // 右（下）侧源像素的下标，位于边缘时与 first 相同
+        std::vector<float> weight;    // second 的权重
+    };
+
+    struct Params {
+        int32_t source[3];  // 输出平面对应的源通道（BGR 内的偏移）
+        float scale[3];     // 按输出平面顺序
+        float bias[3];
+    };
+
+    static void BuildAxis(int source, int target, int stride, Axis& axis);
+    static void BuildNearest(int source, int target, std::vector<int32_t>& nearest);
+
+    void ProcessColorRows(const cv::Mat& color, size_t rowBegin, size_t rowEnd);
+    void ProcessDepthRows(const cv::Mat& depth, size_t rowBegin, size_t rowEnd);
+
+    // 两行源像素（字节）按 weight 纵向插值为浮点
+    static void BlendRowsScalar(const uint8_t* top, const uint8_t* bottom, float weight, float* out, size_t count);
+    // 从纵向插值后的行横向插值、归一化，写入三个平面的同一行
+    template <typename T>
+    static void ResampleRowScalar(const Params& params, const Axis& columns, const float* row, T* const planes[3],
+                                  size_t begin, size_t end);
+#if defined(PERCEPTION_SIMD_X86)
+    static void BlendRowsAvx2(const uint8_t* top, const uint8_t* bottom, float weight, float* out, size_t count);
+    static void ResampleRowAvx2(const Params& params, const Axis& columns, const float* row, float* const planes[3],
+                                size_t width);
+    static void ResampleRowAvx2(const Params& params, const Axis& columns, const float* row, uint8_t* const planes[3],
+                                size_t width);
+#endif
+#if defined(PERCEPTION_SIMD_NEON)
+    static void BlendRowsNeon(const uint8_t* top, const uint8_t* bottom, float weight, float* out, size_t count);
+#endif
+
+private:
+    Options options_;
+    Params params_;
+    Axis columns_;  // stride 3：行内缓冲中像素首个通道的下标
+    Axis rows_;
+    cv::Size depthSource_;
+    std::vector<int32_t> depthColumns_;
+    std::vector<int32_t> depthRows_;
+    cv::Mat tensor_;
+    bool useAvx2_;
+};
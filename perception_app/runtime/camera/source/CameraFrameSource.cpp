@@ -0,0 +1,47 @@
+#include "CameraFrameSource.hpp"
+#include <thread>
+#include "CameraInfo.hpp"
+#include "utils/UtilHelper.h"
+
+CameraFrameSource::CameraFrameSource(const mmind::eye::CameraInfo &device) : device_(device), has_device_(true) {}
+
+CameraFrameSource::~CameraFrameSource() { Close(); }
+
+bool CameraFrameSource::Open() {
+  if (connected_) return true;
+  if (!(has_device_ ? ConnectCamera(camera_, device_) : FindAndConnect(camera_))) return false;
+
+  mmind::eye::CameraInfo cameraInfo;
+  showError(camera_.getCameraInfo(cameraInfo));
+  printCameraInfo(cameraInfo);
+  serial_number_ = cameraInfo.serialNumber;
+
+  // Each camera keeps its own calibration; the first one registered also becomes the default
+  CameraInfo::getInstance().RegisterCamera(serial_number_, camera_);
+  CameraInfo::getInstance().GetCameraParams(serial_number_, intrinsics_, transformation_);
+  connected_ = true;
+  return true;
+}
+
+void CameraFrameSource::Close() {
+  if (!connected_) return;
+  camera_.disconnect();
+  connected_ = false;
+}
+
+bool CameraFrameSource::Grab(FrameSet &frame, const std::string &suffix) {
+  mmind::eye::Frame2DAnd3D frame2DAnd3D;
+  mmind::eye::ErrorStatus status = camera_.capture2DAnd3D(frame2DAnd3D);
+  if (!status.isOK()) {
+    showError(status);
+    return false;
+  }
+
+  frame.Reset(frame2DAnd3D, suffix, intrinsics_, transformation_);
+  frame.camera_id = serial_number_;
+  return true;
+}
+
+std::string CameraFrameSource::Name() const {
+  return serial_number_.empty() ? "camera" : "camera " + serial_number_;
+}
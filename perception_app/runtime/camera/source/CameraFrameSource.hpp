@@ -0,0 +1,41 @@
+#pragma once
+
+#include "FrameSource.hpp"
+#include "area_scan_3d_camera/Camera.h"
+
+/**
+ * @brief Mech-Eye 相机数据源
+ *
+ * Open 时连接相机，记录相机内参和坐标变换；每次 Grab 采集一帧 2D + 3D 数据，
+ * 并以相机序列号标记帧。多台相机各自使用一个实例，可在不同线程中并发采集。
+ */
+class CameraFrameSource : public FrameSource
+{
+public:
+    /**
+     * @brief 连接发现的第一台相机
+     */
+    CameraFrameSource() = default;
+
+    /**
+     * @brief 连接指定的相机
+     */
+    explicit CameraFrameSource(const mmind::eye::CameraInfo& device);
+
+    ~CameraFrameSource() override;
+
+    bool Open() override;
+    void Close() override;
+    bool Grab(FrameSet& frame, const std::string& suffix) override;
+    std::string CameraId() const override { return serial_number_; }
+    std::string Name() const override;
+
+private:
+    mmind::eye::CameraInfo device_;
+    bool has_device_ = false;
+    mmind::eye::Camera camera_;
+    mmind::eye::CameraIntrinsics intrinsics_;
+    mmind::eye::FrameTransformation transformation_;
+    std::string serial_number_;
+    bool connected_ = false;
+};
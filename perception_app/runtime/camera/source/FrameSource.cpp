@@ -0,0 +1,37 @@
+#include "FrameSource.hpp"
+#include <algorithm>
+#include "CameraFrameSource.hpp"
+#include "ReplayFrameSource.hpp"
+#include "Logger.hpp"
+
+std::vector<std::unique_ptr<FrameSource>> CreateFrameSources(const ConfigHelper::CameraConfig::SourceConfig &config) {
+  std::vector<std::unique_ptr<FrameSource>> sources;
+  if (config.type == "replay") {
+    sources.push_back(std::make_unique<ReplayFrameSource>(config.replay));
+    return sources;
+  }
+  if (config.type != "camera") {
+    LOG_ERROR_STREAM << "Unknown frame source type: " << config.type;
+    return sources;
+  }
+
+  if (config.serial_numbers.empty()) {
+    sources.push_back(std::make_unique<CameraFrameSource>());
+    return sources;
+  }
+
+  // Discover once and hand each source the device it should connect to
+  LOG_INFO_STREAM << "Looking for " << config.serial_numbers.size() << " cameras...";
+  const std::vector<mmind::eye::CameraInfo> devices = mmind::eye::Camera::discoverCameras();
+  for (const auto &serial : config.serial_numbers) {
+    auto it = std::find_if(devices.begin(), devices.end(),
+                           [&serial](const mmind::eye::CameraInfo &info) { return info.serialNumber == serial; });
+    if (it == devices.end()) {
+      LOG_ERROR_STREAM << "Camera " << serial << " not found";
+      sources.clear();
+      return sources;
+    }
+    sources.push_back(std::make_unique<CameraFrameSource>(*it));
+  }
+  return sources;
+}
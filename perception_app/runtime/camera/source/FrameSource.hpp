@@ -0,0 +1,62 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+#include "FrameSet.hpp"
+#include "configure/ConfigHelper.hpp"
+
+/**
+ * @brief 帧数据来源
+ *
+ * CameraManager 只通过该接口获取帧，不直接依赖 Mech-Eye 相机：在线运行时使用
+ * CameraFrameSource（每台相机一个），离线测试流水线吞吐或做回归时使用 ReplayFrameSource
+ * 回放磁盘数据。不同数据源的 Grab 可以在不同线程中并发调用，同一数据源只在一个线程中调用。
+ */
+class FrameSource
+{
+public:
+    virtual ~FrameSource() = default;
+
+    /**
+     * @brief 打开数据源（连接相机 / 扫描回放数据）
+     */
+    virtual bool Open() = 0;
+
+    /**
+     * @brief 关闭数据源
+     */
+    virtual void Close() = 0;
+
+    /**
+     * @brief 获取下一帧并装载到 frame 中，同时设置 frame.camera_id
+     * @param frame 由帧缓冲池提供的 FrameSet
+     * @param suffix 帧标识
+     * @return true 成功，false 本次获取失败或数据已读完（由 IsFinished 区分）
+     */
+    virtual bool Grab(FrameSet& frame, const std::string& suffix) = 0;
+
+    /**
+     * @brief 数据源是否已经没有更多的帧
+     */
+    virtual bool IsFinished() const { return false; }
+
+    /**
+     * @brief 相机标识（序列号），Open 之后有效；不对应单台相机的数据源返回空字符串
+     */
+    virtual std::string CameraId() const { return ""; }
+
+    /**
+     * @brief 数据源描述，用于日志
+     */
+    virtual std::string Name() const = 0;
+};
+
+/**
+ * @brief 根据配置创建数据源
+ *
+ * camera 类型按 serial_numbers 为每台相机创建一个数据源，列表为空时只连接发现的第一台相机；
+ * replay 类型创建一个回放源。
+ * @return 数据源列表，类型无法识别或找不到指定相机时返回空列表
+ */
+std::vector<std::unique_ptr<FrameSource>> CreateFrameSources(const ConfigHelper::CameraConfig::SourceConfig& config);
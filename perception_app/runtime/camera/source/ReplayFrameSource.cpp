@@ -0,0 +1,283 @@
+#include "ReplayFrameSource.hpp"
+#include <algorithm>
+#include <cctype>
+#include <dirent.h>
+#include <thread>
+#include <opencv2/imgcodecs.hpp>
+#include "Logger.hpp"
+#include "storage/DepthCodec.hpp"
+#include "storage/FrameContainer.hpp"
+#include "storage/PlyConverter.hpp"
+
+namespace {
+// File name endings written by CameraManager::SaveImages (see SaveConfig::save_*_file)
+const std::string kColorFileEnding = "_2DImage.png";
+const std::string kDepthFileEnding = "_DepthMap.tiff";
+const std::string kCompressedDepthFileEnding = "_DepthMap.mdc";
+const std::string kContainerFileEnding = "_Frame.mfc";
+const std::string kPointCloudFileEnding = "_PointCloud.ply";
+const std::string kTexturedPointCloudFileEnding = "_TexturedPointCloud.ply";
+
+bool EndsWith(const std::string &value, const std::string &ending) {
+  return value.size() >= ending.size() && value.compare(value.size() - ending.size(), ending.size(), ending) == 0;
+}
+
+// Suffixes are capture timestamps; compare numerically when both are numbers
+bool IsNumber(const std::string &value) {
+  return !value.empty() &&
+         std::all_of(value.begin(), value.end(), [](unsigned char c) { return std::isdigit(c) != 0; });
+}
+
+bool TimestampLess(const std::string &a, const std::string &b) {
+  const bool numeric = IsNumber(a) && IsNumber(b);
+  if (numeric && a.size() != b.size()) return a.size() < b.size();
+  return a < b;
+}
+
+// Multi-camera recordings use "<timestamp>_<serial number>" suffixes
+std::string TimestampOf(const std::string &suffix) { return suffix.substr(0, suffix.find('_')); }
+
+std::string CameraIdOf(const std::string &suffix) {
+  const size_t separator = suffix.find('_');
+  return separator == std::string::npos ? std::string() : suffix.substr(separator + 1);
+}
+
+bool SuffixLess(const std::string &a, const std::string &b) {
+  const std::string timeA = TimestampOf(a);
+  const std::string timeB = TimestampOf(b);
+  if (timeA != timeB) return TimestampLess(timeA, timeB);
+  return CameraIdOf(a) < CameraIdOf(b);
+}
+}  // namespace
+
+ReplayFrameSource::ReplayFrameSource(const ReplayConfig &config) : config_(config) {
+  if (config_.depth_intrinsics.size() == 4) {
+    intrinsics_.depth.cameraMatrix.fx = config_.depth_intrinsics[0];
+    intrinsics_.depth.cameraMatrix.fy = config_.depth_intrinsics[1];
+    intrinsics_.depth.cameraMatrix.cx = config_.depth_intrinsics[2];
+    intrinsics_.depth.cameraMatrix.cy = config_.depth_intrinsics[3];
+  } else {
+    // Leave fx/fy at zero so point cloud products report unavailable instead of being wrong
+    intrinsics_.depth.cameraMatrix.fx = 0;
+    intrinsics_.depth.cameraMatrix.fy = 0;
+    if (!config_.depth_intrinsics.empty()) {
+      LOG_WARNING_STREAM << "Replay depth_intrinsics must be [fx, fy, cx, cy], point clouds disabled";
+    }
+  }
+}
+
+bool ReplayFrameSource::Open() {
+  entries_.clear();
+  next_index_ = 0;
+  finished_ = false;
+
+  if (!ScanDumpDirectory()) return false;
+
+  WarnIfPointCloudsUnavailable();
+
+  if (config_.preload) {
+    for (auto &entry : entries_) {
+      LoadedFrame loaded;
+      LoadEntry(entry, loaded);
+      entry.color = loaded.color;
+      entry.depth = loaded.depth;
+      entry.point_cloud = loaded.point_cloud;
+      entry.textured_point_cloud = loaded.textured_point_cloud;
+    }
+  }
+
+  next_due_ = std::chrono::steady_clock::now();
+  LOG_INFO_STREAM << "Replaying " << entries_.size() << " frames from " << config_.path << " at "
+                  << (config_.rate_hz > 0 ? std::to_string(config_.rate_hz) + " Hz" : std::string("full speed"))
+                  << (config_.loop ? ", looping" : "") << (config_.preload ? ", preloaded" : "");
+  return true;
+}
+
+void ReplayFrameSource::Close() {
+  entries_.clear();
+  finished_ = true;
+}
+
+bool ReplayFrameSource::Grab(FrameSet &frame, const std::string &suffix) {
+  if (finished_ || entries_.empty()) {
+    finished_ = true;
+    return false;
+  }
+
+  WaitForNextFrame();
+
+  const Entry &entry = entries_[next_index_];
+  if (++next_index_ >= entries_.size()) {
+    next_index_ = 0;
+    finished_ = !config_.loop;
+  }
+
+  LoadedFrame loaded;
+  if (config_.preload) {
+    loaded.color = entry.color;
+    loaded.depth = entry.depth;
+    loaded.point_cloud = entry.point_cloud;
+    loaded.textured_point_cloud = entry.textured_point_cloud;
+  } else if (!LoadEntry(entry, loaded)) {
+    return false;
+  }
+
+  if (entry.has_camera_params) {
+    frame.Reset(loaded.color, loaded.depth, suffix, entry.intrinsics, entry.transformation);
+    frame.camera_id = entry.camera_id.empty() ? CameraIdOf(entry.suffix) : entry.camera_id;
+  } else {
+    frame.Reset(loaded.color, loaded.depth, suffix, intrinsics_, transformation_);
+    frame.camera_id = CameraIdOf(entry.suffix);
+  }
+  if (!loaded.point_cloud.isEmpty() || !loaded.textured_point_cloud.isEmpty()) {
+    frame.SetPointClouds(loaded.point_cloud, loaded.textured_point_cloud);
+  }
+  return true;
+}
+
+std::string ReplayFrameSource::Name() const { return "replay " + config_.path; }
+
+bool ReplayFrameSource::ScanDumpDirectory() {
+  DIR *dir = opendir(config_.path.c_str());
+  if (dir == nullptr) {
+    LOG_ERROR_STREAM << "Failed to open replay directory: " << config_.path;
+    return false;
+  }
+
+  std::vector<Entry> entries;
+  auto entryFor = [&entries](const std::string &suffix) -> Entry & {
+    auto it = std::find_if(entries.begin(), entries.end(), [&suffix](const Entry &e) { return e.suffix == suffix; });
+    if (it != entries.end()) return *it;
+    entries.push_back(Entry());
+    entries.back().suffix = suffix;
+    return entries.back();
+  };
+
+  const std::string directory = config_.path + "/";
+  for (dirent *item = readdir(dir); item != nullptr; item = readdir(dir)) {
+    const std::string name = item->d_name;
+    // The textured ending also ends in "PointCloud.ply", so it is matched first
+    if (EndsWith(name, kTexturedPointCloudFileEnding)) {
+      entryFor(name.substr(0, name.size() - kTexturedPointCloudFileEnding.size())).textured_point_cloud_file =
+          directory + name;
+    } else if (EndsWith(name, kPointCloudFileEnding)) {
+      entryFor(name.substr(0, name.size() - kPointCloudFileEnding.size())).point_cloud_file = directory + name;
+    } else if (EndsWith(name, kColorFileEnding)) {
+      entryFor(name.substr(0, name.size() - kColorFileEnding.size())).color_file = directory + name;
+    } else if (EndsWith(name, kDepthFileEnding)) {
+      entryFor(name.substr(0, name.size() - kDepthFileEnding.size())).depth_file = directory + name;
+    } else if (EndsWith(name, kCompressedDepthFileEnding)) {
+      entryFor(name.substr(0, name.size() - kCompressedDepthFileEnding.size())).depth_file = directory + name;
+    } else if (EndsWith(name, kContainerFileEnding)) {
+      entryFor(name.substr(0, name.size() - kContainerFileEnding.size())).container_file = directory + name;
+    }
+  }
+  closedir(dir);
+
+  if (entries.empty()) {
+    LOG_ERROR_STREAM << "No replayable frames (*" << kColorFileEnding << ", *" << kDepthFileEnding << ", *"
+                     << kCompressedDepthFileEnding << ", *" << kPointCloudFileEnding << ", *"
+                     << kTexturedPointCloudFileEnding << ", *" << kContainerFileEnding << ") in " << config_.path;
+    return false;
+  }
+
+  for (auto &entry : entries) {
+    if (!entry.container_file.empty()) ReadContainerParams(entry);
+  }
+
+  std::sort(entries.begin(), entries.end(),
+            [](const Entry &a, const Entry &b) { return SuffixLess(a.suffix, b.suffix); });
+  entries_ = std::move(entries);
+  return true;
+}
+
+bool ReplayFrameSource::LoadEntry(const Entry &entry, LoadedFrame &frame) const {
+  cv::Mat &color = frame.color;
+  cv::Mat &depth = frame.depth;
+  color.release();
+  depth.release();
+  frame.point_cloud.release();
+  frame.textured_point_cloud.release();
+
+  // Saved clouds are already transformed; a textured file also provides the plain cloud if that was not saved
+  if (!entry.textured_point_cloud_file.empty() &&
+      !PlyConverter::ReadPointClouds(entry.textured_point_cloud_file,
+                                     entry.point_cloud_file.empty() ? &frame.point_cloud : nullptr,
+                                     &frame.textured_point_cloud)) {
+    LOG_WARNING_STREAM << "Failed to read replay point cloud: " << entry.textured_point_cloud_file;
+  }
+  if (!entry.point_cloud_file.empty() &&
+      !PlyConverter::ReadPointClouds(entry.point_cloud_file, &frame.point_cloud, nullptr)) {
+    LOG_WARNING_STREAM << "Failed to read replay point cloud: " << entry.point_cloud_file;
+  }
+  const bool hasCloud = !frame.point_cloud.isEmpty() || !frame.textured_point_cloud.isEmpty();
+
+  if (!entry.container_file.empty()) {
+    MappedFrameContainer container;
+    if (!container.Open(entry.container_file)) return false;
+    // Views point into the mapping, which is unmapped when the container goes out of scope
+    color = container.Color().clone();
+    depth = container.Depth().clone();
+    return !color.empty() || !depth.empty() || hasCloud;
+  }
+
+  if (!entry.color_file.empty()) {
+    color = cv::imread(entry.color_file, cv::IMREAD_COLOR);
+    if (color.empty()) {
+      LOG_WARNING_STREAM << "Failed to read replay image: " << entry.color_file;
+    }
+  }
+
+  if (EndsWith(entry.depth_file, kCompressedDepthFileEnding)) {
+    DepthCodec::ReadFile(entry.depth_file, depth);
+  } else if (!entry.depth_file.empty()) {
+    depth = cv::imread(entry.depth_file, cv::IMREAD_UNCHANGED);
+    if (depth.empty()) {
+      LOG_WARNING_STREAM << "Failed to read replay depth map: " << entry.depth_file;
+    } else if (depth.type() != CV_32FC1) {
+      depth.convertTo(depth, CV_32FC1);
+    }
+  }
+
+  return !color.empty() || !depth.empty() || hasCloud;
+}
+
+void ReplayFrameSource::WarnIfPointCloudsUnavailable() const {
+  const bool hasIntrinsics = intrinsics_.depth.cameraMatrix.fx > 0 && intrinsics_.depth.cameraMatrix.fy > 0;
+  size_t withoutClouds = 0;
+  for (const auto &entry : entries_) {
+    if (entry.point_cloud_file.empty() && entry.textured_point_cloud_file.empty() && !entry.has_camera_params &&
+        !hasIntrinsics) {
+      ++withoutClouds;
+    }
+  }
+  if (withoutClouds > 0) {
+    LOG_WARNING_STREAM << withoutClouds << " of " << entries_.size() << " replay frames have no *" << kPointCloudFileEnding
+                       << " and no depth intrinsics: point cloud products are unavailable for them. Save point clouds "
+                       << "or set source.replay.depth_intrinsics to [fx, fy, cx, cy]";
+  }
+}
+
+void ReplayFrameSource::ReadContainerParams(Entry &entry) {
+  MappedFrameContainer container;
+  if (!container.Open(entry.container_file)) return;
+  entry.has_camera_params = true;
+  entry.intrinsics = container.Intrinsics();
+  entry.transformation = container.Transformation();
+  entry.camera_id = container.CameraId();
+}
+
+void ReplayFrameSource::WaitForNextFrame() {
+  if (config_.rate_hz <= 0) return;
+
+  const auto period = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+      std::chrono::duration<double>(1.0 / config_.rate_hz));
+  const auto now = std::chrono::steady_clock::now();
+  if (next_due_ > now) {
+    std::this_thread::sleep_until(next_due_);
+    next_due_ += period;
+  } else {
+    // Running late (slow decode or back-pressure): restart the schedule instead of bursting
+    next_due_ = now + period;
+  }
+}
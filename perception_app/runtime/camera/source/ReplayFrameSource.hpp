@@ -0,0 +1,91 @@
+#pragma once
+
+#include <chrono>
+#include <string>
+#include <vector>
+#include "FrameSource.hpp"
+
+/**
+ * @brief 磁盘数据回放源
+ *
+ * 回放 SaveImages 写出的目录（<suffix>_2DImage.png、<suffix>_DepthMap.tiff / .mdc、<suffix>_PointCloud.ply、
+ * <suffix>_TexturedPointCloud.ply 或 <suffix>_Frame.mfc），按文件名中的
+ * 时间戳顺序输出帧；多相机录制的 suffix 为 <时间戳>_<序列号>，回放帧按序列号标记相机。可按固定帧率回放，也可以尽可能快地回放以测量流水线吞吐；
+ * preload 时启动前将所有帧读入内存，排除图像解码对吞吐测量的影响。
+ *
+ * 回放帧不包含 SDK 原始帧。存在 PLY 时直接作为 PointCloud / TexturedPointCloud 产品（保存时已变换）；
+ * 否则点云类产品由深度图和深度相机内参计算。帧容器自带录制时的内参、坐标变换和相机序列号；
+ * 图像文件则使用配置中的深度相机内参，坐标变换为单位变换（相机坐标系），所有相机共用同一组内参。
+ * 既没有 PLY 也没有内参的帧不提供点云类产品，Open 时给出警告。
+ */
+class ReplayFrameSource : public FrameSource
+{
+public:
+    using ReplayConfig = ConfigHelper::CameraConfig::SourceConfig::ReplayConfig;
+
+    explicit ReplayFrameSource(const ReplayConfig& config);
+
+    bool Open() override;
+    void Close() override;
+    bool Grab(FrameSet& frame, const std::string& suffix) override;
+    bool IsFinished() const override { return finished_; }
+    std::string Name() const override;
+
+    /**
+     * @brief 回放数据中的帧数
+     */
+    size_t FrameCount() const { return entries_.size(); }
+
+private:
+    struct Entry
+    {
+        std::string suffix;
+        std::string color_file;
+        std::string depth_file;
+        std::string point_cloud_file;
+        std::string textured_point_cloud_file;
+        std::string container_file;  // 存在时优先于图像文件
+        bool has_camera_params = false;  // 帧容器中的相机参数
+        mmind::eye::CameraIntrinsics intrinsics;
+        mmind::eye::FrameTransformation transformation;
+        std::string camera_id;
+        cv::Mat color;  // preload 时缓存
+        cv::Mat depth;
+        mmind::eye::PointCloud point_cloud;
+        mmind::eye::TexturedPointCloud textured_point_cloud;
+    };
+
+    // 一帧从磁盘读出的数据
+    struct LoadedFrame
+    {
+        cv::Mat color;
+        cv::Mat depth;
+        mmind::eye::PointCloud point_cloud;
+        mmind::eye::TexturedPointCloud textured_point_cloud;
+    };
+
+    bool ScanDumpDirectory();
+
+    bool LoadEntry(const Entry& entry, LoadedFrame& frame) const;
+
+    /**
+     * @brief 有帧既没有 PLY 也没有可用的内参时给出警告（这些帧不提供点云类产品）
+     */
+    void WarnIfPointCloudsUnavailable() const;
+
+    /**
+     * @brief 读取帧容器中的相机参数（只读文件头，图像在 LoadEntry 时读取）
+     */
+    static void ReadContainerParams(Entry& entry);
+
+    void WaitForNextFrame();
+
+private:
+    ReplayConfig config_;
+    std::vector<Entry> entries_;
+    size_t next_index_ = 0;
+    bool finished_ = false;
+    mmind::eye::CameraIntrinsics intrinsics_;
+    mmind::eye::FrameTransformation transformation_;
+    std::chrono::steady_clock::time_point next_due_;
+};
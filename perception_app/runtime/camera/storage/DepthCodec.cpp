@@ -0,0 +1,484 @@
+#include "DepthCodec.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <new>
+#include "Logger.hpp"
+#include "utils/SimdSupport.hpp"
+#include "utils/ThreadPool.hpp"
+
+constexpr char DepthCodec::kMagic[4];
+
+namespace {
+// Quantized value of an invalid pixel; valid values stay below 2^30 so residuals never overflow int32
+constexpr uint32_t kInvalid = 0xFFFFFFFFu;
+constexpr float kMaxQuantized = 1073741823.0f;
+constexpr size_t kBlockSize = 32;
+
+struct StreamHeader
+{
+  char magic[4];
+  uint16_t version;
+  uint16_t reserved;
+  uint32_t width;
+  uint32_t height;
+  float precision_mm;
+  uint32_t stripe_rows;
+  uint32_t stripe_count;
+  uint32_t padding;
+};
+
+static_assert(sizeof(StreamHeader) == 32, "depth codec header layout changed");
+
+unsigned BitWidth(uint32_t value) {
+#if defined(__GNUC__) || defined(__clang__)
+  return value == 0 ? 0 : 32 - static_cast<unsigned>(__builtin_clz(value));
+#else
+  unsigned bits = 0;
+  for (; value != 0; value >>= 1) ++bits;
+  return bits;
+#endif
+}
+
+// Invalid pixels get code 0; valid residuals are zigzag mapped and shifted by one
+uint32_t ToCode(uint32_t value, uint32_t predicted) {
+  const int32_t residual = static_cast<int32_t>(value - predicted);
+  return ((static_cast<uint32_t>(residual) << 1) ^ static_cast<uint32_t>(residual >> 31)) + 1;
+}
+
+uint32_t FromCode(uint32_t code, uint32_t predicted) {
+  const uint32_t zigzag = code - 1;
+  return predicted + ((zigzag >> 1) ^ (0u - (zigzag & 1)));
+}
+
+// Round-to-nearest-even like the vector conversions, so every path produces identical streams
+void QuantizeRowScalar(const float *depth, uint32_t *quantized, size_t width, float scale) {
+  for (size_t col = 0; col < width; ++col) {
+    const float value = depth[col] * scale;
+    quantized[col] = (depth[col] > 0.0f && value < kMaxQuantized) ? static_cast<uint32_t>(std::nearbyint(value))
+                                                                   : kInvalid;
+  }
+}
+
+void DequantizeRowScalar(const uint32_t *quantized, float *depth, size_t width, float precision) {
+  for (size_t col = 0; col < width; ++col) {
+    depth[col] = quantized[col] == kInvalid ? std::numeric_limits<float>::quiet_NaN()
+                                            : static_cast<float>(static_cast<int32_t>(quantized[col])) * precision;
+  }
+}
+
+#if defined(PERCEPTION_SIMD_X86)
+PERCEPTION_TARGET_AVX2 void QuantizeRowAvx2(const float *depth, uint32_t *quantized, size_t width, float scale) {
+  const __m256 scaleVec = _mm256_set1_ps(scale);
+  const __m256 zero = _mm256_setzero_ps();
+  const __m256 limit = _mm256_set1_ps(kMaxQuantized);
+  const __m256i invalid = _mm256_set1_epi32(-1);
+
+  size_t col = 0;
+  for (; col + 8 <= width; col += 8) {
+    const __m256 z = _mm256_loadu_ps(depth + col);
+    const __m256 value = _mm256_mul_ps(z, scaleVec);
+    // Ordered compares are false for NaN
+    const __m256 valid = _mm256_and_ps(_mm256_cmp_ps(z, zero, _CMP_GT_OQ), _mm256_cmp_ps(value, limit, _CMP_LT_OQ));
+    const __m256i rounded = _mm256_cvtps_epi32(value);
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(quantized + col),
+                        _mm256_blendv_epi8(invalid, rounded, _mm256_castps_si256(valid)));
+  }
+  QuantizeRowScalar(depth + col, quantized + col, width - col, scale);
+}
+
+PERCEPTION_TARGET_AVX2 void DequantizeRowAvx2(const uint32_t *quantized, float *depth, size_t width,
+                                              float precision) {
+  const __m256 precisionVec = _mm256_set1_ps(precision);
+  const __m256 nan = _mm256_set1_ps(std::numeric_limits<float>::quiet_NaN());
+  const __m256i invalid = _mm256_set1_epi32(-1);
+
+  size_t col = 0;
+  for (; col + 8 <= width; col += 8) {
+    const __m256i value = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(quantized + col));
+    const __m256 z = _mm256_mul_ps(_mm256_cvtepi32_ps(value), precisionVec);
+    const __m256 isInvalid = _mm256_castsi256_ps(_mm256_cmpeq_epi32(value, invalid));
+    _mm256_storeu_ps(depth + col, _mm256_blendv_ps(z, nan, isInvalid));
+  }
+  DequantizeRowScalar(quantized + col, depth + col, width - col, precision);
+}
+#endif
+
+#if defined(PERCEPTION_SIMD_NEON) && defined(__aarch64__)
+void QuantizeRowNeon(const float *depth, uint32_t *quantized, size_t width, float scale) {
+  const float32x4_t scaleVec = vdupq_n_f32(scale);
+  const float32x4_t zero = vdupq_n_f32(0.0f);
+  const float32x4_t limit = vdupq_n_f32(kMaxQuantized);
+  const uint32x4_t invalid = vdupq_n_u32(kInvalid);
+
+  size_t col = 0;
+  for (; col + 4 <= width; col += 4) {
+    const float32x4_t z = vld1q_f32(depth + col);
+    const float32x4_t value = vmulq_f32(z, scaleVec);
+    const uint32x4_t valid = vandq_u32(vcgtq_f32(z, zero), vcltq_f32(value, limit));
+    const uint32x4_t rounded = vreinterpretq_u32_s32(vcvtnq_s32_f32(value));
+    vst1q_u32(quantized + col, vbslq_u32(valid, rounded, invalid));
+  }
+  QuantizeRowScalar(depth + col, quantized + col, width - col, scale);
+}
+
+void DequantizeRowNeon(const uint32_t *quantized, float *depth, size_t width, float precision) {
+  const float32x4_t precisionVec = vdupq_n_f32(precision);
+  const float32x4_t nan = vdupq_n_f32(std::numeric_limits<float>::quiet_NaN());
+  const uint32x4_t invalid = vdupq_n_u32(kInvalid);
+
+  size_t col = 0;
+  for (; col + 4 <= width; col += 4) {
+    const uint32x4_t value = vld1q_u32(quantized + col);
+    const float32x4_t z = vmulq_f32(vcvtq_f32_s32(vreinterpretq_s32_u32(value)), precisionVec);
+    vst1q_f32(depth + col, vbslq_f32(vceqq_u32(value, invalid), nan, z));
+  }
+  DequantizeRowScalar(quantized + col, depth + col, width - col, precision);
+}
+#endif
+
+void QuantizeRow(const float *depth, uint32_t *quantized, size_t width, float scale) {
+#if defined(PERCEPTION_SIMD_X86)
+  if (CpuSupportsAvx2()) {
+    QuantizeRowAvx2(depth, quantized, width, scale);
+    return;
+  }
+#elif defined(PERCEPTION_SIMD_NEON) && defined(__aarch64__)
+  QuantizeRowNeon(depth, quantized, width, scale);
+  return;
+#endif
+  QuantizeRowScalar(depth, quantized, width, scale);
+}
+
+void DequantizeRow(const uint32_t *quantized, float *depth, size_t width, float precision) {
+#if defined(PERCEPTION_SIMD_X86)
+  if (CpuSupportsAvx2()) {
+    DequantizeRowAvx2(quantized, depth, width, precision);
+    return;
+  }
+#elif defined(PERCEPTION_SIMD_NEON) && defined(__aarch64__)
+  DequantizeRowNeon(quantized, depth, width, precision);
+  return;
+#endif
+  DequantizeRowScalar(quantized, depth, width, precision);
+}
+
+// Each block of 32 codes is stored as one width byte followed by 32 codes of that many bits (width * 4 bytes)
+void PackBlocks(const uint32_t *codes, size_t count, std::vector<uint8_t> &out) {
+  for (size_t begin = 0; begin < count; begin += kBlockSize) {
+    const size_t size = std::min(kBlockSize, count - begin);
+    uint32_t any = 0;
+    for (size_t i = 0; i < size; ++i) {
+      any |= codes[begin + i];
+    }
+
+    const unsigned bits = BitWidth(any);
+    out.push_back(static_cast<uint8_t>(bits));
+    if (bits == 0) continue;
+
+    const size_t offset = out.size();
+    out.resize(offset + bits * kBlockSize / 8);
+    uint8_t *dst = out.data() + offset;
+    uint64_t buffer = 0;
+    unsigned filled = 0;
+    for (size_t i = 0; i < kBlockSize; ++i) {
+      buffer |= static_cast<uint64_t>(i < size ? codes[begin + i] : 0) << filled;
+      filled += bits;
+      if (filled >= 32) {
+        const uint32_t word = static_cast<uint32_t>(buffer);
+        std::memcpy(dst, &word, sizeof(word));
+        dst += sizeof(word);
+        buffer >>= 32;
+        filled -= 32;
+      }
+    }
+  }
+}
+
+bool UnpackBlocks(const uint8_t *&src, const uint8_t *end, uint32_t *codes, size_t count) {
+  for (size_t begin = 0; begin < count; begin += kBlockSize) {
+    const size_t size = std::min(kBlockSize, count - begin);
+    if (src >= end) return false;
+    const unsigned bits = *src++;
+    if (bits == 0) {
+      std::fill(codes + begin, codes + begin + size, 0u);
+      continue;
+    }
+
+    const size_t bytes = bits * kBlockSize / 8;
+    if (bits > 32 || static_cast<size_t>(end - src) < bytes) return false;
+
+    const uint8_t *cursor = src;
+    const uint64_t mask = (uint64_t(1) << bits) - 1;
+    uint64_t buffer = 0;
+    unsigned filled = 0;
+    for (size_t i = 0; i < size; ++i) {
+      if (filled < bits) {
+        uint32_t word;
+        std::memcpy(&word, cursor, sizeof(word));
+        cursor += sizeof(word);
+        buffer |= static_cast<uint64_t>(word) << filled;
+        filled += 32;
+      }
+      codes[begin + i] = static_cast<uint32_t>(buffer & mask);
+      buffer >>= bits;
+      filled -= bits;
+    }
+    src += bytes;
+  }
+  return true;
+}
+
+// Stripes are self-contained: the first row predicts from zero, later rows start from the pixel above
+void EncodeStripe(const float *depth, size_t width, size_t rowBegin, size_t rowEnd, float scale,
+                  std::vector<uint8_t> &out) {
+  std::vector<uint32_t> rows(width * 2);
+  uint32_t *above = rows.data();
+  uint32_t *current = rows.data() + width;
+  std::vector<uint32_t> codes(width * (rowEnd - rowBegin));
+
+  uint32_t *code = codes.data();
+  for (size_t row = rowBegin; row < rowEnd; ++row) {
+    QuantizeRow(depth + row * width, current, width, scale);
+
+    uint32_t predicted = (row > rowBegin && above[0] != kInvalid) ? above[0] : 0;
+    for (size_t col = 0; col < width; ++col) {
+      const uint32_t value = current[col];
+      if (value == kInvalid) {
+        *code++ = 0;
+      } else {
+        *code++ = ToCode(value, predicted);
+        predicted = value;
+      }
+    }
+    std::swap(above, current);
+  }
+
+  out.clear();
+  out.reserve(codes.size() / 2);
+  PackBlocks(codes.data(), codes.size(), out);
+}
+
+bool DecodeStripe(const uint8_t *src, size_t size, size_t width, size_t rowBegin, size_t rowEnd, float precision,
+                  float *depth) {
+  std::vector<uint32_t> codes(width * (rowEnd - rowBegin));
+  const uint8_t *cursor = src;
+  if (!UnpackBlocks(cursor, src + size, codes.data(), codes.size())) return false;
+
+  std::vector<uint32_t> rows(width * 2);
+  uint32_t *above = rows.data();
+  uint32_t *current = rows.data() + width;
+  const uint32_t *code = codes.data();
+  for (size_t row = rowBegin; row < rowEnd; ++row) {
+    uint32_t predicted = (row > rowBegin && above[0] != kInvalid) ? above[0] : 0;
+    for (size_t col = 0; col < width; ++col, ++code) {
+      if (*code == 0) {
+        current[col] = kInvalid;
+      } else {
+        current[col] = FromCode(*code, predicted);
+        predicted = current[col];
+      }
+    }
+    DequantizeRow(current, depth + row * width, width, precision);
+    std::swap(above, current);
+  }
+  return true;
+}
+
+bool ParseHeader(const uint8_t *data, size_t size, StreamHeader &header) {
+  if (data == nullptr || size < sizeof(header)) return false;
+  std::memcpy(&header, data, sizeof(header));
+  return std::memcmp(header.magic, DepthCodec::kMagic, sizeof(header.magic)) == 0 &&
+         header.version == DepthCodec::kVersion;
+}
+
+void ForEachStripe(size_t stripeCount, bool parallel, const std::function<void(size_t)> &body) {
+  if (!parallel || stripeCount < 2) {
+    for (size_t stripe = 0; stripe < stripeCount; ++stripe) body(stripe);
+    return;
+  }
+  ThreadPool::Shared().ParallelFor(0, stripeCount, 1, [&body](size_t begin, size_t end) {
+    for (size_t stripe = begin; stripe < end; ++stripe) body(stripe);
+  });
+}
+}  // namespace
+
+bool DepthCodec::Encode(const cv::Mat &depth, std::vector<uint8_t> &out, const Options &options) {
+  if (depth.empty() || depth.type() != CV_32FC1) {
+    LOG_ERROR_STREAM << "Depth codec expects a non-empty CV_32FC1 image";
+    return false;
+  }
+  const cv::Mat continuous = depth.isContinuous() ? depth : depth.clone();
+  return Encode(continuous.ptr<float>(), static_cast<size_t>(continuous.cols), static_cast<size_t>(continuous.rows),
+                out, options);
+}
+
+bool DepthCodec::Encode(const float *depth, size_t width, size_t height, std::vector<uint8_t> &out,
+                        const Options &options) {
+  if (depth == nullptr || width == 0 || height == 0 || !(options.precision_mm > 0.0f)) {
+    LOG_ERROR_STREAM << "Invalid depth codec input (" << width << "x" << height
+                     << ", precision " << options.precision_mm << " mm)";
+    return false;
+  }
+
+  const size_t stripeRows = std::max<size_t>(1, options.stripe_rows);
+  const size_t stripeCount = (height + stripeRows - 1) / stripeRows;
+  const float scale = 1.0f / options.precision_mm;
+
+  std::vector<std::vector<uint8_t>> stripes(stripeCount);
+  ForEachStripe(stripeCount, options.parallel, [&](size_t stripe) {
+    const size_t rowBegin = stripe * stripeRows;
+    EncodeStripe(depth, width, rowBegin, std::min(height, rowBegin + stripeRows), scale, stripes[stripe]);
+  });
+
+  StreamHeader header;
+  std::memset(&header, 0, sizeof(header));
+  std::memcpy(header.magic, kMagic, sizeof(header.magic));
+  header.version = kVersion;
+  header.width = static_cast<uint32_t>(width);
+  header.height = static_cast<uint32_t>(height);
+  header.precision_mm = options.precision_mm;
+  header.stripe_rows = static_cast<uint32_t>(stripeRows);
+  header.stripe_count = static_cast<uint32_t>(stripeCount);
+
+  size_t total = sizeof(header) + stripeCount * sizeof(uint32_t);
+  for (const auto &stripe : stripes) total += stripe.size();
+
+  out.resize(total);
+  uint8_t *cursor = out.data();
+  std::memcpy(cursor, &header, sizeof(header));
+  cursor += sizeof(header);
+  for (const auto &stripe : stripes) {
+    const uint32_t size = static_cast<uint32_t>(stripe.size());
+    std::memcpy(cursor, &size, sizeof(size));
+    cursor += sizeof(size);
+  }
+  for (const auto &stripe : stripes) {
+    std::memcpy(cursor, stripe.data(), stripe.size());
+    cursor += stripe.size();
+  }
+  return true;
+}
+
+bool DepthCodec::ReadInfo(const uint8_t *data, size_t size, Info &info) {
+  StreamHeader header;
+  if (!ParseHeader(data, size, header)) return false;
+
+  info.width = header.width;
+  info.height = header.height;
+  info.precision_mm = header.precision_mm;
+  return true;
+}
+
+bool DepthCodec::Decode(const std::vector<uint8_t> &data, cv::Mat &depth, bool parallel) {
+  return Decode(data.data(), data.size(), depth, parallel);
+}
+
+bool DepthCodec::Decode(const uint8_t *data, size_t size, cv::Mat &depth, bool parallel) {
+  StreamHeader header;
+  if (!ParseHeader(data, size, header)) {
+    LOG_ERROR_STREAM << "Not a depth codec stream";
+    return false;
+  }
+
+  const size_t width = header.width;
+  const size_t height = header.height;
+  const size_t stripeRows = header.stripe_rows;
+  const size_t maxSide = static_cast<size_t>(std::numeric_limits<int>::max());
+  if (width == 0 || height == 0 || width > maxSide || height > maxSide || stripeRows == 0 ||
+      !std::isfinite(header.precision_mm) || !(header.precision_mm > 0.0f) ||
+      header.stripe_count != (height + stripeRows - 1) / stripeRows ||
+      size < sizeof(header) + size_t(header.stripe_count) * sizeof(uint32_t)) {
+    LOG_ERROR_STREAM << "Corrupted depth codec header";
+    return false;
+  }
+
+  // Stripe offsets follow from the size table
+  std::vector<size_t> offsets(header.stripe_count + 1);
+  offsets[0] = sizeof(header) + size_t(header.stripe_count) * sizeof(uint32_t);
+  for (size_t stripe = 0; stripe < header.stripe_count; ++stripe) {
+    uint32_t stripeSize;
+    std::memcpy(&stripeSize, data + sizeof(header) + stripe * sizeof(uint32_t), sizeof(stripeSize));
+    offsets[stripe + 1] = offsets[stripe] + stripeSize;
+  }
+  // Every block of up to kBlockSize pixels takes at least its bit-width byte, so the payload bounds the pixel count
+  // a valid stream can declare. Rejecting larger headers keeps a corrupted file from allocating a huge image.
+  const uint64_t pixels = static_cast<uint64_t>(width) * height;
+  if (offsets.back() > size || pixels > static_cast<uint64_t>(offsets.back() - offsets[0]) * kBlockSize) {
+    LOG_ERROR_STREAM << "Truncated depth codec stream";
+    return false;
+  }
+
+  try {
+    depth.create(static_cast<int>(height), static_cast<int>(width), CV_32FC1);
+  } catch (const std::exception &e) {
+    LOG_ERROR_STREAM << "Failed to allocate " << width << "x" << height << " depth image: " << e.what();
+    depth.release();
+    return false;
+  }
+  float *output = depth.ptr<float>();
+  std::atomic<bool> ok(true);
+  ForEachStripe(header.stripe_count, parallel, [&](size_t stripe) {
+    const size_t rowBegin = stripe * stripeRows;
+    try {
+      if (!DecodeStripe(data + offsets[stripe], offsets[stripe + 1] - offsets[stripe], width, rowBegin,
+                        std::min(height, rowBegin + stripeRows), header.precision_mm, output)) {
+        ok = false;
+      }
+    } catch (const std::bad_alloc &) {
+      ok = false;
+    }
+  });
+
+  if (!ok) {
+    LOG_ERROR_STREAM << "Corrupted depth codec stripe data";
+    depth.release();
+  }
+  return ok;
+}
+
+bool DepthCodec::WriteFile(const std::string &path, const cv::Mat &depth, const Options &options) {
+  std::vector<uint8_t> encoded;
+  if (!Encode(depth, encoded, options)) return false;
+
+  FILE *file = std::fopen(path.c_str(), "wb");
+  if (file == nullptr) {
+    LOG_ERROR_STREAM << "Failed to create " << path;
+    return false;
+  }
+  bool ok = std::fwrite(encoded.data(), 1, encoded.size(), file) == encoded.size();
+  ok = (std::fclose(file) == 0) && ok;
+  if (!ok) {
+    LOG_ERROR_STREAM << "Failed to write " << path;
+    std::remove(path.c_str());
+  }
+  return ok;
+}
+
+bool DepthCodec::ReadFile(const std::string &path, cv::Mat &depth) {
+  FILE *file = std::fopen(path.c_str(), "rb");
+  if (file == nullptr) {
+    LOG_ERROR_STREAM << "Failed to open " << path;
+    return false;
+  }
+
+  std::vector<uint8_t> encoded;
+  bool ok = std::fseek(file, 0, SEEK_END) == 0;
+  const long size = ok ? std::ftell(file) : -1;
+  ok = ok && size > 0 && std::fseek(file, 0, SEEK_SET) == 0;
+  if (ok) {
+    encoded.resize(static_cast<size_t>(size));
+    ok = std::fread(encoded.data(), 1, encoded.size(), file) == encoded.size();
+  }
+  std::fclose(file);
+
+  if (!ok) {
+    LOG_ERROR_STREAM << "Failed to read " << path;
+    return false;
+  }
+  return Decode(encoded, depth);
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <opencv2/core.hpp>
+
+/**
+ * @brief 深度图压缩编解码（.mdc）
+ *
+ * 在传感器实际精度下无损：深度（毫米，float）先按 precision_mm 量化为整数，每行以左侧最近的
+ * 有效像素为预测值做差分，残差经 zigzag 映射后按 32 个一组以组内最大位宽紧凑打包。
+ * 无效像素（NaN、0 或负值）单独编码，不打断相邻有效像素的差分，解码后为 NaN。
+ *
+ * 图像按行分条（stripe）独立编码，编解码均在共享线程池上按条并行；量化和反量化使用
+ * AVX2 / NEON 向量化。码流不依赖外部压缩库，可直接落盘，也可经 PayloadChunker 分片后通过
+ * 感知协议发送。码流布局（本机小端序）：
+ *
+ *   头部（32 字节）| uint32 各条字节数[stripe_count] | 各条数据 ...
+ */
+class DepthCodec
+{
+public:
+    static constexpr char kMagic[4] = {'M', 'M', 'D', 'C'};
+    static constexpr uint16_t kVersion = 1;
+
+    struct Options
+    {
+        float precision_mm = 0.01f;  // 量化步长，应不大于传感器的深度分辨率
+        size_t stripe_rows = 32;     // 每条的行数，决定并行粒度
+        bool parallel = true;
+    };
+
+    struct Info
+    {
+        uint32_t width = 0;
+        uint32_t height = 0;
+        float precision_mm = 0.0f;
+    };
+
+    /**
+     * @brief 编码 CV_32FC1 深度图
+     * @return 深度图为空、类型不符或精度非法时返回 false
+     */
+    static bool Encode(const cv::Mat& depth, std::vector<uint8_t>& out, const Options& options);
+
+    static bool Encode(const float* depth, size_t width, size_t height, std::vector<uint8_t>& out,
+                       const Options& options);
+
+    /**
+     * @brief 只解析码流头部
+     */
+    static bool ReadInfo(const uint8_t* data, size_t size, Info& info);
+
+    /**
+     * @brief 解码为 CV_32FC1 深度图，码流损坏（含头部尺寸与数据量不符）或内存不足时返回 false，不抛异常
+     */
+    static bool Decode(const uint8_t* data, size_t size, cv::Mat& depth, bool parallel = true);
+
+    static bool Decode(const std::vector<uint8_t>& data, cv::Mat& depth, bool parallel = true);
+
+    /**
+     * @brief 编码并写入文件
+     */
+    static bool WriteFile(const std::string& path, const cv::Mat& depth, const Options& options);
+
+    /**
+     * @brief 读取并解码文件
+     */
+    static bool ReadFile(const std::string& path, cv::Mat& depth);
+};
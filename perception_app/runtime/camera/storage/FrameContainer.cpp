@@ -0,0 +1,462 @@
+#include "FrameContainer.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "FrameSet.hpp"
+#include "Logger.hpp"
+
+constexpr char FrameContainer::kMagic[8];
+
+namespace {
+size_t AlignUp(size_t value) {
+  return (value + FrameContainer::kAlignment - 1) / FrameContainer::kAlignment * FrameContainer::kAlignment;
+}
+
+void CopyString(const std::string &value, char (&target)[64]) {
+  std::memset(target, 0, sizeof(target));
+  std::memcpy(target, value.data(), std::min(value.size(), sizeof(target) - 1));
+}
+
+std::string ReadString(const char (&source)[64]) { return std::string(source, strnlen(source, sizeof(source))); }
+
+void PackIntrinsics(const mmind::eye::Intrinsics2DCamera &intrinsics, double (&target)[9]) {
+  const auto &m = intrinsics.cameraMatrix;
+  const auto &d = intrinsics.cameraDistortion;
+  const double values[9] = {m.fx, m.fy, m.cx, m.cy, d.k1, d.k2, d.p1, d.p2, d.k3};
+  std::memcpy(target, values, sizeof(values));
+}
+
+void UnpackIntrinsics(const double (&source)[9], mmind::eye::Intrinsics2DCamera &intrinsics) {
+  auto &m = intrinsics.cameraMatrix;
+  auto &d = intrinsics.cameraDistortion;
+  m.fx = source[0];
+  m.fy = source[1];
+  m.cx = source[2];
+  m.cy = source[3];
+  d.k1 = source[4];
+  d.k2 = source[5];
+  d.p1 = source[6];
+  d.p2 = source[7];
+  d.k3 = source[8];
+}
+
+template <typename Rigid>
+void PackRigid(const Rigid &rigid, double (&target)[12]) {
+  for (int row = 0; row < 3; ++row) {
+    for (int col = 0; col < 3; ++col) {
+      target[row * 3 + col] = rigid.rotation[row][col];
+    }
+    target[9 + row] = rigid.translation[row];
+  }
+}
+
+template <typename Rigid>
+void UnpackRigid(const double (&source)[12], Rigid &rigid) {
+  for (int row = 0; row < 3; ++row) {
+    for (int col = 0; col < 3; ++col) {
+      rigid.rotation[row][col] = source[row * 3 + col];
+    }
+    rigid.translation[row] = source[9 + row];
+  }
+}
+
+bool WriteAll(int fd, const void *data, size_t size) {
+  const uint8_t *cursor = static_cast<const uint8_t *>(data);
+  while (size > 0) {
+    // Large chunks keep the write sequential; the cap only bounds a single syscall
+    const ssize_t written = ::write(fd, cursor, std::min<size_t>(size, size_t(1) << 30));
+    if (written < 0) {
+      if (errno == EINTR) continue;
+      return false;
+    }
+    cursor += written;
+    size -= static_cast<size_t>(written);
+  }
+  return true;
+}
+}  // namespace
+
+const char *FrameContainerSectionTypeToString(FrameContainerSectionType type) {
+  switch (type) {
+    case FrameContainerSectionType::Depth:
+      return "Depth";
+    case FrameContainerSectionType::Color:
+      return "Color";
+    case FrameContainerSectionType::PointXYZ:
+      return "PointXYZ";
+    case FrameContainerSectionType::PointBGR:
+      return "PointBGR";
+    case FrameContainerSectionType::Normal:
+      return "Normal";
+    default:
+      return "Unknown";
+  }
+}
+
+bool FrameContainer::WriteFrame(const std::string &path, const FrameSet &frame, const WriteOptions &options) {
+  FrameContainerWriter writer;
+  writer.SetSuffix(frame.suffix);
+  writer.SetCameraId(frame.camera_id);
+  writer.SetIntrinsics(frame.GetIntrinsics());
+  writer.SetTransformation(frame.GetTransformation());
+  writer.SetPointsOrigin(frame.GetCropRegion().tl());
+
+  // Requested together so that the point cloud variants share one pass
+  FrameProductMask clouds = kNoFrameProducts;
+  if (options.points) clouds |= ToProductMask(FrameProduct::PointCloud);
+  if (options.point_colors) clouds |= ToProductMask(FrameProduct::TexturedPointCloud);
+  if (options.normals) clouds |= ToProductMask(FrameProduct::PointCloudWithNormals);
+  frame.DecodeFrame(clouds);
+
+  if (options.depth && frame.IsAvailable(FrameProduct::Depth)) {
+    writer.AddDepth(frame.GetDepthImage());
+  }
+  if (options.color && frame.IsAvailable(FrameProduct::Color)) {
+    writer.AddColor(frame.GetColor());
+  }
+
+  bool hasPoints = false;
+  if (options.points && frame.IsAvailable(FrameProduct::PointCloud)) {
+    writer.AddPoints(frame.GetPointCloud());
+    hasPoints = true;
+  }
+  if (options.point_colors && frame.IsAvailable(FrameProduct::TexturedPointCloud)) {
+    writer.AddTexturedPoints(frame.GetTexturedPointCloud(), !hasPoints && options.points);
+  }
+  if (options.normals && frame.IsAvailable(FrameProduct::PointCloudWithNormals)) {
+    writer.AddNormals(frame.GetPointCloudWithNormals());
+  }
+
+  return writer.Write(path);
+}
+
+FrameContainerWriter::FrameContainerWriter() {
+  std::memset(&header_, 0, sizeof(header_));
+  std::memcpy(header_.magic, FrameContainer::kMagic, sizeof(header_.magic));
+  header_.version = FrameContainer::kVersion;
+  header_.header_size = sizeof(FrameContainerHeader);
+  SetTransformation(mmind::eye::FrameTransformation());
+  PackRigid(mmind::eye::Transformation(), header_.depth_to_texture);
+}
+
+void FrameContainerWriter::SetSuffix(const std::string &suffix) { CopyString(suffix, header_.suffix); }
+
+void FrameContainerWriter::SetCameraId(const std::string &cameraId) { CopyString(cameraId, header_.camera_id); }
+
+void FrameContainerWriter::SetIntrinsics(const mmind::eye::CameraIntrinsics &intrinsics) {
+  PackIntrinsics(intrinsics.depth, header_.depth_intrinsics);
+  PackIntrinsics(intrinsics.texture, header_.texture_intrinsics);
+  PackRigid(intrinsics.depthToTexture, header_.depth_to_texture);
+}
+
+void FrameContainerWriter::SetTransformation(const mmind::eye::FrameTransformation &transformation) {
+  PackRigid(transformation, header_.transformation);
+}
+
+void FrameContainerWriter::SetPointsOrigin(const cv::Point &origin) {
+  header_.points_origin[0] = origin.x;
+  header_.points_origin[1] = origin.y;
+}
+
+void FrameContainerWriter::AddSection(FrameContainerSectionType type, uint32_t elementSize, uint32_t width,
+                                      uint32_t height, const void *data) {
+  if (data == nullptr || width == 0 || height == 0) return;
+
+  PendingSection pending;
+  pending.section.type = static_cast<uint32_t>(type);
+  pending.section.element_size = elementSize;
+  pending.section.width = width;
+  pending.section.height = height;
+  pending.section.offset = 0;
+  pending.section.size = uint64_t(width) * height * elementSize;
+  pending.data = data;
+  sections_.push_back(pending);
+}
+
+void FrameContainerWriter::AddOwnedSection(FrameContainerSectionType type, uint32_t elementSize, uint32_t width,
+                                           uint32_t height, std::vector<uint8_t> data) {
+  if (data.size() != size_t(width) * height * elementSize) {
+    LOG_ERROR_STREAM << "Frame container section " << FrameContainerSectionTypeToString(type) << " has "
+                     << data.size() << " bytes, expected " << size_t(width) * height * elementSize;
+    return;
+  }
+  owned_.push_back(std::move(data));
+  AddSection(type, elementSize, width, height, owned_.back().data());
+}
+
+void FrameContainerWriter::AddDepth(const cv::Mat &depth) {
+  if (depth.empty() || depth.type() != CV_32FC1) return;
+  if (!depth.isContinuous()) {
+    retained_.push_back(depth.clone());
+  }
+  const cv::Mat &continuous = depth.isContinuous() ? depth : retained_.back();
+  AddSection(FrameContainerSectionType::Depth, sizeof(float), continuous.cols, continuous.rows, continuous.data);
+}
+
+void FrameContainerWriter::AddColor(const cv::Mat &color) {
+  if (color.empty() || color.type() != CV_8UC3) return;
+  if (!color.isContinuous()) {
+    retained_.push_back(color.clone());
+  }
+  const cv::Mat &continuous = color.isContinuous() ? color : retained_.back();
+  AddSection(FrameContainerSectionType::Color, 3, continuous.cols, continuous.rows, continuous.data);
+}
+
+void FrameContainerWriter::AddPoints(const mmind::eye::PointCloud &points) {
+  if (points.isEmpty()) return;
+  AddSection(FrameContainerSectionType::PointXYZ, sizeof(mmind::eye::PointXYZ), points.width(), points.height(),
+             points.data());
+}
+
+void FrameContainerWriter::AddTexturedPoints(const mmind::eye::TexturedPointCloud &points, bool withPoints) {
+  if (points.isEmpty()) return;
+
+  // The SDK interleaves XYZ and BGRA; the container stores them as separate planar sections
+  const size_t count = points.width() * points.height();
+  std::vector<uint8_t> xyz(withPoints ? count * sizeof(mmind::eye::PointXYZ) : 0);
+  std::vector<uint8_t> bgr(count * 3);
+  auto *xyzOut = reinterpret_cast<mmind::eye::PointXYZ *>(xyz.data());
+  for (size_t i = 0; i < count; ++i) {
+    const mmind::eye::PointXYZBGR &point = points[i];
+    if (withPoints) {
+      xyzOut[i].x = point.x;
+      xyzOut[i].y = point.y;
+      xyzOut[i].z = point.z;
+    }
+    bgr[i * 3 + 0] = point.b;
+    bgr[i * 3 + 1] = point.g;
+    bgr[i * 3 + 2] = point.r;
+  }
+
+  if (withPoints) {
+    AddOwnedSection(FrameContainerSectionType::PointXYZ, sizeof(mmind::eye::PointXYZ), points.width(),
+                    points.height(), std::move(xyz));
+  }
+  AddOwnedSection(FrameContainerSectionType::PointBGR, 3, points.width(), points.height(), std::move(bgr));
+}
+
+void FrameContainerWriter::AddNormals(const mmind::eye::PointCloudWithNormals &points) {
+  if (points.isEmpty()) return;
+
+  const size_t count = points.width() * points.height();
+  std::vector<uint8_t> normals(count * sizeof(mmind::eye::NormalVector));
+  auto *out = reinterpret_cast<mmind::eye::NormalVector *>(normals.data());
+  for (size_t i = 0; i < count; ++i) {
+    out[i] = points[i].normal;
+  }
+  AddOwnedSection(FrameContainerSectionType::Normal, sizeof(mmind::eye::NormalVector), points.width(),
+                  points.height(), std::move(normals));
+}
+
+bool FrameContainerWriter::Write(const std::string &path) const {
+  // Lay out header, section table and aligned data sections
+  FrameContainerHeader header = header_;
+  std::vector<FrameContainerSection> table;
+  table.reserve(sections_.size());
+  size_t offset = AlignUp(sizeof(FrameContainerHeader) + sections_.size() * sizeof(FrameContainerSection));
+  for (const auto &pending : sections_) {
+    FrameContainerSection section = pending.section;
+    section.offset = offset;
+    table.push_back(section);
+    offset = AlignUp(offset + section.size);
+  }
+  header.section_count = static_cast<uint32_t>(table.size());
+  header.file_size = table.empty() ? sizeof(FrameContainerHeader) : table.back().offset + table.back().size;
+
+  std::vector<uint8_t> head(table.empty() ? sizeof(FrameContainerHeader) : table.front().offset, 0);
+  std::memcpy(head.data(), &header, sizeof(header));
+  if (!table.empty()) {
+    std::memcpy(head.data() + sizeof(header), table.data(), table.size() * sizeof(FrameContainerSection));
+  }
+
+  const std::string temporary = path + ".tmp";
+  const int fd = ::open(temporary.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0) {
+    LOG_ERROR_STREAM << "Failed to create frame container " << temporary << ": " << std::strerror(errno);
+    return false;
+  }
+
+  static const uint8_t kZeros[FrameContainer::kAlignment] = {};
+  bool ok = WriteAll(fd, head.data(), head.size());
+  size_t position = head.size();
+  for (size_t i = 0; ok && i < table.size(); ++i) {
+    if (table[i].offset > position) {
+      ok = WriteAll(fd, kZeros, table[i].offset - position);
+    }
+    ok = ok && WriteAll(fd, sections_[i].data, table[i].size);
+    position = table[i].offset + table[i].size;
+  }
+  ok = (::close(fd) == 0) && ok;
+
+  if (!ok || std::rename(temporary.c_str(), path.c_str()) != 0) {
+    LOG_ERROR_STREAM << "Failed to write frame container " << path << ": " << std::strerror(errno);
+    ::unlink(temporary.c_str());
+    return false;
+  }
+  return true;
+}
+
+MappedFrameContainer::~MappedFrameContainer() { Close(); }
+
+MappedFrameContainer::MappedFrameContainer(MappedFrameContainer &&other) noexcept
+    : data_(other.data_), size_(other.size_), sections_(std::move(other.sections_)) {
+  other.data_ = nullptr;
+  other.size_ = 0;
+}
+
+MappedFrameContainer &MappedFrameContainer::operator=(MappedFrameContainer &&other) noexcept {
+  if (this != &other) {
+    Close();
+    data_ = other.data_;
+    size_ = other.size_;
+    sections_ = std::move(other.sections_);
+    other.data_ = nullptr;
+    other.size_ = 0;
+  }
+  return *this;
+}
+
+bool MappedFrameContainer::Open(const std::string &path) {
+  Close();
+
+  const int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    LOG_ERROR_STREAM << "Failed to open frame container " << path << ": " << std::strerror(errno);
+    return false;
+  }
+  struct stat st = {};
+  if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(FrameContainerHeader)) {
+    LOG_ERROR_STREAM << "Frame container " << path << " is truncated";
+    ::close(fd);
+    return false;
+  }
+
+  const size_t size = static_cast<size_t>(st.st_size);
+  void *mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+  if (mapped == MAP_FAILED) {
+    LOG_ERROR_STREAM << "Failed to map frame container " << path << ": " << std::strerror(errno);
+    return false;
+  }
+  data_ = static_cast<const uint8_t *>(mapped);
+  size_ = size;
+
+  const FrameContainerHeader &header = Header();
+  if (std::memcmp(header.magic, FrameContainer::kMagic, sizeof(header.magic)) != 0 ||
+      header.version != FrameContainer::kVersion || header.header_size < sizeof(FrameContainerHeader) ||
+      header.header_size + uint64_t(header.section_count) * sizeof(FrameContainerSection) > size_) {
+    LOG_ERROR_STREAM << "Invalid frame container header: " << path;
+    Close();
+    return false;
+  }
+
+  // The table is copied out so section lookups never read unaligned mapped memory
+  sections_.resize(header.section_count);
+  std::memcpy(sections_.data(), data_ + header.header_size, sections_.size() * sizeof(FrameContainerSection));
+  for (const auto &section : sections_) {
+    const uint64_t expected = uint64_t(section.width) * section.height * section.element_size;
+    if (section.size != expected || section.offset % FrameContainer::kAlignment != 0 ||
+        section.offset > size_ || section.size > size_ - section.offset) {
+      LOG_ERROR_STREAM << "Invalid frame container section "
+                       << FrameContainerSectionTypeToString(static_cast<FrameContainerSectionType>(section.type))
+                       << " in " << path;
+      Close();
+      return false;
+    }
+  }
+
+  madvise(const_cast<uint8_t *>(data_), size_, MADV_WILLNEED);
+  return true;
+}
+
+void MappedFrameContainer::Close() {
+  if (data_ != nullptr) {
+    munmap(const_cast<uint8_t *>(data_), size_);
+  }
+  data_ = nullptr;
+  size_ = 0;
+  sections_.clear();
+}
+
+const FrameContainerHeader &MappedFrameContainer::Header() const {
+  return *reinterpret_cast<const FrameContainerHeader *>(data_);
+}
+
+const FrameContainerSection *MappedFrameContainer::Find(FrameContainerSectionType type) const {
+  for (const auto &section : sections_) {
+    if (section.type == static_cast<uint32_t>(type)) {
+      return &section;
+    }
+  }
+  return nullptr;
+}
+
+const void *MappedFrameContainer::SectionData(FrameContainerSectionType type, uint32_t elementSize, uint32_t &width,
+                                              uint32_t &height) const {
+  width = 0;
+  height = 0;
+  const FrameContainerSection *section = Find(type);
+  if (section == nullptr || section->element_size != elementSize) {
+    return nullptr;
+  }
+  width = section->width;
+  height = section->height;
+  return Data(*section);
+}
+
+cv::Mat MappedFrameContainer::Depth() const {
+  uint32_t width = 0;
+  uint32_t height = 0;
+  const void *data = SectionData(FrameContainerSectionType::Depth, sizeof(float), width, height);
+  if (data == nullptr) return cv::Mat();
+  return cv::Mat(static_cast<int>(height), static_cast<int>(width), CV_32FC1, const_cast<void *>(data));
+}
+
+cv::Mat MappedFrameContainer::Color() const {
+  uint32_t width = 0;
+  uint32_t height = 0;
+  const void *data = SectionData(FrameContainerSectionType::Color, 3, width, height);
+  if (data == nullptr) return cv::Mat();
+  return cv::Mat(static_cast<int>(height), static_cast<int>(width), CV_8UC3, const_cast<void *>(data));
+}
+
+const mmind::eye::PointXYZ *MappedFrameContainer::Points(uint32_t &width, uint32_t &height) const {
+  return static_cast<const mmind::eye::PointXYZ *>(
+      SectionData(FrameContainerSectionType::PointXYZ, sizeof(mmind::eye::PointXYZ), width, height));
+}
+
+const uint8_t *MappedFrameContainer::PointColors(uint32_t &width, uint32_t &height) const {
+  return static_cast<const uint8_t *>(SectionData(FrameContainerSectionType::PointBGR, 3, width, height));
+}
+
+const mmind::eye::NormalVector *MappedFrameContainer::Normals(uint32_t &width, uint32_t &height) const {
+  return static_cast<const mmind::eye::NormalVector *>(
+      SectionData(FrameContainerSectionType::Normal, sizeof(mmind::eye::NormalVector), width, height));
+}
+
+mmind::eye::CameraIntrinsics MappedFrameContainer::Intrinsics() const {
+  mmind::eye::CameraIntrinsics intrinsics;
+  UnpackIntrinsics(Header().depth_intrinsics, intrinsics.depth);
+  UnpackIntrinsics(Header().texture_intrinsics, intrinsics.texture);
+  UnpackRigid(Header().depth_to_texture, intrinsics.depthToTexture);
+  return intrinsics;
+}
+
+mmind::eye::FrameTransformation MappedFrameContainer::Transformation() const {
+  mmind::eye::FrameTransformation transformation;
+  UnpackRigid(Header().transformation, transformation);
+  return transformation;
+}
+
+std::string MappedFrameContainer::Suffix() const { return ReadString(Header().suffix); }
+
+std::string MappedFrameContainer::CameraId() const { return ReadString(Header().camera_id); }
+
+cv::Point MappedFrameContainer::PointsOrigin() const {
+  return cv::Point(Header().points_origin[0], Header().points_origin[1]);
+}
@@ -0,0 +1,251 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <opencv2/core.hpp>
+#include "area_scan_3d_camera/Frame2DAnd3D.h"
+#include "area_scan_3d_camera/CameraProperties.h"
+#include "CommonTypes.h"
+
+class FrameSet;
+
+/**
+ * @brief 帧容器数据段类型
+ */
+enum class FrameContainerSectionType : uint32_t {
+    Depth = 1,     // float，毫米，无效值为 NaN 或 0
+    Color = 2,     // uint8 BGR
+    PointXYZ = 3,  // mmind::eye::PointXYZ，毫米，已按文件头中的坐标变换变换
+    PointBGR = 4,  // 逐点颜色 uint8 BGR，与 PointXYZ 同尺寸
+    Normal = 5,    // mmind::eye::NormalVector（x, y, z, curvature），与 PointXYZ 同尺寸
+};
+
+const char* FrameContainerSectionTypeToString(FrameContainerSectionType type);
+
+/**
+ * @brief 帧容器文件头，固定 512 字节，各字段自然对齐，无填充
+ */
+struct FrameContainerHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t header_size;         // sizeof(FrameContainerHeader)
+    uint32_t section_count;
+    uint32_t reserved;
+    uint64_t file_size;
+    double depth_intrinsics[9];   // fx, fy, cx, cy, k1, k2, p1, p2, k3
+    double texture_intrinsics[9];
+    double depth_to_texture[12];  // 行主序 3x3 旋转 + 平移
+    double transformation[12];    // 点云使用的坐标变换，行主序 3x3 旋转 + 平移
+    char suffix[64];
+    char camera_id[64];
+    int32_t points_origin[2];     // 点云类数据段 (0, 0) 在深度图中的像素坐标（深度裁剪的 ROI 左上角）
+    uint8_t padding[8];
+};
+
+/**
+ * @brief 数据段描述，紧跟在文件头之后
+ */
+struct FrameContainerSection
+{
+    uint32_t type;          // FrameContainerSectionType
+    uint32_t element_size;  // 单个元素字节数
+    uint32_t width;
+    uint32_t height;
+    uint64_t offset;        // 相对文件起始位置，按 FrameContainer::kAlignment 对齐
+    uint64_t size;          // width * height * element_size
+};
+
+static_assert(sizeof(FrameContainerHeader) == 512, "frame container header layout changed");
+static_assert(sizeof(FrameContainerSection) == 32, "frame container section layout changed");
+
+/**
+ * @brief 二进制帧容器（.mfc）
+ *
+ * 一个文件保存一帧的深度图、彩色图、有序点云（XYZ）以及可选的逐点颜色和法线，文件头记录
+ * 相机内参、坐标变换、帧标识和相机序列号。启用深度裁剪时点云类数据段只覆盖裁剪区域，
+ * 文件头的 points_origin 记录其在深度图中的偏移（旧文件该字段为 0，即整幅）。布局：
+ *
+ *   FrameContainerHeader | FrameContainerSection[section_count] | 数据段 ...
+ *
+ * 所有数据段按 64 字节对齐、以本机小端序原样存放，读取时 mmap 整个文件即可零拷贝访问，
+ * 写入时每个数据段一次顺序写出。相比 SDK 导出的 PLY，写入和读取都不需要逐点格式化 / 解析。
+ */
+class FrameContainer
+{
+public:
+    static constexpr char kMagic[8] = {'M', 'M', 'F', 'R', 'A', 'M', 'E', '\0'};
+    static constexpr uint32_t kVersion = 1;
+    static constexpr size_t kAlignment = 64;
+
+    /**
+     * @brief 写入 FrameSet 时包含的内容
+     */
+    struct WriteOptions
+    {
+        bool depth = true;
+        bool color = true;
+        bool points = true;         // 变换后的点云坐标
+        bool point_colors = false;  // 逐点颜色（来自有纹理点云）
+        bool normals = false;       // 法线，仅 SDK 采集的帧可用
+    };
+
+    /**
+     * @brief 将 FrameSet 写入帧容器，按需计算点云类数据产品，不可用的产品跳过
+     */
+    static bool WriteFrame(const std::string& path, const FrameSet& frame, const WriteOptions& options);
+};
+
+/**
+ * @brief 帧容器写入器
+ *
+ * 先登记各数据段（只记录指针，不拷贝），Write 时按登记顺序一次性顺序写出。写入先落到
+ * 临时文件再重命名，读取方不会看到写了一半的文件。
+ */
+class FrameContainerWriter
+{
+public:
+    FrameContainerWriter();
+
+    void SetSuffix(const std::string& suffix);
+    void SetCameraId(const std::string& cameraId);
+    void SetIntrinsics(const mmind::eye::CameraIntrinsics& intrinsics);
+    void SetTransformation(const mmind::eye::FrameTransformation& transformation);
+    void SetPointsOrigin(const cv::Point& origin);
+
+    /**
+     * @brief 登记数据段，data 在 Write 返回前必须保持有效
+     */
+    void AddSection(FrameContainerSectionType type, uint32_t elementSize, uint32_t width, uint32_t height,
+                    const void* data);
+
+    /**
+     * @brief 登记数据段并由写入器持有数据（用于需要从交错格式中抽取的数据）
+     */
+    void AddOwnedSection(FrameContainerSectionType type, uint32_t elementSize, uint32_t width, uint32_t height,
+                         std::vector<uint8_t> data);
+
+    /**
+     * @brief 登记 CV_32FC1 深度图，不连续的图像先拷贝为连续存储
+     */
+    void AddDepth(const cv::Mat& depth);
+
+    /**
+     * @brief 登记 CV_8UC3 彩色图
+     */
+    void AddColor(const cv::Mat& color);
+
+    void AddPoints(const mmind::eye::PointCloud& points);
+
+    /**
+     * @brief 从有纹理点云中抽取坐标和逐点颜色
+     * @param withPoints 是否同时写入坐标（已通过 AddPoints 写入时为 false）
+     */
+    void AddTexturedPoints(const mmind::eye::TexturedPointCloud& points, bool withPoints = true);
+
+    /**
+     * @brief 从带法线点云中抽取法线，坐标需另行通过 AddPoints 写入
+     */
+    void AddNormals(const mmind::eye::PointCloudWithNormals& points);
+
+    /**
+     * @return 文件写入成功
+     */
+    bool Write(const std::string& path) const;
+
+private:
+    struct PendingSection
+    {
+        FrameContainerSection section;
+        const void* data;
+    };
+
+    FrameContainerHeader header_;
+    std::vector<PendingSection> sections_;
+    std::vector<std::vector<uint8_t>> owned_;
+    std::vector<cv::Mat> retained_;  // 为保证连续存储而拷贝的图像
+};
+
+/**
+ * @brief 只读映射的帧容器
+ *
+ * Open 后整个文件映射到内存，Depth / Color / Points 等返回直接指向映射内存的视图，
+ * 视图在对象销毁或重新 Open 前有效，需要更长生命周期时应深拷贝。对象可移动，不可复制。
+ */
+class MappedFrameContainer
+{
+public:
+    MappedFrameContainer() = default;
+    ~MappedFrameContainer();
+
+    MappedFrameContainer(MappedFrameContainer&& other) noexcept;
+    MappedFrameContainer& operator=(MappedFrameContainer&& other) noexcept;
+    MappedFrameContainer(const MappedFrameContainer&) = delete;
+    MappedFrameContainer& operator=(const MappedFrameContainer&) = delete;
+
+    /**
+     * @brief 映射并校验文件（魔数、版本、数据段边界）
+     */
+    bool Open(const std::string& path);
+
+    void Close();
+
+    bool IsOpen() const { return data_ != nullptr; }
+
+    const FrameContainerHeader& Header() const;
+
+    const std::vector<FrameContainerSection>& Sections() const { return sections_; }
+
+    /**
+     * @brief 查找数据段，不存在时返回 nullptr
+     */
+    const FrameContainerSection* Find(FrameContainerSectionType type) const;
+
+    /**
+     * @brief 数据段起始地址
+     */
+    const void* Data(const FrameContainerSection& section) const { return data_ + section.offset; }
+
+    /**
+     * @brief 深度图视图（CV_32FC1），不存在时返回空图
+     */
+    cv::Mat Depth() const;
+
+    /**
+     * @brief 彩色图视图（CV_8UC3），不存在时返回空图
+     */
+    cv::Mat Color() const;
+
+    /**
+     * @brief 点云坐标，不存在时返回 nullptr，宽高置 0
+     */
+    const mmind::eye::PointXYZ* Points(uint32_t& width, uint32_t& height) const;
+
+    /**
+     * @brief 逐点 BGR 颜色（每点 3 字节），不存在时返回 nullptr
+     */
+    const uint8_t* PointColors(uint32_t& width, uint32_t& height) const;
+
+    const mmind::eye::NormalVector* Normals(uint32_t& width, uint32_t& height) const;
+
+    mmind::eye::CameraIntrinsics Intrinsics() const;
+    mmind::eye::FrameTransformation Transformation() const;
+    std::string Suffix() const;
+    std::string CameraId() const;
+
+    /**
+     * @brief 点云类数据段左上角在深度图中的像素坐标
+     */
+    cv::Point PointsOrigin() const;
+
+private:
+    const void* SectionData(FrameContainerSectionType type, uint32_t elementSize, uint32_t& width,
+                            uint32_t& height) const;
+
+private:
+    const uint8_t* data_ = nullptr;
+    size_t size_ = 0;
+    std::vector<FrameContainerSection> sections_;
+};
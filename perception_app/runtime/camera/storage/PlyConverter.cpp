@@ -0,0 +1,438 @@
+#include "PlyConverter.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include "Logger.hpp"
+
+namespace {
+// Vertices are staged in chunks so binary output is written in large sequential blocks
+constexpr size_t kChunkVertices = 1 << 16;
+
+enum class PlyType { Int8, UInt8, Int16, UInt16, Int32, UInt32, Float32, Float64, Unknown };
+
+PlyType ParsePlyType(const std::string &name) {
+  if (name == "char" || name == "int8") return PlyType::Int8;
+  if (name == "uchar" || name == "uint8") return PlyType::UInt8;
+  if (name == "short" || name == "int16") return PlyType::Int16;
+  if (name == "ushort" || name == "uint16") return PlyType::UInt16;
+  if (name == "int" || name == "int32") return PlyType::Int32;
+  if (name == "uint" || name == "uint32") return PlyType::UInt32;
+  if (name == "float" || name == "float32") return PlyType::Float32;
+  if (name == "double" || name == "float64") return PlyType::Float64;
+  return PlyType::Unknown;
+}
+
+size_t PlyTypeSize(PlyType type) {
+  switch (type) {
+    case PlyType::Int8:
+    case PlyType::UInt8:
+      return 1;
+    case PlyType::Int16:
+    case PlyType::UInt16:
+      return 2;
+    case PlyType::Int32:
+    case PlyType::UInt32:
+    case PlyType::Float32:
+      return 4;
+    case PlyType::Float64:
+      return 8;
+    default:
+      return 0;
+  }
+}
+
+template <typename T>
+T Load(const uint8_t *data) {
+  T value;
+  std::memcpy(&value, data, sizeof(T));
+  return value;
+}
+
+double ReadBinary(PlyType type, const uint8_t *data) {
+  switch (type) {
+    case PlyType::Int8:
+      return Load<int8_t>(data);
+    case PlyType::UInt8:
+      return Load<uint8_t>(data);
+    case PlyType::Int16:
+      return Load<int16_t>(data);
+    case PlyType::UInt16:
+      return Load<uint16_t>(data);
+    case PlyType::Int32:
+      return Load<int32_t>(data);
+    case PlyType::UInt32:
+      return Load<uint32_t>(data);
+    case PlyType::Float32:
+      return Load<float>(data);
+    case PlyType::Float64:
+      return Load<double>(data);
+    default:
+      return 0.0;
+  }
+}
+
+struct PlyProperty
+{
+  std::string name;
+  PlyType type = PlyType::Unknown;
+  size_t offset = 0;  // Byte offset inside a binary vertex record
+};
+
+struct PlyHeader
+{
+  bool binary = false;
+  size_t vertex_count = 0;
+  size_t vertex_stride = 0;
+  std::vector<PlyProperty> properties;
+  uint32_t organized_width = 0;
+  uint32_t organized_height = 0;
+
+  int Find(const std::string &name) const {
+    for (size_t i = 0; i < properties.size(); ++i) {
+      if (properties[i].name == name) return static_cast<int>(i);
+    }
+    return -1;
+  }
+};
+
+bool ReadPlyHeader(std::istream &in, PlyHeader &header, const std::string &path) {
+  std::string line;
+  if (!std::getline(in, line) || line.compare(0, 3, "ply") != 0) {
+    LOG_ERROR_STREAM << "Not a PLY file: " << path;
+    return false;
+  }
+
+  bool inVertex = false;
+  bool seenVertex = false;
+  while (std::getline(in, line)) {
+    if (!line.empty() && line.back() == '\r') line.pop_back();
+    std::istringstream tokens(line);
+    std::string keyword;
+    tokens >> keyword;
+
+    if (keyword == "format") {
+      std::string format;
+      tokens >> format;
+      if (format == "ascii") {
+        header.binary = false;
+      } else if (format == "binary_little_endian") {
+        header.binary = true;
+      } else {
+        LOG_ERROR_STREAM << "Unsupported PLY format '" << format << "': " << path;
+        return false;
+      }
+    } else if (keyword == "comment") {
+      std::string tag;
+      tokens >> tag;
+      if (tag == "organized") {
+        tokens >> header.organized_width >> header.organized_height;
+      }
+    } else if (keyword == "element") {
+      std::string name;
+      size_t count = 0;
+      tokens >> name >> count;
+      // Only the vertex element is read; it has to precede any other element in binary files
+      inVertex = name == "vertex";
+      if (inVertex) {
+        header.vertex_count = count;
+        seenVertex = true;
+      } else if (!seenVertex && header.binary) {
+        LOG_ERROR_STREAM << "PLY element '" << name << "' precedes vertices: " << path;
+        return false;
+      }
+    } else if (keyword == "property" && inVertex) {
+      std::string type;
+      std::string name;
+      tokens >> type >> name;
+      PlyProperty property;
+      property.name = name;
+      property.type = ParsePlyType(type);
+      property.offset = header.vertex_stride;
+      if (property.type == PlyType::Unknown) {
+        LOG_ERROR_STREAM << "Unsupported PLY vertex property '" << line << "': " << path;
+        return false;
+      }
+      header.vertex_stride += PlyTypeSize(property.type);
+      header.properties.push_back(property);
+    } else if (keyword == "end_header") {
+      return seenVertex;
+    }
+  }
+
+  LOG_ERROR_STREAM << "PLY header is not terminated: " << path;
+  return false;
+}
+}  // namespace
+
+bool PlyConverter::ContainerToPly(const std::string &containerPath, const std::string &plyPath,
+                                  const Options &options) {
+  MappedFrameContainer container;
+  return container.Open(containerPath) && ContainerToPly(container, plyPath, options);
+}
+
+bool PlyConverter::ContainerToPly(const MappedFrameContainer &container, const std::string &plyPath,
+                                  const Options &options) {
+  uint32_t width = 0;
+  uint32_t height = 0;
+  const mmind::eye::PointXYZ *points = container.Points(width, height);
+  if (points == nullptr) {
+    LOG_ERROR_STREAM << "Frame container has no point cloud, cannot write " << plyPath;
+    return false;
+  }
+
+  uint32_t colorWidth = 0;
+  uint32_t colorHeight = 0;
+  const uint8_t *colors = container.PointColors(colorWidth, colorHeight);
+  if (colors != nullptr && (colorWidth != width || colorHeight != height)) colors = nullptr;
+  uint32_t normalWidth = 0;
+  uint32_t normalHeight = 0;
+  const mmind::eye::NormalVector *normals = container.Normals(normalWidth, normalHeight);
+  if (normals != nullptr && (normalWidth != width || normalHeight != height)) normals = nullptr;
+
+  const size_t total = size_t(width) * height;
+  auto isValid = [points](size_t i) { return !std::isnan(points[i].z); };
+  size_t count = total;
+  if (options.skip_invalid) {
+    count = 0;
+    for (size_t i = 0; i < total; ++i) {
+      count += isValid(i) ? 1 : 0;
+    }
+  }
+
+  FILE *file = std::fopen(plyPath.c_str(), "wb");
+  if (file == nullptr) {
+    LOG_ERROR_STREAM << "Failed to create " << plyPath;
+    return false;
+  }
+
+  std::ostringstream header;
+  header << "ply\n"
+         << "format " << (options.binary ? "binary_little_endian" : "ascii") << " 1.0\n"
+         << "comment frame " << container.Suffix() << "\n";
+  if (!container.CameraId().empty()) header << "comment camera " << container.CameraId() << "\n";
+  if (!options.skip_invalid) header << "comment organized " << width << " " << height << "\n";
+  header << "element vertex " << count << "\n"
+         << "property float x\nproperty float y\nproperty float z\n";
+  if (normals) header << "property float nx\nproperty float ny\nproperty float nz\nproperty float curvature\n";
+  if (colors) header << "property uchar red\nproperty uchar green\nproperty uchar blue\n";
+  header << "end_header\n";
+  const std::string headerText = header.str();
+  bool ok = std::fwrite(headerText.data(), 1, headerText.size(), file) == headerText.size();
+
+  const size_t stride = sizeof(mmind::eye::PointXYZ) + (normals ? sizeof(mmind::eye::NormalVector) : 0) +
+                        (colors ? 3 : 0);
+  std::vector<uint8_t> chunk;
+  chunk.reserve(kChunkVertices * stride);
+  auto flush = [&]() {
+    ok = ok && std::fwrite(chunk.data(), 1, chunk.size(), file) == chunk.size();
+    chunk.clear();
+  };
+
+  for (size_t i = 0; ok && i < total; ++i) {
+    if (options.skip_invalid && !isValid(i)) continue;
+    if (options.binary) {
+      const uint8_t *xyz = reinterpret_cast<const uint8_t *>(&points[i]);
+      chunk.insert(chunk.end(), xyz, xyz + sizeof(mmind::eye::PointXYZ));
+      if (normals) {
+        const uint8_t *normal = reinterpret_cast<const uint8_t *>(&normals[i]);
+        chunk.insert(chunk.end(), normal, normal + sizeof(mmind::eye::NormalVector));
+      }
+      if (colors) {
+        // Stored as BGR, PLY convention is red / green / blue
+        chunk.push_back(colors[i * 3 + 2]);
+        chunk.push_back(colors[i * 3 + 1]);
+        chunk.push_back(colors[i * 3 + 0]);
+      }
+      if (chunk.size() >= kChunkVertices * stride) flush();
+    } else {
+      std::fprintf(file, "%g %g %g", points[i].x, points[i].y, points[i].z);
+      if (normals) {
+        std::fprintf(file, " %g %g %g %g", normals[i].x, normals[i].y, normals[i].z, normals[i].curvature);
+      }
+      if (colors) std::fprintf(file, " %u %u %u", colors[i * 3 + 2], colors[i * 3 + 1], colors[i * 3 + 0]);
+      std::fputc('\n', file);
+    }
+  }
+  if (!chunk.empty()) flush();
+  ok = (std::fclose(file) == 0) && ok;
+
+  if (!ok) {
+    LOG_ERROR_STREAM << "Failed to write " << plyPath;
+    std::remove(plyPath.c_str());
+  }
+  return ok;
+}
+
+bool PlyConverter::ReadPly(const std::string &plyPath, Vertices &vertices) {
+  std::ifstream in(plyPath, std::ios::binary);
+  if (!in) {
+    LOG_ERROR_STREAM << "Failed to open " << plyPath;
+    return false;
+  }
+
+  PlyHeader header;
+  if (!ReadPlyHeader(in, header, plyPath)) return false;
+
+  const int x = header.Find("x");
+  const int y = header.Find("y");
+  const int z = header.Find("z");
+  if (x < 0 || y < 0 || z < 0) {
+    LOG_ERROR_STREAM << "PLY vertices have no x / y / z: " << plyPath;
+    return false;
+  }
+  const int nx = header.Find("nx");
+  const int ny = header.Find("ny");
+  const int nz = header.Find("nz");
+  const int curvature = header.Find("curvature");
+  const bool hasNormals = nx >= 0 && ny >= 0 && nz >= 0;
+  const int red = header.Find("red") >= 0 ? header.Find("red") : header.Find("r");
+  const int green = header.Find("green") >= 0 ? header.Find("green") : header.Find("g");
+  const int blue = header.Find("blue") >= 0 ? header.Find("blue") : header.Find("b");
+  const bool hasColors = red >= 0 && green >= 0 && blue >= 0;
+
+  const size_t count = header.vertex_count;
+  vertices.width = static_cast<uint32_t>(count);
+  vertices.height = 1;
+  if (header.organized_width > 0 && size_t(header.organized_width) * header.organized_height == count) {
+    vertices.width = header.organized_width;
+    vertices.height = header.organized_height;
+  }
+
+  // The vertex count comes from the header, so buffers are only sized for vertices the file can actually hold
+  mmind::eye::PointXYZ *points = nullptr;
+  mmind::eye::NormalVector *normalOut = nullptr;
+  uint8_t *colors = nullptr;
+  auto allocate = [&](size_t vertexCount) {
+    vertices.xyz.resize(vertexCount * sizeof(mmind::eye::PointXYZ));
+    vertices.normals.resize(hasNormals ? vertexCount * sizeof(mmind::eye::NormalVector) : 0);
+    vertices.colors.resize(hasColors ? vertexCount * 3 : 0);
+    points = reinterpret_cast<mmind::eye::PointXYZ *>(vertices.xyz.data());
+    normalOut = reinterpret_cast<mmind::eye::NormalVector *>(vertices.normals.data());
+    colors = vertices.colors.data();
+  };
+  allocate(0);
+
+  std::vector<double> values(header.properties.size());
+  auto store = [&](size_t i) {
+    points[i].x = static_cast<float>(values[x]);
+    points[i].y = static_cast<float>(values[y]);
+    points[i].z = static_cast<float>(values[z]);
+    if (hasNormals) {
+      normalOut[i].x = static_cast<float>(values[nx]);
+      normalOut[i].y = static_cast<float>(values[ny]);
+      normalOut[i].z = static_cast<float>(values[nz]);
+      normalOut[i].curvature = curvature >= 0 ? static_cast<float>(values[curvature]) : 0.0f;
+    }
+    if (hasColors) {
+      colors[i * 3 + 0] = static_cast<uint8_t>(values[blue]);
+      colors[i * 3 + 1] = static_cast<uint8_t>(values[green]);
+      colors[i * 3 + 2] = static_cast<uint8_t>(values[red]);
+    }
+  };
+
+  if (header.binary) {
+    const std::streampos dataBegin = in.tellg();
+    in.seekg(0, std::ios::end);
+    const std::streamoff available = in.tellg() - dataBegin;
+    in.seekg(dataBegin);
+    if (header.vertex_stride == 0 || available < 0 || count > size_t(available) / header.vertex_stride) {
+      LOG_ERROR_STREAM << "PLY vertex data is truncated: " << plyPath;
+      return false;
+    }
+
+    // One bulk read of every vertex record, then decode from memory
+    allocate(count);
+    std::vector<uint8_t> records(count * header.vertex_stride);
+    if (!in.read(reinterpret_cast<char *>(records.data()), static_cast<std::streamsize>(records.size()))) {
+      LOG_ERROR_STREAM << "PLY vertex data is truncated: " << plyPath;
+      return false;
+    }
+    for (size_t i = 0; i < count; ++i) {
+      const uint8_t *record = records.data() + i * header.vertex_stride;
+      for (size_t p = 0; p < header.properties.size(); ++p) {
+        values[p] = ReadBinary(header.properties[p].type, record + header.properties[p].offset);
+      }
+      store(i);
+    }
+  } else {
+    // Tokens go through strtod, which unlike operator>> accepts the nan / inf that %g writes for invalid points
+    // The text length is unknown up front, so the buffers grow with the vertices actually parsed
+    std::string token;
+    size_t allocated = 0;
+    for (size_t i = 0; i < count; ++i) {
+      if (i == allocated) {
+        allocated = std::min(count, std::max(kChunkVertices, allocated * 2));
+        allocate(allocated);
+      }
+      for (size_t p = 0; p < header.properties.size(); ++p) {
+        char *end = nullptr;
+        if (in >> token) values[p] = std::strtod(token.c_str(), &end);
+        if (end == nullptr || end == token.c_str() || *end != '\0') {
+          LOG_ERROR_STREAM << "PLY vertex data is truncated or malformed: " << plyPath;
+          return false;
+        }
+      }
+      store(i);
+    }
+  }
+  return true;
+}
+
+bool PlyConverter::ReadPointClouds(const std::string &plyPath, mmind::eye::PointCloud *pointCloud,
+                                   mmind::eye::TexturedPointCloud *texturedPointCloud) {
+  Vertices vertices;
+  if (!ReadPly(plyPath, vertices)) return false;
+
+  const size_t count = size_t(vertices.width) * vertices.height;
+  const auto *points = reinterpret_cast<const mmind::eye::PointXYZ *>(vertices.xyz.data());
+  if (pointCloud) {
+    pointCloud->resize(vertices.width, vertices.height);
+    if (count > 0) std::memcpy(pointCloud->data(), points, count * sizeof(mmind::eye::PointXYZ));
+  }
+  if (texturedPointCloud) {
+    if (vertices.colors.empty()) {
+      texturedPointCloud->release();
+    } else {
+      texturedPointCloud->resize(vertices.width, vertices.height);
+      mmind::eye::PointXYZBGR *out = texturedPointCloud->data();
+      const uint8_t *colors = vertices.colors.data();
+      for (size_t i = 0; i < count; ++i) {
+        // PointXYZBGR has no assignment operator, so fields are set one by one
+        out[i].x = points[i].x;
+        out[i].y = points[i].y;
+        out[i].z = points[i].z;
+        out[i].b = colors[i * 3 + 0];
+        out[i].g = colors[i * 3 + 1];
+        out[i].r = colors[i * 3 + 2];
+        out[i].a = 255;
+      }
+    }
+  }
+  return true;
+}
+
+bool PlyConverter::PlyToContainer(const std::string &plyPath, const std::string &containerPath) {
+  Vertices vertices;
+  if (!ReadPly(plyPath, vertices)) return false;
+
+  const uint32_t width = vertices.width;
+  const uint32_t height = vertices.height;
+  const bool hasNormals = !vertices.normals.empty();
+  const bool hasColors = !vertices.colors.empty();
+  FrameContainerWriter writer;
+  writer.AddOwnedSection(FrameContainerSectionType::PointXYZ, sizeof(mmind::eye::PointXYZ), width, height,
+                         std::move(vertices.xyz));
+  if (hasNormals) {
+    writer.AddOwnedSection(FrameContainerSectionType::Normal, sizeof(mmind::eye::NormalVector), width, height,
+                           std::move(vertices.normals));
+  }
+  if (hasColors) {
+    writer.AddOwnedSection(FrameContainerSectionType::PointBGR, 3, width, height, std::move(vertices.colors));
+  }
+  return writer.Write(containerPath);
+}
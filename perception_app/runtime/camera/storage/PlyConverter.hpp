@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "FrameContainer.hpp"
+
+/**
+ * @brief 帧容器与 PLY 点云互相转换
+ *
+ * 便于已有的 PLY 工具（CloudCompare、MeshLab、PCL 等）继续读取帧容器中的点云，
+ * 或将已有的 PLY 文件转换为帧容器。写出的 PLY 包含 x / y / z，以及容器中存在的
+ * 法线（nx / ny / nz / curvature）和颜色（red / green / blue）。保留无效点时写出
+ * "comment organized <宽> <高>"，读回时据此恢复有序点云的尺寸。
+ *
+ * 读取同样适用于 SDK 保存的 PLY（CameraManager::SaveImages 写出的 *_PointCloud.ply /
+ * *_TexturedPointCloud.ply），供回放使用。
+ */
+class PlyConverter
+{
+public:
+    struct Options
+    {
+        bool binary = true;        // binary_little_endian，否则为 ascii
+        bool skip_invalid = true;  // 跳过坐标为 NaN 的点（输出无序点云）
+    };
+
+    /**
+     * @brief PLY 中读出的顶点，按帧容器节的布局存放
+     */
+    struct Vertices
+    {
+        uint32_t width = 0;  // 有 "comment organized" 时为有序尺寸，否则为 顶点数 x 1
+        uint32_t height = 0;
+        std::vector<uint8_t> xyz;      // mmind::eye::PointXYZ
+        std::vector<uint8_t> normals;  // mmind::eye::NormalVector，PLY 中没有法线时为空
+        std::vector<uint8_t> colors;   // BGR，PLY 中没有颜色时为空
+    };
+
+    /**
+     * @brief 读取 PLY（ascii 或 binary_little_endian）的顶点
+     * @return 文件无法打开、格式不支持、没有 x / y / z 或数据不完整（含头部顶点数超出文件长度）时返回 false，不抛异常
+     */
+    static bool ReadPly(const std::string& plyPath, Vertices& vertices);
+
+    /**
+     * @brief 读取 PLY 为 SDK 点云
+     * @param texturedPointCloud 为 nullptr 时不读取颜色；PLY 中没有颜色时置空
+     */
+    static bool ReadPointClouds(const std::string& plyPath, mmind::eye::PointCloud* pointCloud,
+                                mmind::eye::TexturedPointCloud* texturedPointCloud);
+
+    /**
+     * @brief 将帧容器中的点云写为 PLY
+     * @return 容器中没有点云或写入失败时返回 false
+     */
+    static bool ContainerToPly(const MappedFrameContainer& container, const std::string& plyPath,
+                               const Options& options);
+
+    static bool ContainerToPly(const std::string& containerPath, const std::string& plyPath, const Options& options);
+
+    /**
+     * @brief 读取 PLY（ascii 或 binary_little_endian）的顶点并写为帧容器
+     *
+     * 只转换点云、法线和颜色；PLY 不含相机参数，容器中的内参为 0、坐标变换为单位变换。
+     */
+    static bool PlyToContainer(const std::string& plyPath, const std::string& containerPath);
+};
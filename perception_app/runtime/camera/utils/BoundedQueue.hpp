@@ -0,0 +1,175 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+
+/**
+ * @brief 队列满时的处理策略
+ */
+enum class OverflowPolicy {
+    Block,       // 阻塞生产者，直到队列出现空位
+    DropOldest,  // 丢弃队首最旧的元素，新元素入队
+    DropNewest   // 丢弃当前待入队的新元素
+};
+
+/**
+ * @brief 解析配置中的队列策略字符串（"block" / "drop_oldest" / "drop_newest"）
+ * @param fallback 无法识别时使用的策略
+ */
+inline OverflowPolicy ParseOverflowPolicy(const std::string& name,
+                                          OverflowPolicy fallback = OverflowPolicy::DropOldest) {
+    if (name == "block") return OverflowPolicy::Block;
+    if (name == "drop_oldest") return OverflowPolicy::DropOldest;
+    if (name == "drop_newest") return OverflowPolicy::DropNewest;
+    return fallback;
+}
+
+inline const char* OverflowPolicyToString(OverflowPolicy policy) {
+    switch (policy) {
+        case OverflowPolicy::Block:
+            return "block";
+        case OverflowPolicy::DropOldest:
+            return "drop_oldest";
+        case OverflowPolicy::DropNewest:
+            return "drop_newest";
+    }
+    return "unknown";
+}
+
+/**
+ * @brief 线程安全的有界队列，用于流水线各阶段之间传递数据
+ *
+ * 队列关闭后 Push 立即失败，Pop 会先取完剩余元素再返回 false，
+ * 保证下游阶段可以在停止时排空已入队的帧。
+ */
+template <typename T>
+class BoundedQueue {
+public:
+    explicit BoundedQueue(size_t capacity, OverflowPolicy policy = OverflowPolicy::DropOldest)
+        : capacity_(capacity == 0 ? 1 : capacity), policy_(policy) {}
+
+    BoundedQueue(const BoundedQueue&) = delete;
+    BoundedQueue& operator=(const BoundedQueue&) = delete;
+
+    /**
+     * @brief 入队
+     * @param item 待入队元素
+     * @return true 元素已入队，false 元素被丢弃或队列已关闭
+     */
+    bool Push(T item) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (policy_ == OverflowPolicy::Block) {
+            not_full_.wait(lock, [this] { return closed_ || queue_.size() < capacity_; });
+        }
+        if (closed_) {
+            return false;
+        }
+
+        if (queue_.size() >= capacity_) {
+            dropped_++;
+            if (policy_ == OverflowPolicy::DropNewest) {
+                return false;
+            }
+            queue_.pop_front();
+        }
+
+        queue_.push_back(std::move(item));
+        high_water_mark_ = queue_.size() > high_water_mark_ ? queue_.size() : high_water_mark_;
+        not_empty_.notify_one();
+        return true;
+    }
+
+    /**
+     * @brief 阻塞出队
+     * @param item 出队元素
+     * @return true 取到元素，false 队列已关闭且为空
+     */
+    bool Pop(T& item) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        not_empty_.wait(lock, [this] { return closed_ || !queue_.empty(); });
+        if (queue_.empty()) {
+            return false;
+        }
+
+        item = std::move(queue_.front());
+        queue_.pop_front();
+        not_full_.notify_one();
+        return true;
+    }
+
+    /**
+     * @brief 非阻塞出队
+     * @param item 出队元素
+     * @return true 取到元素，false 队列为空
+     */
+    bool TryPop(T& item) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (queue_.empty()) {
+            return false;
+        }
+
+        item = std::move(queue_.front());
+        queue_.pop_front();
+        not_full_.notify_one();
+        return true;
+    }
+
+    /**
+     * @brief 关闭队列并唤醒所有等待者
+     */
+    void Close() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            closed_ = true;
+        }
+        not_empty_.notify_all();
+        not_full_.notify_all();
+    }
+
+    /**
+     * @brief 重新打开已关闭的队列，供停止后再次启动的生产者/消费者复用；统计数据保留
+     */
+    void Reopen() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        closed_ = false;
+    }
+
+    bool IsClosed() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return closed_;
+    }
+
+    size_t Size() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return queue_.size();
+    }
+
+    size_t Capacity() const { return capacity_; }
+
+    OverflowPolicy Policy() const { return policy_; }
+
+    uint64_t Dropped() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return dropped_;
+    }
+
+    size_t HighWaterMark() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return high_water_mark_;
+    }
+
+private:
+    const size_t capacity_;
+    const OverflowPolicy policy_;
+    std::deque<T> queue_;
+    mutable std::mutex mutex_;
+    std::condition_variable not_empty_;
+    std::condition_variable not_full_;
+    bool closed_ = false;
+    uint64_t dropped_ = 0;
+    size_t high_water_mark_ = 0;
+};
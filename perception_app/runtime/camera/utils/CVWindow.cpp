@@ -1,5 +1,4 @@
 #include "CVWindow.hpp"
-#include "area_scan_3d_camera/api_util.h"  // Add Mech-Eye SDK header
 
 #if defined(__has_include)
 #if __has_include(<opencv2/core/Logger.hpp>)
@@ -10,94 +9,135 @@
 
 const std::string defaultKeyMapPrompt = "'Esc': Exit Window, '?': Show Key Map";
 
-CVWindow::CVWindow(std::string name, uint32_t width, uint32_t height)
-    : name_(name), width_(width), height_(height), closed_(false) {
+namespace {
+// Both images are scaled to this height before being placed side by side
+constexpr int kDisplayHeight = 480;
+
+// Upper bound on how long window events go unpumped while no frame is due
+constexpr auto kEventInterval = std::chrono::milliseconds(10);
+
+int ScaledWidth(const cv::Size &size) { return size.width * kDisplayHeight / size.height; }
+
+// Scales into a view of the canvas; resize writes in place because the view already has the target size
+void Place(const cv::Mat &image, cv::Mat view) {
+  if (image.size() == view.size()) {
+    image.copyTo(view);
+  } else {
+    cv::resize(image, view, view.size());
+  }
+}
+}  // namespace
+
+CVWindow::CVWindow(std::string name, uint32_t width, uint32_t height, double maxFps)
+    : name_(name), width_(width), height_(height) {
 #if defined(TO_DISABLE_OPENCV_LOG)
   cv::utils::logging::setLogLevel(cv::utils::logging::LogLevel::LOG_LEVEL_SILENT);
 #endif
 
-  cv::namedWindow(name_, cv::WINDOW_NORMAL);
-  cv::resizeWindow(name_, width_, height_);
-}
-
-CVWindow::~CVWindow() noexcept {
-  close();
-  cv::destroyWindow(name_);
+  minInterval_ = maxFps > 0 ? std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                                  std::chrono::duration<double>(1.0 / maxFps))
+                            : std::chrono::steady_clock::duration::zero();
+  // HighGUI backends expect the window to be created, drawn and pumped from the same thread
+  thread_ = std::thread(&CVWindow::renderLoop, this);
 }
 
-void CVWindow::showFrame2DAnd3D(const mmind::eye::Frame2DAnd3D &frame) {
-  // Get 2D image
-  mmind::eye::Color2DImage colorImage = frame.frame2D().getColorImage();
-  cv::Mat colorMat = color2DImageToMat(colorImage);
-
-  // Get depth map
-  mmind::eye::DepthMap depthMap = frame.frame3D().getDepthMap();
-  cv::Mat depthColorMat = depthMapToColorMat(depthMap);
-
-  // Create combined image
-  cv::Mat combined;
-  if (!colorMat.empty() && !depthColorMat.empty()) {
-    // Resize to maintain aspect ratio
-    int targetHeight = 480;
-    cv::Mat resizedColor, resizedDepth;
-    cv::resize(colorMat, resizedColor, cv::Size(colorMat.cols * targetHeight / colorMat.rows, targetHeight));
-    cv::resize(depthColorMat, resizedDepth,
-               cv::Size(depthColorMat.cols * targetHeight / depthColorMat.rows, targetHeight));
-
-    // Horizontal concatenation
-    cv::hconcat(resizedColor, resizedDepth, combined);
-  } else if (!colorMat.empty()) {
-    combined = colorMat;
-  } else if (!depthColorMat.empty()) {
-    combined = depthColorMat;
-  } else {
-    return;
-  }
+CVWindow::~CVWindow() noexcept { close(); }
 
-  // Display image
+void CVWindow::submitFrame(FrameSnapshot frame) {
+  if (!frame || closed_) return;
   {
-    std::lock_guard<std::mutex> lock(renderMutex_);
-    renderMat_ = combined;
-    cv::imshow(name_, combined);
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats_.submitted++;
+    if (pending_) {
+      stats_.dropped++;
+    }
+    pending_ = std::move(frame);
   }
+  cv_.notify_one();
 }
 
-bool CVWindow::processEvents() {
-  int key = cv::waitKey(1);
-  if (key == 27) {  // ESC key
-    closed_ = true;
+bool CVWindow::processEvents() { return !closed_; }
+
+void CVWindow::close() {
+  closed_ = true;
+  cv_.notify_one();
+  if (thread_.joinable() && thread_.get_id() != std::this_thread::get_id()) {
+    thread_.join();
   }
-  return !closed_;
 }
 
-void CVWindow::close() { closed_ = true; }
+CVWindow::Stats CVWindow::getStats() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return stats_;
+}
+
+void CVWindow::renderLoop() {
+  cv::namedWindow(name_, cv::WINDOW_NORMAL);
+  cv::resizeWindow(name_, width_, height_);
 
-cv::Mat CVWindow::color2DImageToMat(const mmind::eye::Color2DImage &colorImage) {
-  if (colorImage.data() == nullptr) return cv::Mat();
+  auto nextRender = std::chrono::steady_clock::now();
+  while (!closed_) {
+    FrameSnapshot frame;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      // Wake for a new frame only once the frame rate allows rendering it; events are pumped in between
+      const auto now = std::chrono::steady_clock::now();
+      const auto wait = pending_ && nextRender > now ? std::min<std::chrono::steady_clock::duration>(
+                                                           nextRender - now, kEventInterval)
+                                                     : std::chrono::steady_clock::duration(kEventInterval);
+      cv_.wait_for(lock, wait, [this, &nextRender] {
+        return closed_ || (pending_ && std::chrono::steady_clock::now() >= nextRender);
+      });
+      if (pending_ && std::chrono::steady_clock::now() >= nextRender) {
+        frame = std::move(pending_);
+        pending_.reset();
+      }
+    }
+
+    if (frame) {
+      const auto start = std::chrono::steady_clock::now();
+      ScopedLatency timer(latency_);
+      // RenderDepth is a memoized product: colorized here, off the capture path, and only for shown frames
+      const cv::Mat image = compose(frame->GetColor(), frame->GetRenderDepth());
+      if (!image.empty()) {
+        cv::imshow(name_, image);
+      }
+      // Release before pumping events so the pool can recycle the frame while the window idles
+      frame.reset();
+
+      // Paced from the later of the due time and the actual start, so an idle spell cannot cause a burst
+      nextRender = std::max(nextRender, start) + minInterval_;
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stats_.rendered++;
+      }
+    }
+
+    if (cv::waitKey(1) == 27) {  // ESC key
+      closed_ = true;
+    }
+  }
 
-  // Assume data is in RGB format
-  cv::Mat rgbMat(colorImage.height(), colorImage.width(), CV_8UC3, (void *)colorImage.data());
-  cv::Mat bgrMat;
-  cv::cvtColor(rgbMat, bgrMat, cv::COLOR_RGB2BGR);
-  return bgrMat;
+  cv::destroyWindow(name_);
+  std::lock_guard<std::mutex> lock(mutex_);
+  pending_.reset();
 }
 
-cv::Mat CVWindow::depthMapToColorMat(const mmind::eye::DepthMap &depthMap) {
-  if (depthMap.data() == nullptr) return cv::Mat();
-
-  cv::Mat depthMat(depthMap.height(), depthMap.width(), CV_32FC1, (void *)depthMap.data());
-  cv::Mat normalized, colorMap;
+cv::Mat CVWindow::compose(const cv::Mat &colorMat, const cv::Mat &depthColorMat) {
+  if (colorMat.empty() || depthColorMat.empty()) {
+    // A single image is shown as is
+    return colorMat.empty() ? depthColorMat : colorMat;
+  }
 
-  // Normalize depth values
-  double minVal, maxVal;
-  cv::minMaxLoc(depthMat, &minVal, &maxVal);
-  if (maxVal > minVal) {
-    depthMat.convertTo(normalized, CV_8UC1, 255.0 / (maxVal - minVal), -minVal * 255.0 / (maxVal - minVal));
-  } else {
-    normalized = cv::Mat::zeros(depthMat.size(), CV_8UC1);
+  // The layout only changes with the input resolutions; the canvas is reused otherwise
+  if (colorMat.size() != colorSize_ || depthColorMat.size() != depthSize_) {
+    colorSize_ = colorMat.size();
+    depthSize_ = depthColorMat.size();
+    canvas_.create(kDisplayHeight, ScaledWidth(colorSize_) + ScaledWidth(depthSize_), CV_8UC3);
   }
 
-  // Apply pseudo-color
-  cv::applyColorMap(normalized, colorMap, cv::COLORMAP_JET);
-  return colorMap;
+  const int colorWidth = ScaledWidth(colorSize_);
+  Place(colorMat, canvas_(cv::Rect(0, 0, colorWidth, kDisplayHeight)));
+  Place(depthColorMat, canvas_(cv::Rect(colorWidth, 0, canvas_.cols - colorWidth, kDisplayHeight)));
+  return canvas_;
 }
@@ -1,35 +1,76 @@
 #pragma once
 #include <opencv2/opencv.hpp>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
 #include <string>
 #include <mutex>
-#include "area_scan_3d_camera/Camera.h" // 添加Mech-Eye SDK头文件
+#include <thread>
+#include "FrameSet.hpp"
+#include "utils/LatencyHistogram.hpp"
 
+/**
+ * @brief 实时显示窗口
+ *
+ * 窗口的创建、渲染、imshow 和 waitKey 都在独立的 UI 线程中进行，采集 / 流水线线程只把帧放入
+ * “最新帧”槽位后立即返回：UI 线程忙时新帧覆盖槽位中尚未显示的帧，显示永远不会拖慢采集。
+ * 渲染频率受 maxFps 限制，伪彩色深度直接取自 FrameSet 的 RenderDepth 产品（只为真正显示的帧计算），
+ * 缩放和拼接写入复用的显示缓冲，输入尺寸不变时不重新分配内存。
+ */
 class CVWindow {
 public:
-    // 创建窗口
-    CVWindow(std::string name, uint32_t width = 1280, uint32_t height = 720);
+    struct Stats {
+        uint64_t submitted = 0;  // 提交的帧数
+        uint64_t rendered = 0;   // 实际显示的帧数
+        uint64_t dropped = 0;    // 未显示就被新帧覆盖的帧数
+    };
+
+    // 创建窗口并启动 UI 线程，maxFps <= 0 表示不限制
+    CVWindow(std::string name, uint32_t width = 1280, uint32_t height = 720, double maxFps = 30.0);
     ~CVWindow();
-    
-    // 显示Frame2DAnd3D中的图像
-    void showFrame2DAnd3D(const mmind::eye::Frame2DAnd3D& frame);
-    
-    // 处理窗口事件
+
+    CVWindow(const CVWindow&) = delete;
+    CVWindow& operator=(const CVWindow&) = delete;
+
+    // 提交一帧待显示（彩色图 + 伪彩色深度图），立即返回；持有帧直到显示完成或被新帧替换
+    void submitFrame(FrameSnapshot frame);
+
+    // 窗口是否仍然打开（按下 ESC 或调用 close 后为 false），不阻塞
     bool processEvents();
-    
-    // 关闭窗口
+
+    // 关闭窗口并停止 UI 线程
     void close();
 
+    // 记录每次渲染（含 imshow）的耗时，应在提交第一帧之前设置
+    void setLatencyHistogram(LatencyHistogram* histogram) { latency_ = histogram; }
+
+    Stats getStats() const;
+
+    // 显示时保持的帧数（槽位 + 正在渲染），帧缓冲池需要为其预留容量
+    static constexpr size_t kHeldFrames = 2;
+
 private:
-    // 转换Color2DImage为cv::Mat
-    cv::Mat color2DImageToMat(const mmind::eye::Color2DImage& colorImage);
-    
-    // 转换DepthMap为伪彩色cv::Mat
-    cv::Mat depthMapToColorMat(const mmind::eye::DepthMap& depthMap);
-    
+    void renderLoop();
+
+    // 将彩色图和伪彩色深度图缩放到同一高度后左右拼接到 canvas_，任一为空时直接返回另一幅
+    cv::Mat compose(const cv::Mat& color, const cv::Mat& renderedDepth);
+
     std::string name_;
     uint32_t width_;
     uint32_t height_;
-    bool closed_;
-    cv::Mat renderMat_;
-    std::mutex renderMutex_;
+    std::chrono::steady_clock::duration minInterval_;
+    LatencyHistogram* latency_ = nullptr;
+
+    std::atomic<bool> closed_ {false};
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    FrameSnapshot pending_;  // 最新帧槽位
+    Stats stats_;
+    std::thread thread_;
+
+    // 以下只由 UI 线程访问
+    cv::Mat canvas_;
+    cv::Size colorSize_;
+    cv::Size depthSize_;
 };
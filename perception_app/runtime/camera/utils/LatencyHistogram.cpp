@@ -0,0 +1,111 @@
+#include "LatencyHistogram.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+int HighestBit(uint64_t value) {
+  int bit = 0;
+  while (value >>= 1) {
+    ++bit;
+  }
+  return bit;
+}
+}  // namespace
+
+size_t LatencyHistogram::BucketIndex(uint64_t ns) {
+  // Values below kSubBuckets get one bucket each; above that every power of two is split
+  // into kSubBuckets linear sub-buckets addressed by the bits right below the leading one.
+  if (ns < kSubBuckets) {
+    return static_cast<size_t>(ns);
+  }
+  const int msb = HighestBit(ns);
+  if (msb >= static_cast<int>(kMaxValueBits)) {
+    return kBucketCount - 1;
+  }
+  const int shift = msb - static_cast<int>(kSubBucketBits);
+  const size_t sub = static_cast<size_t>(ns >> shift) & (kSubBuckets - 1);
+  return static_cast<size_t>(msb - static_cast<int>(kSubBucketBits) + 1) * kSubBuckets + sub;
+}
+
+uint64_t LatencyHistogram::BucketUpperBound(size_t index) {
+  const size_t segment = index / kSubBuckets;
+  const uint64_t sub = index % kSubBuckets;
+  if (segment == 0) {
+    return sub;
+  }
+  const size_t shift = segment - 1;
+  const uint64_t lower = (kSubBuckets + sub) << shift;
+  return lower + (uint64_t(1) << shift) - 1;
+}
+
+void LatencyHistogram::Record(uint64_t ns) {
+  buckets_[BucketIndex(ns)].fetch_add(1, std::memory_order_relaxed);
+  sum_ns_.fetch_add(ns, std::memory_order_relaxed);
+  uint64_t max = max_ns_.load(std::memory_order_relaxed);
+  while (ns > max && !max_ns_.compare_exchange_weak(max, ns, std::memory_order_relaxed)) {
+  }
+}
+
+void LatencyHistogram::Record(std::chrono::steady_clock::duration duration) {
+  const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+  Record(static_cast<uint64_t>(std::max<int64_t>(ns, 0)));
+}
+
+LatencyHistogram::Snapshot LatencyHistogram::GetSnapshot() const {
+  // Counters are read without stopping writers; the count is taken from the copied buckets so
+  // percentiles stay consistent with the distribution that was actually read.
+  Snapshot snapshot;
+  for (size_t i = 0; i < kBucketCount; ++i) {
+    snapshot.buckets[i] = buckets_[i].load(std::memory_order_relaxed);
+    snapshot.count += snapshot.buckets[i];
+  }
+  snapshot.sum_ns = sum_ns_.load(std::memory_order_relaxed);
+  snapshot.max_ns = max_ns_.load(std::memory_order_relaxed);
+  return snapshot;
+}
+
+LatencyHistogram::Snapshot LatencyHistogram::Snapshot::Since(const Snapshot &earlier) const {
+  Snapshot delta;
+  delta.count = count - std::min(count, earlier.count);
+  delta.sum_ns = sum_ns - std::min(sum_ns, earlier.sum_ns);
+  for (size_t i = 0; i < kBucketCount; ++i) {
+    delta.buckets[i] = buckets[i] - std::min(buckets[i], earlier.buckets[i]);
+    if (delta.buckets[i] > 0) {
+      delta.max_ns = std::min(BucketUpperBound(i), max_ns);
+    }
+  }
+  return delta;
+}
+
+uint64_t LatencyHistogram::Snapshot::PercentileNs(double percentile) const {
+  if (count == 0) {
+    return 0;
+  }
+
+  const double clamped = std::min(std::max(percentile, 0.0), 100.0);
+  const uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(clamped / 100.0 * count)));
+  uint64_t seen = 0;
+  for (size_t i = 0; i < kBucketCount; ++i) {
+    seen += buckets[i];
+    if (seen >= rank) {
+      return std::min(BucketUpperBound(i), max_ns);
+    }
+  }
+  return max_ns;
+}
+
+LatencyHistogram::Summary LatencyHistogram::Snapshot::Summarize(double seconds) const {
+  constexpr double kNsPerMs = 1e6;
+  Summary summary;
+  summary.count = count;
+  if (count == 0) {
+    return summary;
+  }
+  summary.mean_ms = static_cast<double>(sum_ns) / count / kNsPerMs;
+  summary.p50_ms = PercentileNs(50.0) / kNsPerMs;
+  summary.p95_ms = PercentileNs(95.0) / kNsPerMs;
+  summary.p99_ms = PercentileNs(99.0) / kNsPerMs;
+  summary.max_ms = max_ns / kNsPerMs;
+  summary.fps = seconds > 0.0 ? count / seconds : 0.0;
+  return summary;
+}
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief 无锁延迟直方图
+ *
+ * 以纳秒记录耗时，桶按 2 的幂分段、每段再线性细分 16 个子桶（对数-线性分桶），
+ * 相对误差不超过 1/16，覆盖 1 ns 到约 68 s。Record 只做原子累加，可被任意线程
+ * 并发调用；Snapshot 读取当前计数，两次快照相减即得到一个统计周期内的分布。
+ */
+class LatencyHistogram
+{
+public:
+    static constexpr size_t kSubBucketBits = 4;
+    static constexpr size_t kSubBuckets = size_t(1) << kSubBucketBits;
+    static constexpr size_t kMaxValueBits = 36;  // 2^36 ns ≈ 68.7 s，更大的值计入最后一个桶
+    static constexpr size_t kBucketCount = (kMaxValueBits - kSubBucketBits + 1) * kSubBuckets;
+
+    /**
+     * @brief 分布摘要，单位毫秒
+     */
+    struct Summary
+    {
+        uint64_t count = 0;
+        double mean_ms = 0.0;
+        double p50_ms = 0.0;
+        double p95_ms = 0.0;
+        double p99_ms = 0.0;
+        double max_ms = 0.0;
+        double fps = 0.0;  // count / 统计时长
+    };
+
+    /**
+     * @brief 直方图计数快照
+     */
+    struct Snapshot
+    {
+        std::array<uint64_t, kBucketCount> buckets {};
+        uint64_t count = 0;
+        uint64_t sum_ns = 0;
+        uint64_t max_ns = 0;
+
+        /**
+         * @brief 计算本快照相对更早快照的增量，最大值取增量中最高非空桶的上界
+         */
+        Snapshot Since(const Snapshot& earlier) const;
+
+        /**
+         * @brief 百分位数（0-100），返回所在桶的上界并不超过记录到的最大值
+         */
+        uint64_t PercentileNs(double percentile) const;
+
+        /**
+         * @param seconds 统计时长，用于计算 fps，<= 0 时 fps 为 0
+         */
+        Summary Summarize(double seconds) const;
+    };
+
+    LatencyHistogram() = default;
+
+    LatencyHistogram(const LatencyHistogram&) = delete;
+    LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+
+    void Record(uint64_t ns);
+
+    void Record(std::chrono::steady_clock::duration duration);
+
+    Snapshot GetSnapshot() const;
+
+    static size_t BucketIndex(uint64_t ns);
+
+    /**
+     * @brief 桶内可能出现的最大值
+     */
+    static uint64_t BucketUpperBound(size_t index);
+
+private:
+    std::array<std::atomic<uint64_t>, kBucketCount> buckets_ {};
+    std::atomic<uint64_t> sum_ns_ {0};
+    std::atomic<uint64_t> max_ns_ {0};
+};
+
+/**
+ * @brief 作用域计时器，析构时将经过的时间记入直方图，直方图为空指针时不计时
+ */
+class ScopedLatency
+{
+public:
+    explicit ScopedLatency(LatencyHistogram* histogram)
+        : histogram_(histogram),
+          start_(histogram ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point())
+    {
+    }
+
+    ~ScopedLatency()
+    {
+        if (histogram_) {
+            histogram_->Record(std::chrono::steady_clock::now() - start_);
+        }
+    }
+
+    ScopedLatency(const ScopedLatency&) = delete;
+    ScopedLatency& operator=(const ScopedLatency&) = delete;
+
+private:
+    LatencyHistogram* histogram_;
+    std::chrono::steady_clock::time_point start_;
+};
@@ -0,0 +1,35 @@
+#pragma once
+
+/**
+ * @brief SIMD 指令集检测
+ *
+ * x86 平台不要求以 -mavx2 编译：AVX2 内核通过 PERCEPTION_TARGET_AVX2 单独编译，
+ * 运行时由 CpuSupportsAvx2() 选择路径；ARM64 平台 NEON 始终可用。
+ */
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64)
+#define PERCEPTION_SIMD_X86 1
+#include <immintrin.h>
+#if defined(__GNUC__) || defined(__clang__)
+#define PERCEPTION_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#else
+#define PERCEPTION_TARGET_AVX2
+#endif
+#endif
+
+#if defined(__ARM_NEON) || defined(__aarch64__)
+#define PERCEPTION_SIMD_NEON 1
+#include <arm_neon.h>
+#endif
+
+/**
+ * @brief 当前 CPU 是否支持 AVX2 + FMA
+ */
+inline bool CpuSupportsAvx2() {
+#if defined(PERCEPTION_SIMD_X86) && (defined(__GNUC__) || defined(__clang__))
+    static const bool supported = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+    return supported;
+#else
+    return false;
+#endif
+}
@@ -0,0 +1,115 @@
+#include "ThreadPool.hpp"
+#include <algorithm>
+#include <atomic>
+
+ThreadPool::ThreadPool(size_t num_threads) {
+  if (num_threads == 0) {
+    num_threads = std::max(1u, std::thread::hardware_concurrency());
+  }
+
+  workers_.reserve(num_threads);
+  for (size_t i = 0; i < num_threads; ++i) {
+    workers_.emplace_back(&ThreadPool::WorkerLoop, this);
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  cv_.notify_all();
+  for (auto &worker : workers_) {
+    if (worker.joinable()) {
+      worker.join();
+    }
+  }
+}
+
+ThreadPool &ThreadPool::Shared() {
+  static ThreadPool instance;
+  return instance;
+}
+
+size_t ThreadPool::Pending() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return tasks_.size();
+}
+
+void ThreadPool::Enqueue(std::function<void()> task) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    tasks_.push_back(std::move(task));
+  }
+  cv_.notify_one();
+}
+
+void ThreadPool::WorkerLoop() {
+  while (true) {
+    std::function<void()> task;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      cv_.wait(lock, [this] { return stop_ || !tasks_.empty(); });
+      if (stop_ && tasks_.empty()) {
+        return;
+      }
+      task = std::move(tasks_.front());
+      tasks_.pop_front();
+    }
+    task();
+  }
+}
+
+void ThreadPool::ParallelFor(size_t begin, size_t end, size_t grain,
+                             const std::function<void(size_t, size_t)> &body) {
+  if (end <= begin) return;
+
+  const size_t count = end - begin;
+  const size_t parallelism = workers_.size() + 1;
+  if (grain == 0) {
+    grain = (count + parallelism * 4 - 1) / (parallelism * 4);
+  }
+  grain = std::max<size_t>(grain, 1);
+
+  const size_t chunks = (count + grain - 1) / grain;
+  if (chunks <= 1 || workers_.empty()) {
+    body(begin, end);
+    return;
+  }
+
+  // Chunks are claimed through a shared counter. The calling thread keeps claiming until
+  // none are left, so helpers that never get scheduled (e.g. when called from inside a
+  // pool task) cannot stall completion; it only waits for chunks already in flight.
+  struct State {
+    std::atomic<size_t> next {0};
+    size_t done = 0;
+    std::mutex mutex;
+    std::condition_variable cv;
+  };
+  auto state = std::make_shared<State>();
+
+  auto run = [state, begin, end, grain, chunks, &body]() {
+    size_t finished = 0;
+    for (size_t chunk = state->next++; chunk < chunks; chunk = state->next++) {
+      const size_t chunk_begin = begin + chunk * grain;
+      body(chunk_begin, std::min(end, chunk_begin + grain));
+      finished++;
+    }
+    if (finished > 0) {
+      std::lock_guard<std::mutex> lock(state->mutex);
+      state->done += finished;
+      if (state->done == chunks) {
+        state->cv.notify_all();
+      }
+    }
+  };
+
+  const size_t helpers = std::min(workers_.size(), chunks - 1);
+  for (size_t i = 0; i < helpers; ++i) {
+    Enqueue(run);
+  }
+  run();
+
+  std::unique_lock<std::mutex> lock(state->mutex);
+  state->cv.wait(lock, [&state, chunks] { return state->done == chunks; });
+}
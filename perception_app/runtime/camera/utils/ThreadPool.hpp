@@ -0,0 +1,79 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+/**
+ * @brief 固定大小的工作线程池
+ *
+ * 用于帧处理内核的行级并行（ParallelFor）以及后台任务（Submit）。
+ * ParallelFor 的调用线程也参与计算，因此在池内任务中嵌套调用不会死锁。
+ */
+class ThreadPool {
+public:
+    /**
+     * @param num_threads 工作线程数，0 表示使用硬件并发数
+     */
+    explicit ThreadPool(size_t num_threads = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /**
+     * @brief 进程内共享的线程池，供各处理内核使用
+     */
+    static ThreadPool& Shared();
+
+    /**
+     * @brief 提交异步任务
+     * @return 任务结果的future
+     */
+    template <typename F>
+    auto Submit(F&& task) -> std::future<typename std::invoke_result<F>::type> {
+        using Result = typename std::invoke_result<F>::type;
+        auto packaged = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(task));
+        std::future<Result> result = packaged->get_future();
+        Enqueue([packaged] { (*packaged)(); });
+        return result;
+    }
+
+    /**
+     * @brief 将区间 [begin, end) 切分为若干块并行执行
+     * @param begin 起始索引
+     * @param end 结束索引（不含）
+     * @param grain 每块最少元素数，0 表示按线程数自动切分
+     * @param body 处理函数，参数为块的 [begin, end)
+     */
+    void ParallelFor(size_t begin, size_t end, size_t grain, const std::function<void(size_t, size_t)>& body);
+
+    /**
+     * @brief 工作线程数
+     */
+    size_t Size() const { return workers_.size(); }
+
+    /**
+     * @brief 待执行任务数
+     */
+    size_t Pending() const;
+
+private:
+    void Enqueue(std::function<void()> task);
+
+    void WorkerLoop();
+
+private:
+    std::vector<std::thread> workers_;
+    std::deque<std::function<void()>> tasks_;
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    bool stop_ = false;
+};
@@ -23,6 +23,24 @@ inline void printCameraInfo(const mmind::eye::CameraInfo &cameraInfo) {
   LOG_INFO_STREAM << std::endl;
 }
 
+inline bool ConnectCamera(mmind::eye::Camera &device, const mmind::eye::CameraInfo &cameraInfo) {
+  // 连接重试逻辑：最多重试3次，每次间隔2秒
+  int maxRetries = 3;
+  mmind::eye::ErrorStatus status;
+  while (maxRetries > 0) {
+    status = device.connect(cameraInfo);
+    if (!status.isOK()) {
+      showError(status);
+      maxRetries--;
+      std::this_thread::sleep_for(std::chrono::seconds(2));
+    } else {
+      LOG_INFO_STREAM << "Successfully connected to the camera " << cameraInfo.serialNumber << ".";
+      break;
+    }
+  }
+  return status.isOK();
+}
+
 inline bool FindAndConnect(mmind::eye::Camera &device) {
   std::cout << "Looking for available cameras..." << std::endl;
   std::vector<mmind::eye::CameraInfo> deviceInfoList = mmind::eye::Camera::discoverCameras();
@@ -37,19 +55,5 @@ inline bool FindAndConnect(mmind::eye::Camera &device) {
     printCameraInfo(deviceInfoList[i]);
   }
 
-  // 连接重试逻辑：最多重试3次，每次间隔2秒
-  int maxRetries = 3;
-  mmind::eye::ErrorStatus status;
-  while (maxRetries > 0) {
-    status = device.connect(deviceInfoList[0]);
-    if (!status.isOK()) {
-      showError(status);
-      maxRetries--;
-      std::this_thread::sleep_for(std::chrono::seconds(2));
-    } else {
-      LOG_INFO_STREAM << "Successfully connected to the camera.";
-      break;
-    }
-  }
-  return status.isOK();
+  return ConnectCamera(device, deviceInfoList[0]);
 }
\ No newline at end of file
@@ -75,6 +75,14 @@ std::string ConfigHelper::CameraConfig::SaveConfig::save_textured_point_cloud_fi
   return this->save_path + "/" + suffix + "_TexturedPointCloud.ply";
 }
 
+std::string ConfigHelper::CameraConfig::SaveConfig::save_compressed_depth_file(const std::string &suffix) const {
+  return this->save_path + "/" + suffix + "_DepthMap.mdc";
+}
+
+std::string ConfigHelper::CameraConfig::SaveConfig::save_container_file(const std::string &suffix) const {
+  return this->save_path + "/" + suffix + "_Frame.mfc";
+}
+
 bool ConfigHelper::loadConfigFromJson(const std::string &configPath) {
   try {
     std::ifstream file(configPath);
@@ -97,6 +105,7 @@ bool ConfigHelper::loadConfigFromJson(const std::string &configPath) {
         camera_config_.render.window_title = render.value("window_title", "Real-time Capture Display");
         camera_config_.render.window_width = render.value("window_width", 1280);
         camera_config_.render.window_height = render.value("window_height", 720);
+        camera_config_.render.max_fps = render.value("max_fps", 30.0);
       }
 
       // Parse capture config
@@ -119,7 +128,109 @@ bool ConfigHelper::loadConfigFromJson(const std::string &configPath) {
         camera_config_.save.save_depth_map = save.value("save_depth_map", true);
         camera_config_.save.save_point_cloud = save.value("save_point_cloud", true);
         camera_config_.save.save_textured_point_cloud = save.value("save_textured_point_cloud", true);
+        camera_config_.save.depth_format = save.value("depth_format", "tiff");
+        camera_config_.save.depth_precision_mm = save.value("depth_precision_mm", 0.01f);
+        camera_config_.save.point_cloud_format = save.value("point_cloud_format", "ply");
         camera_config_.save.max_save_count = save.value("max_save_count", 20);
+        camera_config_.save.max_save_size_mb = save.value("max_save_size_mb", 0);
+        camera_config_.save.min_free_space_mb = save.value("min_free_space_mb", 1024);
+        camera_config_.save.async_write = save.value("async_write", true);
+        camera_config_.save.writer_threads = save.value("writer_threads", 2);
+        camera_config_.save.write_queue_size = save.value("write_queue_size", 8);
+        camera_config_.save.overflow_policy = save.value("overflow_policy", "drop_oldest");
+      }
+
+      // Parse frame source config
+      if (camera.contains("source")) {
+        auto &source = camera["source"];
+        camera_config_.source.type = source.value("type", "camera");
+        camera_config_.source.serial_numbers = source.value("serial_numbers", std::vector<std::string>());
+        if (source.contains("replay")) {
+          auto &replay = source["replay"];
+          camera_config_.source.replay.path = replay.value("path", "./dumps/");
+          camera_config_.source.replay.rate_hz = replay.value("rate_hz", 0.0);
+          camera_config_.source.replay.loop = replay.value("loop", true);
+          camera_config_.source.replay.preload = replay.value("preload", false);
+          camera_config_.source.replay.depth_intrinsics =
+              replay.value("depth_intrinsics", std::vector<double>());
+        }
+      }
+
+      // Parse pipeline config
+      if (camera.contains("pipeline")) {
+        auto &pipeline = camera["pipeline"];
+        camera_config_.pipeline.enable = pipeline.value("enable", true);
+        camera_config_.pipeline.decode_queue_size = pipeline.value("decode_queue_size", 2);
+        camera_config_.pipeline.inference_queue_size = pipeline.value("inference_queue_size", 2);
+        camera_config_.pipeline.save_queue_size = pipeline.value("save_queue_size", 4);
+        camera_config_.pipeline.display_queue_size = pipeline.value("display_queue_size", 1);
+        camera_config_.pipeline.drop_when_full = pipeline.value("drop_when_full", true);
+        camera_config_.pipeline.frame_pool_size = pipeline.value("frame_pool_size", 8);
+      }
+
+      // Parse metrics config
+      if (camera.contains("metrics")) {
+        auto &metrics = camera["metrics"];
+        camera_config_.metrics.enable = metrics.value("enable", true);
+        camera_config_.metrics.report_interval_ms = metrics.value("report_interval_ms", 5000);
+      }
+
+      // Parse downsample config
+      if (camera.contains("downsample")) {
+        auto &downsample = camera["downsample"];
+        camera_config_.downsample.mode = downsample.value("mode", "none");
+        camera_config_.downsample.voxel_size_mm = downsample.value("voxel_size_mm", 5.0f);
+        camera_config_.downsample.stride = downsample.value("stride", 4);
+      }
+
+      // Parse crop config
+      if (camera.contains("crop")) {
+        auto &crop = camera["crop"];
+        camera_config_.crop.enable = crop.value("enable", false);
+        camera_config_.crop.roi = crop.value("roi", std::vector<int>());
+        camera_config_.crop.min_depth_mm = crop.value("min_depth_mm", 0.0f);
+        camera_config_.crop.max_depth_mm = crop.value("max_depth_mm", 0.0f);
+        if (crop.contains("box")) {
+          auto &box = crop["box"];
+          camera_config_.crop.box.enable = box.value("enable", false);
+          camera_config_.crop.box.center_mm = box.value("center_mm", std::vector<double>());
+          camera_config_.crop.box.size_mm = box.value("size_mm", std::vector<double>());
+          camera_config_.crop.box.rotation_deg = box.value("rotation_deg", std::vector<double>());
+        }
+      }
+
+      // Parse temporal filter config
+      if (camera.contains("temporal_filter")) {
+        auto &filter = camera["temporal_filter"];
+        camera_config_.temporal_filter.enable = filter.value("enable", false);
+        camera_config_.temporal_filter.alpha = filter.value("alpha", 0.4f);
+        camera_config_.temporal_filter.reset_threshold_mm = filter.value("reset_threshold_mm", 8.0f);
+        camera_config_.temporal_filter.reset_ratio = filter.value("reset_ratio", 0.01f);
+      }
+
+      // Parse scene change config
+      if (camera.contains("scene_change")) {
+        auto &scene = camera["scene_change"];
+        camera_config_.scene_change.enable = scene.value("enable", false);
+        camera_config_.scene_change.cell_size = scene.value("cell_size", 8);
+        camera_config_.scene_change.block_cells = scene.value("block_cells", 4);
+        camera_config_.scene_change.depth_threshold_mm = scene.value("depth_threshold_mm", 10.0f);
+        camera_config_.scene_change.color_threshold = scene.value("color_threshold", 12.0f);
+        camera_config_.scene_change.min_changed_ratio = scene.value("min_changed_ratio", 0.0f);
+        camera_config_.scene_change.max_skipped_frames = scene.value("max_skipped_frames", 0);
+        camera_config_.scene_change.save_only_on_change = scene.value("save_only_on_change", true);
+      }
+
+      // Parse recorder config
+      if (camera.contains("recorder")) {
+        auto &recorder = camera["recorder"];
+        camera_config_.recorder.enable = recorder.value("enable", false);
+        camera_config_.recorder.max_frames = recorder.value("max_frames", 60);
+        camera_config_.recorder.max_memory_mb = recorder.value("max_memory_mb", 2048);
+        camera_config_.recorder.post_trigger_frames = recorder.value("post_trigger_frames", 30);
+        camera_config_.recorder.path = recorder.value("path", "./dumps/events/");
+        camera_config_.recorder.trigger_on_inference_failure = recorder.value("trigger_on_inference_failure", true);
+        camera_config_.recorder.trigger_on_emergency_stop = recorder.value("trigger_on_emergency_stop", true);
       }
     }
 
@@ -137,6 +248,11 @@ bool ConfigHelper::loadConfigFromJson(const std::string &configPath) {
       auto &inference = j["inference_config"];
       inference_config_.enable = inference.value("enable", false);
       inference_config_.config_path = inference.value("config_path", "config/inference_config.json");
+      if (inference.contains("async")) {
+        auto &async = inference["async"];
+        inference_config_.async.enable = async.value("enable", false);
+        inference_config_.async.workers = async.value("workers", 1);
+      }
     }
 
     // Parse communication config (single entry point)
@@ -260,6 +376,7 @@ void ConfigHelper::printConfig() const {
   std::cout << "  Render:" << std::endl;
   std::cout << "    Enabled: " << (camera_config_.render.enable ? "Yes" : "No") << std::endl;
   std::cout << "    Window Title: " << camera_config_.render.window_title << std::endl;
+  std::cout << "    Max FPS: " << camera_config_.render.max_fps << std::endl;
   std::cout << "    Window Size: " << camera_config_.render.window_width << "x" << camera_config_.render.window_height
             << std::endl;
 
@@ -278,7 +395,100 @@ void ConfigHelper::printConfig() const {
   std::cout << "    Save Point Cloud: " << (camera_config_.save.save_point_cloud ? "Yes" : "No") << std::endl;
   std::cout << "    Save Textured Point Cloud: " << (camera_config_.save.save_textured_point_cloud ? "Yes" : "No")
             << std::endl;
+  std::cout << "    Depth Format: " << camera_config_.save.depth_format << " (precision "
+            << camera_config_.save.depth_precision_mm << " mm)" << std::endl;
+  std::cout << "    Point Cloud Format: " << camera_config_.save.point_cloud_format << std::endl;
   std::cout << "    Max Save Count: " << camera_config_.save.max_save_count << std::endl;
+  std::cout << "    Max Save Size: " << camera_config_.save.max_save_size_mb << " MB" << std::endl;
+  std::cout << "    Min Free Space: " << camera_config_.save.min_free_space_mb << " MB" << std::endl;
+  std::cout << "    Async Write: " << (camera_config_.save.async_write ? "Yes" : "No") << std::endl;
+  std::cout << "    Writer Threads: " << camera_config_.save.writer_threads << std::endl;
+  std::cout << "    Write Queue Size: " << camera_config_.save.write_queue_size << std::endl;
+  std::cout << "    Overflow Policy: " << camera_config_.save.overflow_policy << std::endl;
+
+  std::cout << "  Source:" << std::endl;
+  std::cout << "    Type: " << camera_config_.source.type << std::endl;
+  if (camera_config_.source.type == "camera") {
+    std::cout << "    Cameras: ";
+    if (camera_config_.source.serial_numbers.empty()) {
+      std::cout << "first discovered";
+    }
+    for (const auto &serial : camera_config_.source.serial_numbers) {
+      std::cout << serial << " ";
+    }
+    std::cout << std::endl;
+  }
+  if (camera_config_.source.type == "replay") {
+    std::cout << "    Replay Path: " << camera_config_.source.replay.path << std::endl;
+    std::cout << "    Replay Rate: " << camera_config_.source.replay.rate_hz << " Hz" << std::endl;
+    std::cout << "    Replay Loop: " << (camera_config_.source.replay.loop ? "Yes" : "No") << std::endl;
+    std::cout << "    Replay Preload: " << (camera_config_.source.replay.preload ? "Yes" : "No") << std::endl;
+  }
+
+  std::cout << "  Pipeline:" << std::endl;
+  std::cout << "    Enabled: " << (camera_config_.pipeline.enable ? "Yes" : "No") << std::endl;
+  std::cout << "    Queue Sizes (decode/inference/save/display): " << camera_config_.pipeline.decode_queue_size << "/"
+            << camera_config_.pipeline.inference_queue_size << "/" << camera_config_.pipeline.save_queue_size << "/"
+            << camera_config_.pipeline.display_queue_size << std::endl;
+  std::cout << "    Drop When Full: " << (camera_config_.pipeline.drop_when_full ? "Yes" : "No") << std::endl;
+  std::cout << "    Frame Pool Size: " << camera_config_.pipeline.frame_pool_size << std::endl;
+
+  std::cout << "  Metrics:" << std::endl;
+  std::cout << "    Enabled: " << (camera_config_.metrics.enable ? "Yes" : "No") << std::endl;
+  std::cout << "    Report Interval: " << camera_config_.metrics.report_interval_ms << " ms" << std::endl;
+
+  std::cout << "  Downsample:" << std::endl;
+  std::cout << "    Mode: " << camera_config_.downsample.mode << std::endl;
+  std::cout << "    Voxel Size: " << camera_config_.downsample.voxel_size_mm << " mm" << std::endl;
+  std::cout << "    Stride: " << camera_config_.downsample.stride << std::endl;
+
+  std::cout << "  Crop:" << std::endl;
+  std::cout << "    Enabled: " << (camera_config_.crop.enable ? "Yes" : "No") << std::endl;
+  if (camera_config_.crop.enable) {
+    std::cout << "    ROI: ";
+    if (camera_config_.crop.roi.empty()) {
+      std::cout << "full frame";
+    }
+    for (int value : camera_config_.crop.roi) {
+      std::cout << value << " ";
+    }
+    std::cout << std::endl;
+    std::cout << "    Depth Range: " << camera_config_.crop.min_depth_mm << " - " << camera_config_.crop.max_depth_mm
+              << " mm" << std::endl;
+    std::cout << "    Box: " << (camera_config_.crop.box.enable ? "Yes" : "No") << std::endl;
+  }
+
+  std::cout << "  Temporal Filter:" << std::endl;
+  std::cout << "    Enabled: " << (camera_config_.temporal_filter.enable ? "Yes" : "No") << std::endl;
+  if (camera_config_.temporal_filter.enable) {
+    std::cout << "    Alpha: " << camera_config_.temporal_filter.alpha << std::endl;
+    std::cout << "    Reset Threshold: " << camera_config_.temporal_filter.reset_threshold_mm << " mm + "
+              << camera_config_.temporal_filter.reset_ratio << " x depth" << std::endl;
+  }
+
+  std::cout << "  Scene Change:" << std::endl;
+  std::cout << "    Enabled: " << (camera_config_.scene_change.enable ? "Yes" : "No") << std::endl;
+  if (camera_config_.scene_change.enable) {
+    std::cout << "    Cell Size: " << camera_config_.scene_change.cell_size << std::endl;
+    std::cout << "    Block Cells: " << camera_config_.scene_change.block_cells << std::endl;
+    std::cout << "    Depth Threshold: " << camera_config_.scene_change.depth_threshold_mm << " mm" << std::endl;
+    std::cout << "    Color Threshold: " << camera_config_.scene_change.color_threshold << std::endl;
+    std::cout << "    Min Changed Ratio: " << camera_config_.scene_change.min_changed_ratio << std::endl;
+    std::cout << "    Max Skipped Frames: " << camera_config_.scene_change.max_skipped_frames << std::endl;
+    std::cout << "    Save Only On Change: " << (camera_config_.scene_change.save_only_on_change ? "Yes" : "No")
+              << std::endl;
+  }
+
+  std::cout << "  Recorder:" << std::endl;
+  std::cout << "    Enabled: " << (camera_config_.recorder.enable ? "Yes" : "No") << std::endl;
+  std::cout << "    Max Frames: " << camera_config_.recorder.max_frames << std::endl;
+  std::cout << "    Max Memory: " << camera_config_.recorder.max_memory_mb << " MB" << std::endl;
+  std::cout << "    Post Trigger Frames: " << camera_config_.recorder.post_trigger_frames << std::endl;
+  std::cout << "    Path: " << camera_config_.recorder.path << std::endl;
+  std::cout << "    Trigger On Inference Failure: "
+            << (camera_config_.recorder.trigger_on_inference_failure ? "Yes" : "No") << std::endl;
+  std::cout << "    Trigger On Emergency Stop: " << (camera_config_.recorder.trigger_on_emergency_stop ? "Yes" : "No")
+            << std::endl;
 
   std::cout << "Log Config:" << std::endl;
   std::cout << "  Enabled: " << (log_config_.enable ? "Yes" : "No") << std::endl;
@@ -289,6 +499,10 @@ void ConfigHelper::printConfig() const {
   std::cout << "Inference Config:" << std::endl;
   std::cout << "  Enabled: " << (inference_config_.enable ? "Yes" : "No") << std::endl;
   std::cout << "  Config Path: " << inference_config_.config_path << std::endl;
+  std::cout << "  Async: " << (inference_config_.async.enable ? "Yes" : "No") << std::endl;
+  if (inference_config_.async.enable) {
+    std::cout << "    Workers: " << inference_config_.async.workers << std::endl;
+  }
 
   std::cout << "==================" << std::endl;
 }
@@ -1,4 +1,7 @@
+#pragma once
+
 #include <string>
+#include <vector>
 #include <fstream>
 #include <iostream>
 #include <nlohmann/json.hpp>
@@ -15,6 +18,7 @@ public:
             std::string window_title = "Real-time Capture Display";
             int window_width = 1280;
             int window_height = 720;
+            double max_fps = 30.0; // 显示帧率上限，0 表示不限制；显示在独立线程中进行，不影响采集帧率
         } render;
 
         struct CaptureConfig
@@ -34,13 +38,108 @@ public:
             bool save_depth_map = true;
             bool save_point_cloud = true;
             bool save_textured_point_cloud = true;
-            int max_save_count = 20; // 添加最大保存数量控制
+            std::string depth_format = "tiff"; // tiff: 32 位浮点 TIFF; mdc: DepthCodec 压缩深度
+            float depth_precision_mm = 0.01f; // mdc 量化精度（毫米）
+            std::string point_cloud_format = "ply"; // ply: 分别保存图像和 PLY; container: 整帧写入一个 .mfc 帧容器
+            int max_save_count = 20; // 最多保留的帧数（含启动前已有的保存文件），0 表示不限制
+            int max_save_size_mb = 0; // 保存文件最多占用的空间，0 表示不限制
+            int min_free_space_mb = 1024; // 磁盘最小剩余空间，不足时删除最旧的帧，无可删除时暂停保存
+            bool async_write = true; // 是否由后台写线程池异步落盘
+            int writer_threads = 2; // 写线程数
+            int write_queue_size = 8; // 待写帧队列容量
+            std::string overflow_policy = "drop_oldest"; // 磁盘跟不上时的策略: block, drop_oldest, drop_newest
 
             std::string save_2d_image_file(const std::string& suffix) const;
             std::string save_depth_map_file(const std::string& suffix) const;
             std::string save_point_cloud_file(const std::string& suffix) const;
             std::string save_textured_point_cloud_file(const std::string& suffix) const;
+            std::string save_compressed_depth_file(const std::string& suffix) const;
+            std::string save_container_file(const std::string& suffix) const;
         } save;
+
+        struct SourceConfig
+        {
+            std::string type = "camera"; // 帧数据来源: camera, replay
+            std::vector<std::string> serial_numbers; // 同时采集的相机序列号，为空时连接发现的第一台相机
+            struct ReplayConfig
+            {
+                std::string path = "./dumps/"; // SaveImages 输出目录
+                double rate_hz = 0.0; // 回放帧率，0 表示尽可能快
+                bool loop = true; // 读完后从头循环
+                bool preload = false; // 启动前将所有帧读入内存
+                std::vector<double> depth_intrinsics; // 深度相机内参 [fx, fy, cx, cy]，为空时只能回放保存的 PLY 点云
+            } replay;
+        } source;
+
+        struct PipelineConfig
+        {
+            bool enable = true; // 是否启用多线程流水线（关闭时退化为串行处理）
+            int decode_queue_size = 2;
+            int inference_queue_size = 2;
+            int save_queue_size = 4;
+            int display_queue_size = 1;
+            bool drop_when_full = true; // 队列满时丢弃最旧帧，否则阻塞上游
+            int frame_pool_size = 8; // 帧缓冲池保留的 FrameSet 数量
+        } pipeline;
+
+        struct MetricsConfig
+        {
+            bool enable = true; // 是否统计各阶段延迟
+            int report_interval_ms = 5000; // 延迟报告日志周期，0 表示只在退出时输出
+        } metrics;
+
+        struct DownsampleConfig
+        {
+            std::string mode = "none"; // none, voxel: 体素质心, stride: 有序抽点, bin: 有序分块均值
+            float voxel_size_mm = 5.0f; // voxel 模式的体素边长（毫米）
+            int stride = 4; // stride / bin 模式的步长
+        } downsample;
+
+        struct CropConfig
+        {
+            bool enable = false; // 启用后点云类产品只由裁剪后的深度图生成
+            std::vector<int> roi; // 深度图 ROI [x, y, width, height]，宽或高为 0 时延伸到图像边缘，为空时为整幅
+            float min_depth_mm = 0.0f; // 深度下限，0 表示不限制
+            float max_depth_mm = 0.0f; // 深度上限，0 表示不限制
+            struct BoxConfig
+            {
+                bool enable = false;
+                std::vector<double> center_mm; // 包围盒中心 [x, y, z]，点云坐标系（已应用坐标变换）
+                std::vector<double> size_mm; // 包围盒边长 [x, y, z]
+                std::vector<double> rotation_deg; // 绕 X、Y、Z 轴的旋转，为空时为轴对齐
+            } box;
+        } crop;
+
+        struct TemporalFilterConfig
+        {
+            bool enable = false; // 对每台相机的连续帧深度做指数滑动平均
+            float alpha = 0.4f; // 当前帧权重 (0, 1]，越小越平滑
+            float reset_threshold_mm = 8.0f; // 深度变化超过 阈值 + 比例 * 深度 时视为运动，该像素重新开始平均
+            float reset_ratio = 0.01f;
+        } temporal_filter;
+
+        struct SceneChangeConfig
+        {
+            bool enable = false; // 检测每帧与该相机上一处理帧相比场景是否变化
+            int cell_size = 8; // 比较前的下采样倍数
+            int block_cells = 4; // SAD 块边长（下采样后的像素）
+            float depth_threshold_mm = 10.0f; // 块内平均深度差阈值，<= 0 时不比较深度
+            float color_threshold = 12.0f; // 块内平均亮度差阈值（0-255），<= 0 时不比较彩色
+            float min_changed_ratio = 0.0f; // 变化块占比超过该值才视为场景变化，0 表示任一块
+            int max_skipped_frames = 0; // 连续跳过的帧数上限，达到后强制处理一帧，0 表示不限制
+            bool save_only_on_change = true; // 场景未变化的帧不保存（事件录制不受影响）
+        } scene_change;
+
+        struct RecorderConfig
+        {
+            bool enable = false; // 启用后帧只保存在内存环形缓冲中，触发时才落盘，替代逐帧保存
+            int max_frames = 60; // 缓冲的最大帧数（多相机时为各相机帧数之和）
+            int max_memory_mb = 2048; // 缓冲的最大内存，0 表示只按帧数限制
+            int post_trigger_frames = 30; // 触发后继续记录的帧数
+            std::string path = "./dumps/events/"; // 每次触发在其下创建 <时间>_<原因> 目录
+            bool trigger_on_inference_failure = true; // 推理失败时触发
+            bool trigger_on_emergency_stop = true; // 收到 EMERGENCY_STOP 请求时触发
+        } recorder;
     } camera_config_;
 
     struct LogConfig
@@ -55,6 +154,11 @@ public:
     {
         bool enable = false;
         std::string config_path = "config/inference_config.json";
+        struct AsyncConfig
+        {
+            bool enable = false; // 推理在独立工作线程执行，采集不等待推理完成，积压时只保留最新帧
+            int workers = 1; // 工作线程数，算法不可重入时固定为 1
+        } async;
     } inference_config_;
 
     // 新增通信配置结构
@@ -444,6 +444,10 @@ std::string MessageFactory::GetMessageTypeName(uint16_t message_id) {
       return ENUM_TO_STRING(DEVICE_STATUS);
     case MessageIds::DEVICE_CONFIG:
       return ENUM_TO_STRING(DEVICE_CONFIG);
+    case MessageIds::DEPTH_FRAME:
+      return ENUM_TO_STRING(DEPTH_FRAME);
+    case MessageIds::INFERENCE_RESULT:
+      return ENUM_TO_STRING(INFERENCE_RESULT);
     default:
       return "Unknown";
   }
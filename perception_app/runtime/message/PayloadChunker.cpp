@@ -0,0 +1,127 @@
+#include "PayloadChunker.hpp"
+#include <algorithm>
+#include <cstring>
+
+namespace perception {
+
+namespace {
+void WriteUint16(uint8_t *dst, uint16_t value) {
+  dst[0] = static_cast<uint8_t>(value & 0xFF);
+  dst[1] = static_cast<uint8_t>((value >> 8) & 0xFF);
+}
+
+void WriteUint32(uint8_t *dst, uint32_t value) {
+  for (int i = 0; i < 4; i++) {
+    dst[i] = static_cast<uint8_t>((value >> (8 * i)) & 0xFF);
+  }
+}
+
+uint16_t ReadUint16(const uint8_t *src) { return static_cast<uint16_t>(src[0]) | (static_cast<uint16_t>(src[1]) << 8); }
+
+uint32_t ReadUint32(const uint8_t *src) {
+  return static_cast<uint32_t>(src[0]) | (static_cast<uint32_t>(src[1]) << 8) |
+         (static_cast<uint32_t>(src[2]) << 16) | (static_cast<uint32_t>(src[3]) << 24);
+}
+}  // namespace
+
+std::vector<std::vector<uint8_t>> PayloadChunker::Split(uint32_t stream_id, const std::vector<uint8_t> &data) {
+  return Split(stream_id, data.data(), data.size());
+}
+
+std::vector<std::vector<uint8_t>> PayloadChunker::Split(uint32_t stream_id, const uint8_t *data, size_t size) {
+  const size_t count = std::max<size_t>(1, (size + MAX_CHUNK_DATA - 1) / MAX_CHUNK_DATA);
+  std::vector<std::vector<uint8_t>> chunks;
+  if (count > UINT16_MAX || size > UINT32_MAX) {
+    return chunks;
+  }
+
+  chunks.reserve(count);
+  for (size_t index = 0; index < count; index++) {
+    const size_t offset = index * MAX_CHUNK_DATA;
+    const size_t length = std::min(MAX_CHUNK_DATA, size - offset);
+
+    std::vector<uint8_t> chunk(CHUNK_HEADER_SIZE + length);
+    WriteUint32(chunk.data(), stream_id);
+    WriteUint16(chunk.data() + 4, static_cast<uint16_t>(index));
+    WriteUint16(chunk.data() + 6, static_cast<uint16_t>(count));
+    WriteUint32(chunk.data() + 8, static_cast<uint32_t>(size));
+    WriteUint32(chunk.data() + 12, static_cast<uint32_t>(offset));
+    if (length > 0) {
+      std::memcpy(chunk.data() + CHUNK_HEADER_SIZE, data + offset, length);
+    }
+    chunks.push_back(std::move(chunk));
+  }
+  return chunks;
+}
+
+PayloadAssembler::PayloadAssembler(size_t max_pending) : max_pending_(std::max<size_t>(1, max_pending)) {}
+
+bool PayloadAssembler::Add(const std::vector<uint8_t> &payload, uint32_t &stream_id, std::vector<uint8_t> &data) {
+  if (payload.size() < PayloadChunker::CHUNK_HEADER_SIZE) {
+    dropped_++;
+    return false;
+  }
+
+  const uint32_t id = ReadUint32(payload.data());
+  const uint16_t index = ReadUint16(payload.data() + 4);
+  const uint16_t count = ReadUint16(payload.data() + 6);
+  const uint32_t total_size = ReadUint32(payload.data() + 8);
+  const uint32_t offset = ReadUint32(payload.data() + 12);
+  const size_t length = payload.size() - PayloadChunker::CHUNK_HEADER_SIZE;
+
+  // Every chunk must describe the layout Split produces: total_size fills exactly count chunks, and the chunk sits at
+  // its index. This bounds the buffer a forged first chunk can make us allocate by count * MAX_CHUNK_DATA.
+  const size_t max_size = size_t(count) * PayloadChunker::MAX_CHUNK_DATA;
+  const bool valid_size = count == 1 ? total_size <= max_size
+                                     : size_t(count - 1) * PayloadChunker::MAX_CHUNK_DATA < total_size &&
+                                           total_size <= max_size;
+  if (count == 0 || index >= count || !valid_size || offset != size_t(index) * PayloadChunker::MAX_CHUNK_DATA ||
+      length != std::min(PayloadChunker::MAX_CHUNK_DATA, size_t(total_size) - offset)) {
+    dropped_++;
+    return false;
+  }
+
+  auto it = pending_.find(id);
+  if (it == pending_.end()) {
+    // Evict the oldest incomplete stream; its missing chunks are not coming back
+    if (pending_.size() >= max_pending_) {
+      auto oldest = std::min_element(pending_.begin(), pending_.end(),
+                                     [](const auto &a, const auto &b) { return a.second.order < b.second.order; });
+      pending_.erase(oldest);
+      dropped_++;
+    }
+
+    Pending entry;
+    entry.data.resize(total_size);
+    entry.received.assign(count, false);
+    entry.remaining = count;
+    entry.order = next_order_++;
+    it = pending_.emplace(id, std::move(entry)).first;
+  }
+
+  // A chunk that disagrees with the stream it claims to belong to would leave gaps in it
+  Pending &entry = it->second;
+  if (count != entry.received.size() || total_size != entry.data.size()) {
+    dropped_++;
+    return false;
+  }
+
+  if (!entry.received[index]) {
+    entry.received[index] = true;
+    entry.remaining--;
+    if (length > 0) {
+      std::memcpy(entry.data.data() + offset, payload.data() + PayloadChunker::CHUNK_HEADER_SIZE, length);
+    }
+  }
+
+  if (entry.remaining > 0) {
+    return false;
+  }
+
+  stream_id = id;
+  data = std::move(entry.data);
+  pending_.erase(it);
+  return true;
+}
+
+}  // namespace perception
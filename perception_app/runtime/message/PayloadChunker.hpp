@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <vector>
+#include "ProtocolDefinitions.hpp"
+
+namespace perception {
+
+/**
+ * @brief 大负载分片
+ *
+ * 协议帧长度字段只有 2 字节，压缩深度图等大数据需拆成多帧发送。每个分片负载以 16 字节
+ * 分片头开头（小端序）：
+ *
+ *   stream_id (4) | index (2) | count (2) | total_size (4) | offset (4) | 数据
+ *
+ * 同一数据的所有分片 stream_id 相同，接收端用 PayloadAssembler 按 offset 拼回。
+ */
+class PayloadChunker {
+public:
+    static constexpr size_t CHUNK_HEADER_SIZE = 16;
+    static constexpr size_t MAX_CHUNK_DATA = ProtocolConstants::MAX_PAYLOAD_SIZE - CHUNK_HEADER_SIZE;
+
+    /**
+     * @brief 将数据拆分为分片负载
+     * @param stream_id 数据标识（如帧序号），接收端据此区分不同数据
+     * @param data 数据
+     * @param size 数据长度
+     * @return 分片负载列表，可直接作为 MessageFactory::CreateNotifyMessage 的负载
+     */
+    static std::vector<std::vector<uint8_t>> Split(uint32_t stream_id, const uint8_t* data, size_t size);
+    static std::vector<std::vector<uint8_t>> Split(uint32_t stream_id, const std::vector<uint8_t>& data);
+};
+
+/**
+ * @brief 分片重组
+ *
+ * 分片可乱序到达；同时重组的数据超过 max_pending 时丢弃最早的未完成数据，
+ * 因此丢包只会丢失对应的那一帧，不会无限占用内存。与 Split 的分片布局不符（total_size 与 count 不匹配、
+ * offset 不等于 index * MAX_CHUNK_DATA，或 count / total_size 与同一数据的其他分片不同）的分片被丢弃。非线程安全。
+ */
+class PayloadAssembler {
+public:
+    explicit PayloadAssembler(size_t max_pending = 4);
+
+    /**
+     * @brief 加入一个分片负载
+     * @param payload 分片负载
+     * @param stream_id 输出：数据完整时为其标识
+     * @param data 输出：数据完整时为重组结果
+     * @return 数据是否已完整
+     */
+    bool Add(const std::vector<uint8_t>& payload, uint32_t& stream_id, std::vector<uint8_t>& data);
+
+    /**
+     * @brief 因超出 max_pending 或分片非法而丢弃的数据数
+     */
+    uint64_t GetDroppedCount() const { return dropped_; }
+
+    void Clear() { pending_.clear(); }
+
+private:
+    struct Pending {
+        std::vector<uint8_t> data;
+        std::vector<bool> received;
+        size_t remaining = 0;
+        uint64_t order = 0;
+    };
+
+    size_t max_pending_;
+    std::map<uint32_t, Pending> pending_;
+    uint64_t next_order_ = 0;
+    uint64_t dropped_ = 0;
+};
+
+} // namespace perception
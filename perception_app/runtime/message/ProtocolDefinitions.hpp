@@ -73,6 +73,10 @@ namespace MessageIds {
     static constexpr uint16_t DEVICE_CONTROL = 0x0200;
     static constexpr uint16_t DEVICE_STATUS = 0x0201;
     static constexpr uint16_t DEVICE_CONFIG = 0x0202;
+
+    // 感知数据消息 (0x0300-0x03FF)，负载超过单帧上限，经 PayloadChunker 分片发送
+    static constexpr uint16_t DEPTH_FRAME = 0x0300;  // DepthCodec 压缩的深度图
+    static constexpr uint16_t INFERENCE_RESULT = 0x0301;  // InferenceResult::Serialize 的二进制推理结果
 }
 
 /**